@@ -154,6 +154,32 @@ class ArrowChunkedArray {
    */
   inline int64_t get_length() const { return chunk_offsets_.back(); }
 
+  /**
+   * @brief Get the number of non-empty chunks.
+   *
+   * @return int64_t The chunk count.
+   */
+  inline int64_t get_num_chunks() const { return chunks_.size(); }
+
+  /**
+   * @brief Get the index of the first element of a chunk in the chunked array.
+   *
+   * @param chunk_idx The index of the chunk, may be `num_chunks` for the total length.
+   * @return int64_t The offset of the chunk.
+   */
+  inline int64_t get_chunk_offset(int64_t chunk_idx) const { return chunk_offsets_[chunk_idx]; }
+
+  /**
+   * @brief Copy all values of a chunk into a contiguous array, converting them to type `T`.
+   * This resolves the datatype once per chunk instead of once per value.
+   *
+   * @tparam T The value type to convert to. May be any primitive type.
+   * @param chunk_idx The index of the chunk, must be in the range `[0, num_chunks)`.
+   * @param out The output array, must have room for the length of the chunk.
+   */
+  template <typename T>
+  inline void copy_chunk(int64_t chunk_idx, T* out) const;
+
   /* ----------------------------------------- ITERATOR ---------------------------------------- */
   template <typename T>
   class Iterator {
@@ -15,6 +15,16 @@ namespace LightGBM {
 template <typename T>
 std::function<T(const ArrowArray*, size_t)> get_index_accessor(const char* dtype);
 
+/**
+ * @brief Obtain a function to copy all values of an Arrow array.
+ *
+ * @tparam T The value type of the output, must be a primitive type.
+ * @param dtype The Arrow format string describing the datatype of the Arrow array.
+ * @return std::function<void(const ArrowArray*, T*)> The copy function.
+ */
+template <typename T>
+std::function<void(const ArrowArray*, T*)> get_array_copier(const char* dtype);
+
 /* ---------------------------------- ITERATOR INITIALIZATION ---------------------------------- */
 
 template <typename T>
@@ -28,6 +38,11 @@ inline ArrowChunkedArray::Iterator<T> ArrowChunkedArray::end() const {
                                         chunk_offsets_.size() - 1);
 }
 
+template <typename T>
+inline void ArrowChunkedArray::copy_chunk(int64_t chunk_idx, T* out) const {
+  get_array_copier<T>(schema_->format)(chunks_[chunk_idx], out);
+}
+
 /* ---------------------------------- ITERATOR IMPLEMENTATION ---------------------------------- */
 
 template <typename T>
@@ -203,6 +218,68 @@ std::function<T(const ArrowArray*, size_t)> get_index_accessor(const char* dtype
   }
 }
 
+/* ---------------------------------------- ARRAY COPIER --------------------------------------- */
+
+template <typename T, typename V>
+struct ArrayCopier {
+  void operator()(const ArrowArray* array, V* out) {
+    auto data = static_cast<const T*>(array->buffers[1]) + array->offset;
+    auto validity = static_cast<const char*>(array->buffers[0]);
+    if (validity == nullptr) {
+      // all values are valid, a plain conversion loop
+      for (int64_t i = 0; i < array->length; ++i) {
+        out[i] = static_cast<V>(data[i]);
+      }
+      return;
+    }
+    for (int64_t i = 0; i < array->length; ++i) {
+      auto buffer_idx = i + array->offset;
+      out[i] = (validity[buffer_idx / 8] & (1 << (buffer_idx % 8))) ? static_cast<V>(data[i])
+                                                                     : arrow_primitive_missing_value<V>();
+    }
+  }
+};
+
+template <typename V>
+struct ArrayCopier<bool, V> {
+  void operator()(const ArrowArray* array, V* out) {
+    ArrayIndexAccessor<bool, V> accessor;
+    for (int64_t i = 0; i < array->length; ++i) {
+      out[i] = accessor(array, i);
+    }
+  }
+};
+
+template <typename T>
+std::function<void(const ArrowArray*, T*)> get_array_copier(const char* dtype) {
+  switch (dtype[0]) {
+    case 'c':
+      return ArrayCopier<int8_t, T>();
+    case 'C':
+      return ArrayCopier<uint8_t, T>();
+    case 's':
+      return ArrayCopier<int16_t, T>();
+    case 'S':
+      return ArrayCopier<uint16_t, T>();
+    case 'i':
+      return ArrayCopier<int32_t, T>();
+    case 'I':
+      return ArrayCopier<uint32_t, T>();
+    case 'l':
+      return ArrayCopier<int64_t, T>();
+    case 'L':
+      return ArrayCopier<uint64_t, T>();
+    case 'f':
+      return ArrayCopier<float, T>();
+    case 'g':
+      return ArrayCopier<double, T>();
+    case 'b':
+      return ArrayCopier<bool, T>();
+    default:
+      throw std::invalid_argument("unsupported Arrow datatype");
+  }
+}
+
 }  // namespace LightGBM
 
 #endif
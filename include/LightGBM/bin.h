@@ -171,6 +171,15 @@ class BinMapper {
   */
   inline uint32_t ValueToBin(double value) const;
 
+  /*!
+  * \brief Mapping feature values into bins, same results as ValueToBin for each value
+  *        but the binary searches of several values are interleaved and branch free
+  * \param values Feature values
+  * \param cnt Number of values
+  * \param out Bins of the values
+  */
+  void ValueToBin(const double* values, int cnt, uint32_t* out) const;
+
   /*!
   * \brief Get the default bin when value is 0
   * \return default bin
@@ -319,6 +328,14 @@ class Bin {
   virtual void LoadFromMemory(const void* memory,
     const std::vector<data_size_t>& local_used_indices) = 0;
 
+  /*!
+  * \brief Use the bins in memory in place instead of copying them, for out-of-core training on mapped files
+  * \param memory Serialized bins, must outlive this object
+  * \param num_data Number of data in the serialized bins
+  * \return False if this kind of bin cannot be used in place, the caller should call LoadFromMemory instead
+  */
+  virtual bool MapMemory(const void* /*memory*/, data_size_t /*num_data*/) { return false; }
+
   /*!
   * \brief Get sizes in byte of this object
   */
@@ -458,6 +475,28 @@ class Bin {
   */
   static Bin* CreateDenseBin(data_size_t num_data, int num_bin);
 
+  /*!
+  * \brief Number of bits per bin of the dense bins created by CreateDenseBin, 1, 2, 4, 8, 16 or 32.
+  *        GPU and CUDA builds do not pack bins into fewer than 4 bits
+  * \param num_bin Number of bin
+  */
+  static int DenseBinBits(int num_bin);
+
+  /*!
+  * \brief Number of bits per bin of the dense bins in binary files saved with Dataset::legacy_binary_file_token,
+  *        4, 8, 16 or 32
+  * \param num_bin Number of bin
+  */
+  static int LegacyDenseBinBits(int num_bin);
+
+  /*!
+  * \brief Create object for bin data of one feature with a given number of bits per bin, as in binary files
+  * \param num_data Total number of data
+  * \param bits Number of bits per bin, as returned by DenseBinBits
+  * \return The bin data object
+  */
+  static Bin* CreateDenseBinOfBits(data_size_t num_data, int bits);
+
   /*!
   * \brief Create object for bin data of one feature, used for sparse feature
   * \param num_data Total number of data
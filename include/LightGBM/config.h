@@ -186,6 +186,7 @@ struct Config {
 
   // alias = train, train_data, train_data_file, data_filename
   // desc = path of training data, LightGBM will train from this data
+  // desc = gzip and zstd compressed files are decompressed on the fly, if LightGBM is built with ``-DUSE_ZLIB=ON`` and ``-DUSE_ZSTD=ON`` respectively
   // desc = **Note**: can be used only in CLI version
   std::string data = "";
 
@@ -295,6 +296,12 @@ struct Config {
   // desc = **Note**: this parameter cannot be used at the same time with ``force_col_wise``, choose only one of them
   bool force_row_wise = false;
 
+  // desc = used only with ``cpu`` device type, when both ``force_col_wise`` and ``force_row_wise`` are ``false``
+  // desc = max size in MB of the row-wise bins kept in addition to the col-wise ones, to choose between row-wise and col-wise histogram building for each leaf
+  // desc = the choice is made by the number of data in the leaf and the fraction of used features, with costs fitted from the timings when training starts
+  // desc = ``0`` means only the faster one of row-wise and col-wise is kept, ``< 0`` means no limit
+  double row_wise_cache_size = 0.0;
+
   // alias = hist_pool_size
   // desc = max cache size in MB for historical histogram
   // desc = ``< 0`` means no limit
@@ -724,6 +731,19 @@ struct Config {
   // desc = **Note**: works only in case of loading data directly from text file
   bool two_round = false;
 
+  // check = >0
+  // desc = size (in MB) of each block read from a text data file
+  // desc = larger blocks reduce the number of reads, but increase the memory used for loading data
+  // desc = **Note**: works only in case of loading data directly from text file
+  int file_read_block_size = 16;
+
+  // check = >=2
+  // desc = number of blocks of a text data file that are kept in flight
+  // desc = a background thread keeps reading the next blocks while the previous one is parsed
+  // desc = set this to a larger value for storage with high latency, e.g. network file systems
+  // desc = **Note**: works only in case of loading data directly from text file
+  int file_read_num_buffers = 2;
+
   // alias = has_header
   // desc = set this to ``true`` if input data has header
   // desc = **Note**: works only in case of loading data directly from text file
@@ -794,6 +814,26 @@ struct Config {
   // desc = **Note**: can be used only in CLI version; for language-specific packages you can use the correspondent function
   bool save_binary = false;
 
+  // [no-save]
+  // check = >0
+  // desc = number of shard files to split feature data into, when ``save_binary`` is ``true``
+  // desc = if larger than ``1``, the binary file only keeps the dataset header and metadata, and feature groups are split by size into files ``<binary file>.shard_<k>``
+  // desc = shard files are written and read in parallel, this speeds up saving and loading of large datasets
+  // desc = **Note**: can be used only in CLI version
+  int save_binary_num_shards = 1;
+
+  // [no-save]
+  // desc = set this to ``true`` to train on a binary dataset file larger than memory
+  // desc = dense feature groups are mapped from the binary file (and its shard files) instead of being loaded into memory, their bins are paged in from disk when histograms are constructed
+  // desc = **Note**: works only for training data loaded from a local uncompressed binary file on a single machine, and forces ``force_col_wise=true``
+  bool out_of_core = false;
+
+  // [no-save]
+  // desc = max size of the feature groups kept in memory when ``out_of_core`` is ``true``, in MB
+  // desc = the least recently used feature groups are released from memory when this size is exceeded
+  // desc = ``< 0`` means no limit, pages are only released by the operating system under memory pressure
+  double out_of_core_cache_size = -1.0;
+
   // desc = use precise floating point number parsing for text parser (e.g. CSV, TSV, LibSVM input)
   // desc = **Note**: setting this to ``true`` may lead to much slower text parsing
   bool precise_float_parser = false;
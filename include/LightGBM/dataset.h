@@ -11,12 +11,15 @@
 #include <LightGBM/meta.h>
 #include <LightGBM/train_share_states.h>
 #include <LightGBM/utils/byte_buffer.h>
+#include <LightGBM/utils/file_io.h>
 #include <LightGBM/utils/openmp_wrapper.h>
 #include <LightGBM/utils/random.h>
 #include <LightGBM/utils/text_reader.h>
 
+#include <algorithm>
 #include <string>
 #include <functional>
+#include <list>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -480,6 +483,104 @@ class ParserReflector {
   virtual ~ParserReflector() {}
 };
 
+/*!
+* \brief Keeps the recently used feature groups of an out-of-core dataset in memory,
+*        the bins of the other groups are paged in from the mapped binary files on access
+*/
+class BinPageCache {
+ public:
+  /*!
+  * \brief Constructor
+  * \param num_groups Number of feature groups
+  * \param capacity Max bytes of groups kept in memory, < 0 means no limit
+  */
+  BinPageCache(int num_groups, double capacity);
+
+  /*!
+  * \brief Add a mapped file
+  * \return Index of the file
+  */
+  int AddFile(std::unique_ptr<MappedFile> file);
+
+  /*! \brief Mapped file by index */
+  const MappedFile* file(int file_idx) const { return files_[file_idx].get(); }
+
+  /*!
+  * \brief Set the mapped range of a feature group
+  * \param group Index of the feature group
+  * \param file_idx Index of the file
+  * \param offset Offset of the serialized group in the file
+  * \param size Size of the serialized group
+  */
+  void AddGroup(int group, int file_idx, size_t offset, size_t size);
+
+  /*!
+  * \brief Start reading the given groups in the background and mark them as most recently used,
+  *        then release the least recently used groups until the cache fits into its capacity
+  * \param groups Feature groups that will be accessed next, groups that are not mapped are ignored
+  */
+  void Prefetch(const std::vector<int>& groups);
+
+  /*! \brief Total bytes of groups read from disk */
+  size_t paged_in_bytes() const { return paged_in_bytes_; }
+
+  /*! \brief Total bytes of groups released from memory */
+  size_t released_bytes() const { return released_bytes_; }
+
+ private:
+  struct GroupRange {
+    int file_idx = -1;
+    size_t offset = 0;
+    size_t size = 0;
+    bool is_resident = false;
+    uint64_t last_use = 0;
+    std::list<int>::iterator lru_pos;
+  };
+
+  std::vector<std::unique_ptr<MappedFile>> files_;
+  std::vector<GroupRange> groups_;
+  /*! \brief Resident groups, the most recently used first */
+  std::list<int> lru_;
+  double capacity_;
+  size_t resident_bytes_ = 0;
+  size_t paged_in_bytes_ = 0;
+  size_t released_bytes_ = 0;
+  uint64_t num_prefetch_ = 0;
+  std::mutex mutex_;
+};
+
+/*!
+* \brief Values of several sparse rows, collected so that Dataset::PushRowBatch
+*        can bin the values of each feature in one batch
+*/
+class RowBatch {
+ public:
+  /*! \brief Add the value of inner feature feature_idx in row row_idx */
+  inline void Add(int feature_idx, data_size_t row_idx, double value) {
+    entries_.push_back(Entry{feature_idx, row_idx, value});
+  }
+
+  /*! \brief Add a zero of inner feature feature_idx in row row_idx, zeros are pushed after all values */
+  inline void AddZero(int feature_idx, data_size_t row_idx) {
+    zero_entries_.push_back(Entry{feature_idx, row_idx, 0.0});
+  }
+
+ private:
+  friend class Dataset;
+  struct Entry {
+    int feature;
+    data_size_t row;
+    double value;
+  };
+  std::vector<Entry> entries_;
+  std::vector<Entry> zero_entries_;
+  /*! \brief Whether the values of every row were added in ascending order of their columns */
+  bool is_column_ordered_ = true;
+  /*! \brief Rows and values of one feature, to be pushed */
+  std::vector<data_size_t> rows_;
+  std::vector<double> values_;
+};
+
 /*! \brief The main class of data set,
 *          which are used to training or validation
 */
@@ -579,6 +680,33 @@ class Dataset {
     }
   }
 
+  /*!
+  * \brief Push the values of one column for consecutive rows
+  * \param tid Thread id
+  * \param start_row Index of the first row
+  * \param col_idx Index of the column
+  * \param values Values of the column
+  * \param cnt Number of rows
+  */
+  inline void PushOneColumn(int tid, data_size_t start_row, size_t col_idx, const double* values, data_size_t cnt) {
+    if (this->is_finish_load_)
+      return;
+    auto feature_idx = this->used_feature_map_[col_idx];
+    if (feature_idx >= 0) {
+      auto group = this->feature2group_[feature_idx];
+      auto sub_feature = this->feature2subfeature_[feature_idx];
+      this->feature_groups_[group]->PushData(tid, sub_feature, start_row, values, cnt);
+      if (this->has_raw_) {
+        auto feat_ind = numeric_feature_map_[feature_idx];
+        if (feat_ind >= 0) {
+          for (data_size_t i = 0; i < cnt; ++i) {
+            raw_data_[feat_ind][start_row + i] = static_cast<float>(values[i]);
+          }
+        }
+      }
+    }
+  }
+
   inline void PushOneRow(int tid, data_size_t row_idx, const std::vector<double>& feature_values) {
     for (size_t i = 0; i < feature_values.size() && i < static_cast<size_t>(num_total_features_); ++i) {
       this->PushOneValue(tid, row_idx, i, feature_values[i]);
@@ -607,6 +735,92 @@ class Dataset {
     FinishOneRow(tid, row_idx, is_feature_added);
   }
 
+  /*!
+  * \brief Add zeros of the features that need them to a row batch, same as FinishOneRow when the batch is pushed
+  */
+  inline void AddZerosOfRow(data_size_t row_idx, const std::vector<bool>& is_feature_added, RowBatch* batch) const {
+    for (auto fidx : feature_need_push_zeros_) {
+      if (!is_feature_added[fidx]) {
+        batch->AddZero(fidx, row_idx);
+      }
+    }
+  }
+
+  /*!
+  * \brief Add one sparse row to a row batch, same as PushOneRow when the batch is pushed,
+  *        raw values are stored right away
+  */
+  inline void AddOneRow(data_size_t row_idx, const std::vector<std::pair<int, double>>& feature_values,
+                        RowBatch* batch) {
+    if (is_finish_load_) { return; }
+    std::vector<bool> is_feature_added(num_features_, false);
+    for (size_t i = 0; i < feature_values.size(); ++i) {
+      const auto& inner_data = feature_values[i];
+      if (i > 0 && inner_data.first < feature_values[i - 1].first) {
+        batch->is_column_ordered_ = false;
+      }
+      if (inner_data.first >= num_total_features_) { continue; }
+      int feature_idx = used_feature_map_[inner_data.first];
+      if (feature_idx >= 0) {
+        is_feature_added[feature_idx] = true;
+        batch->Add(feature_idx, row_idx, inner_data.second);
+        if (has_raw_) {
+          int feat_ind = numeric_feature_map_[feature_idx];
+          if (feat_ind >= 0) {
+            raw_data_[feat_ind][row_idx] = static_cast<float>(inner_data.second);
+          }
+        }
+      }
+    }
+    AddZerosOfRow(row_idx, is_feature_added, batch);
+  }
+
+  /*!
+  * \brief Bin and push all values of a row batch, then clear it.
+  *        Values are pushed in the order they were added, batched by feature when the columns of every row
+  *        were ascending, then the zeros in the order of FinishOneRow. So features bundled in one group
+  *        that conflict in a row, and repeated columns, keep the same value as with PushOneRow
+  * \param tid Thread id
+  * \param batch Row batch
+  */
+  inline void PushRowBatch(int tid, RowBatch* batch) {
+    // entries sorted by feature are pushed with one PushData per feature
+    auto push_entries = [this, tid, batch](const std::vector<RowBatch::Entry>& entries) {
+      for (size_t start = 0; start < entries.size();) {
+        const int fidx = entries[start].feature;
+        batch->rows_.clear();
+        batch->values_.clear();
+        size_t end = start;
+        for (; end < entries.size() && entries[end].feature == fidx; ++end) {
+          batch->rows_.push_back(entries[end].row);
+          batch->values_.push_back(entries[end].value);
+        }
+        feature_groups_[feature2group_[fidx]]->PushData(tid, feature2subfeature_[fidx], batch->rows_.data(),
+                                                         batch->values_.data(), static_cast<data_size_t>(end - start));
+        start = end;
+      }
+    };
+    if (batch->is_column_ordered_) {
+      std::stable_sort(batch->entries_.begin(), batch->entries_.end(),
+                       [this](const RowBatch::Entry& a, const RowBatch::Entry& b) {
+                         return real_feature_idx_[a.feature] < real_feature_idx_[b.feature];
+                       });
+      push_entries(batch->entries_);
+    } else {
+      // sorting by feature could change which of the conflicting values of a row is pushed last
+      for (const auto& entry : batch->entries_) {
+        feature_groups_[feature2group_[entry.feature]]->PushData(tid, feature2subfeature_[entry.feature], entry.row,
+                                                                 entry.value);
+      }
+    }
+    std::stable_sort(batch->zero_entries_.begin(), batch->zero_entries_.end(),
+                     [](const RowBatch::Entry& a, const RowBatch::Entry& b) { return a.feature < b.feature; });
+    push_entries(batch->zero_entries_);
+    batch->entries_.clear();
+    batch->zero_entries_.clear();
+    batch->is_column_ordered_ = true;
+  }
+
   inline void PushOneData(int tid, data_size_t row_idx, int group, int feature_idx, int sub_feature, double value) {
     feature_groups_[group]->PushData(tid, sub_feature, row_idx, value);
     if (has_raw_) {
@@ -617,6 +831,19 @@ class Dataset {
     }
   }
 
+  inline void PushOneData(int tid, const data_size_t* row_indices, int group, int feature_idx, int sub_feature,
+                          const double* values, data_size_t cnt) {
+    feature_groups_[group]->PushData(tid, sub_feature, row_indices, values, cnt);
+    if (has_raw_) {
+      int feat_ind = numeric_feature_map_[feature_idx];
+      if (feat_ind >= 0) {
+        for (data_size_t i = 0; i < cnt; ++i) {
+          raw_data_[feat_ind][row_indices[i]] = static_cast<float>(values[i]);
+        }
+      }
+    }
+  }
+
   inline void InsertMetadataAt(data_size_t start_index,
     data_size_t count,
     const label_t* labels,
@@ -667,7 +894,8 @@ class Dataset {
   TrainingShareStates* GetShareStates(
       score_t* gradients, score_t* hessians,
       const std::vector<int8_t>& is_feature_used, bool is_constant_hessian,
-      bool force_col_wise, bool force_row_wise, const int num_grad_quant_bins) const;
+      bool force_col_wise, bool force_row_wise, const int num_grad_quant_bins,
+      double row_wise_cache_size = 0.0) const;
 
   LIGHTGBM_EXPORT void FinishLoad();
 
@@ -687,8 +915,18 @@ class Dataset {
 
   /*!
   * \brief Save current dataset into binary file, will save to "filename.bin"
+  * \param bin_filename Filename of binary file, use data filename with ".bin" appended if empty
+  * \param num_shards If larger than 1, feature groups are split into this number of shard files,
+  *        which are written in parallel, the binary file only keeps the header and metadata
+  */
+  LIGHTGBM_EXPORT void SaveBinaryFile(const char* bin_filename, int num_shards = 1);
+
+  /*!
+  * \brief Get filename of one shard of a sharded binary file
+  * \param bin_filename Filename of binary file
+  * \param shard_idx Index of shard, or -1 to get the pattern of all shards
   */
-  LIGHTGBM_EXPORT void SaveBinaryFile(const char* bin_filename);
+  static std::string BinaryShardFilename(const std::string& bin_filename, int shard_idx);
 
   /*!
    * \brief Serialize the overall Dataset definition/schema to a binary buffer (i.e., without data)
@@ -722,6 +960,22 @@ class Dataset {
                                    TrainingShareStates* share_state,
                                    hist_t* hist_data) const;
 
+  /*! \brief Number of dense groups whose histograms are constructed in one pass over the rows */
+  static const int kNumFusedGroups = 4;
+
+  /*!
+  * \brief Construct the histograms of kNumFusedGroups dense groups with BITS-bit bins (1, 2, 4 or 8)
+  *        in one pass over the rows, so the data indices and gradients are loaded once for all of them
+  */
+  template <bool USE_INDICES, bool USE_HESSIAN, bool USE_QUANT_GRAD, int HIST_BITS, int BITS>
+  void ConstructHistogramsFusedDense(const int* groups,
+                                     const data_size_t* data_indices,
+                                     data_size_t num_data,
+                                     const score_t* ordered_gradients,
+                                     const score_t* ordered_hessians,
+                                     double constant_hessian,
+                                     hist_t* hist_data) const;
+
   template <bool USE_QUANT_GRAD, int HIST_BITS>
   inline void ConstructHistograms(
       const std::vector<int8_t>& is_feature_used,
@@ -996,14 +1250,24 @@ class Dataset {
 
   #endif  // USE_CUDA
 
+  /*!
+  * \brief Start reading the bins of the used feature groups from disk, only for out-of-core datasets
+  * \param is_feature_used Used features, by inner feature index
+  */
+  void PrefetchFeatureGroups(const std::vector<int8_t>& is_feature_used) const;
+
  private:
   void SerializeHeader(BinaryWriter* serializer);
 
+  void SaveFeatureGroupsToBinary(BinaryWriter* writer, int group_begin, int group_end) const;
+
   size_t GetSerializedHeaderSize();
 
   void CreateCUDAColumnData();
 
   std::string data_filename_;
+  /*! \brief Pages the mapped feature groups of an out-of-core dataset, nullptr if all bins are in memory */
+  std::unique_ptr<BinPageCache> bin_page_cache_;
   /*! \brief Store used features */
   std::vector<std::unique_ptr<FeatureGroup>> feature_groups_;
   /*! \brief Mapper from real feature index to used index*/
@@ -1024,6 +1288,19 @@ class Dataset {
   static const int kSerializedReferenceVersionLength;
   static const char* serialized_reference_version;
   static const char* binary_file_token;
+  static const char* binary_shards_file_token;
+  /*! \brief Token at the beginning of each shard file of a sharded binary file */
+  static const char* binary_shard_token;
+  /*!
+  * \brief Number of size_t values after the token of a shard file: id of the shard set,
+  *        number of shards, index of the shard, first feature group and end of feature groups
+  */
+  static const int kNumBinaryShardHeaderFields;
+  /*!
+  * \brief Token of binary files written before the number of bits per dense bin was saved,
+  *        their dense bins have the widths of Bin::LegacyDenseBinBits
+  */
+  static const char* legacy_binary_file_token;
   static const char* binary_serialized_reference_token;
   int num_groups_;
   std::vector<int> real_feature_idx_;
@@ -51,20 +51,43 @@ class DatasetLoader {
 
   Dataset* LoadFromBinFile(const char* data_filename, const char* bin_filename, int rank, int num_machines, int* num_global_data, std::vector<data_size_t>* used_data_indices);
 
+  /*!
+  * \brief Read feature groups in [group_begin, group_end) from binary file, keep only used_data_indices,
+  *        is_legacy_layout for files saved with Dataset::legacy_binary_file_token
+  */
+  static void LoadFeatureGroupsFromBinary(const VirtualFileReader* reader, int group_begin, int group_end,
+                                          data_size_t num_global_data, const std::vector<data_size_t>& used_data_indices,
+                                          bool is_legacy_layout, std::vector<char>* buffer,
+                                          std::vector<std::unique_ptr<FeatureGroup>>* out_groups);
+
+  /*! \brief Check that the header of a shard file matches what the binary file expects of shard shard_idx */
+  static void CheckBinaryShardHeader(const std::string& filename, const char* header, size_t size,
+                                     size_t shard_set_id, int num_shards, int shard_idx,
+                                     size_t group_begin, size_t group_end);
+
+  /*!
+  * \brief Use feature groups in [group_begin, group_end) in place from a mapped binary file, starting at offset,
+  *        is_legacy_layout for files saved with Dataset::legacy_binary_file_token
+  */
+  static void LoadFeatureGroupsFromMappedFile(BinPageCache* page_cache, int file_idx, size_t offset,
+                                              int group_begin, int group_end, data_size_t num_global_data,
+                                              bool is_legacy_layout,
+                                              std::vector<std::unique_ptr<FeatureGroup>>* out_groups);
+
   void SetHeader(const char* filename);
 
   void CheckDataset(const Dataset* dataset, bool is_load_from_binary);
 
-  std::vector<std::string> LoadTextDataToMemory(const char* filename, const Metadata& metadata, int rank, int num_machines, int* num_global_data, std::vector<data_size_t>* used_data_indices);
+  TextLineBuffer LoadTextDataToMemory(const char* filename, const Metadata& metadata, int rank, int num_machines, int* num_global_data, std::vector<data_size_t>* used_data_indices);
 
-  std::vector<std::string> SampleTextDataFromMemory(const std::vector<std::string>& data);
+  std::vector<std::string> SampleTextDataFromMemory(const TextLineBuffer& data);
 
   std::vector<std::string> SampleTextDataFromFile(const char* filename, const Metadata& metadata, int rank, int num_machines, int* num_global_data, std::vector<data_size_t>* used_data_indices);
 
   void ConstructBinMappersFromTextData(int rank, int num_machines, const std::vector<std::string>& sample_data, const Parser* parser, Dataset* dataset);
 
   /*! \brief Extract local features from memory */
-  void ExtractFeaturesFromMemory(std::vector<std::string>* text_data, const Parser* parser, Dataset* dataset);
+  void ExtractFeaturesFromMemory(TextLineBuffer* text_data, const Parser* parser, Dataset* dataset);
 
   /*! \brief Extract local features from file */
   void ExtractFeaturesFromFile(const char* filename, const Parser* parser, const std::vector<data_size_t>& used_data_indices, Dataset* dataset);
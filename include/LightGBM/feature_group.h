@@ -10,7 +10,9 @@
 #include <LightGBM/meta.h>
 #include <LightGBM/utils/random.h>
 
+#include <algorithm>
 #include <cstdio>
+#include <cstring>
 #include <memory>
 #include <vector>
 
@@ -115,20 +117,49 @@ class FeatureGroup {
    * \param num_all_data Number of global data
    * \param local_used_indices Local used indices, empty means using all data
    * \param group_id Id of group
+   * \param map_bins Use dense bins in place instead of copying them, memory must outlive this object
+   * \param is_legacy_layout True for groups of a file saved with Dataset::legacy_binary_file_token,
+   *        which has no number of bits per dense bin
    */
   FeatureGroup(const void* memory,
                data_size_t num_all_data,
                const std::vector<data_size_t>& local_used_indices,
-               int group_id) {
+               int group_id,
+               bool map_bins = false,
+               bool is_legacy_layout = false) {
     // Load the definition schema first
     const char* memory_ptr = LoadDefinitionFromMemory(memory, group_id);
 
+    // the dense bins are stored with the number of bits per bin of the build that saved them,
+    // GPU and CUDA builds do not pack bins into fewer than 4 bits
+    const std::vector<int32_t> bits = DenseBinBits();
+    std::vector<int32_t> saved_bits(bits.size());
+    if (is_legacy_layout) {
+      saved_bits = DenseBinBits(true);
+    } else {
+      std::memcpy(saved_bits.data(), memory_ptr, sizeof(int32_t) * saved_bits.size());
+      memory_ptr += VirtualFileWriter::AlignedSize(sizeof(int32_t) * saved_bits.size());
+    }
+    for (size_t i = 0; i < bits.size(); ++i) {
+      if ((saved_bits[i] == 0) != (bits[i] == 0)) {
+        Log::Fatal("Binary file error: feature group %d has sparse and dense bins mixed up", group_id);
+      }
+    }
+
+    if (map_bins && !is_multi_val_ && !is_sparse_ && local_used_indices.empty() && saved_bits == bits) {
+      AllocateBins(0, bits);
+      is_mapped_ = bin_data_->MapMemory(memory_ptr, num_all_data);
+      if (is_mapped_) {
+        return;
+      }
+    }
+
     // Allocate memory for the data
     data_size_t num_data = num_all_data;
     if (!local_used_indices.empty()) {
       num_data = static_cast<data_size_t>(local_used_indices.size());
     }
-    AllocateBins(num_data);
+    AllocateBins(num_data, saved_bits);
 
     // Now load the actual data
     if (is_multi_val_) {
@@ -139,6 +170,9 @@ class FeatureGroup {
     } else {
       bin_data_->LoadFromMemory(memory_ptr, local_used_indices);
     }
+    if (saved_bits != bits) {
+      RepackDenseBins(num_data, saved_bits, bits);
+    }
   }
 
   /*!
@@ -204,26 +238,81 @@ class FeatureGroup {
     return memory_ptr;
   }
 
+  /*!
+   * \brief Number of bits per bin of the dense bins of this build, one entry for each bin data
+   *        (bin_data_, or multi_bin_data_ of multi-val groups), 0 for sparse bins
+   * \param is_legacy_layout Number of bits of the dense bins of files saved with Dataset::legacy_binary_file_token
+   */
+  std::vector<int32_t> DenseBinBits(bool is_legacy_layout = false) const {
+    auto dense_bin_bits = is_legacy_layout ? Bin::LegacyDenseBinBits : Bin::DenseBinBits;
+    std::vector<int32_t> bits;
+    if (is_multi_val_) {
+      for (int i = 0; i < num_feature_; ++i) {
+        int addi = bin_mappers_[i]->GetMostFreqBin() == 0 ? 0 : 1;
+        if (bin_mappers_[i]->sparse_rate() >= kSparseThreshold) {
+          bits.push_back(0);
+        } else {
+          bits.push_back(dense_bin_bits(bin_mappers_[i]->num_bin() + addi));
+        }
+      }
+    } else {
+      bits.push_back(is_sparse_ ? 0 : dense_bin_bits(num_total_bin_));
+    }
+    return bits;
+  }
+
   /*!
    * \brief Allocate the bins
    * \param num_all_data Number of global data
    */
   inline void AllocateBins(data_size_t num_data) {
+    AllocateBins(num_data, DenseBinBits());
+  }
+
+  /*!
+   * \brief Allocate the bins with the given number of bits per dense bin
+   * \param num_all_data Number of global data
+   * \param bits Number of bits per bin of each bin data, as DenseBinBits
+   */
+  inline void AllocateBins(data_size_t num_data, const std::vector<int32_t>& bits) {
     if (is_multi_val_) {
       for (int i = 0; i < num_feature_; ++i) {
         int addi = bin_mappers_[i]->GetMostFreqBin() == 0 ? 0 : 1;
-        if (bin_mappers_[i]->sparse_rate() >= kSparseThreshold) {
+        if (bits[i] == 0) {
           multi_bin_data_.emplace_back(Bin::CreateSparseBin(num_data, bin_mappers_[i]->num_bin() + addi));
         } else {
-          multi_bin_data_.emplace_back(Bin::CreateDenseBin(num_data, bin_mappers_[i]->num_bin() + addi));
+          multi_bin_data_.emplace_back(Bin::CreateDenseBinOfBits(num_data, bits[i]));
         }
       }
     } else {
       if (is_sparse_) {
         bin_data_.reset(Bin::CreateSparseBin(num_data, num_total_bin_));
       } else {
-        bin_data_.reset(Bin::CreateDenseBin(num_data, num_total_bin_));
+        bin_data_.reset(Bin::CreateDenseBinOfBits(num_data, bits[0]));
+      }
+    }
+  }
+
+  /*!
+   * \brief Copy the dense bins loaded with another number of bits per bin into bins of this build
+   * \param num_data Number of data
+   * \param saved_bits Number of bits per bin of the loaded bins
+   * \param bits Number of bits per bin of this build
+   */
+  void RepackDenseBins(data_size_t num_data, const std::vector<int32_t>& saved_bits,
+                       const std::vector<int32_t>& bits) {
+    for (size_t i = 0; i < bits.size(); ++i) {
+      if (saved_bits[i] == bits[i]) {
+        continue;
+      }
+      std::unique_ptr<Bin>& bin = is_multi_val_ ? multi_bin_data_[i] : bin_data_;
+      std::unique_ptr<Bin> repacked(Bin::CreateDenseBinOfBits(num_data, bits[i]));
+      std::unique_ptr<BinIterator> iterator(bin->GetIterator(0, 0, 0));
+      for (data_size_t j = 0; j < num_data; ++j) {
+        repacked->Push(0, j, iterator->RawGet(j));
       }
+      repacked->FinishLoad();
+      bin = std::move(repacked);
     }
   }
 
@@ -265,6 +354,30 @@ class FeatureGroup {
     }
   }
 
+  /*!
+   * \brief Push the values of one sub feature for consecutive rows
+   * \param tid Thread id
+   * \param sub_feature_idx Index of the sub feature
+   * \param start_idx Index of the first row
+   * \param values Feature values of the rows
+   * \param cnt Number of rows
+   */
+  inline void PushData(int tid, int sub_feature_idx, data_size_t start_idx, const double* values, data_size_t cnt) {
+    PushBatch(tid, sub_feature_idx, nullptr, start_idx, values, cnt);
+  }
+
+  /*!
+   * \brief Push the values of one sub feature for the given rows
+   * \param tid Thread id
+   * \param sub_feature_idx Index of the sub feature
+   * \param row_indices Indices of the rows
+   * \param values Feature values of the rows
+   * \param cnt Number of rows
+   */
+  inline void PushData(int tid, int sub_feature_idx, const data_size_t* row_indices, const double* values, data_size_t cnt) {
+    PushBatch(tid, sub_feature_idx, row_indices, 0, values, cnt);
+  }
+
   void ReSize(int num_data) {
     if (!is_multi_val_) {
       bin_data_->ReSize(num_data);
@@ -466,6 +579,8 @@ class FeatureGroup {
     }
 
     if (include_data) {
+      const std::vector<int32_t> bits = DenseBinBits();
+      writer->AlignedWrite(bits.data(), sizeof(int32_t) * bits.size());
       if (is_multi_val_) {
         for (int i = 0; i < num_feature_; ++i) {
           multi_bin_data_[i]->SaveBinaryToFile(writer);
@@ -488,6 +603,7 @@ class FeatureGroup {
       ret += bin_mappers_[i]->SizesInByte();
     }
     if (include_data) {
+      ret += VirtualFileWriter::AlignedSize(sizeof(int32_t) * (is_multi_val_ ? num_feature_ : 1));
       if (!is_multi_val_) {
         ret += bin_data_->SizesInByte();
       } else {
@@ -573,6 +689,9 @@ class FeatureGroup {
     }
   }
 
+  /*! \brief True if the bins are used in place from a mapped binary dataset file */
+  inline bool is_mapped() const { return is_mapped_; }
+
   uint32_t feature_min_bin(const int sub_feature_index) {
     if (!is_multi_val_) {
       return bin_offsets_[sub_feature_index];
@@ -582,6 +701,34 @@ class FeatureGroup {
   }
 
  private:
+  /*! \brief Bin values block by block, rows are row_indices, or consecutive from start_idx if row_indices is nullptr */
+  inline void PushBatch(int tid, int sub_feature_idx, const data_size_t* row_indices, data_size_t start_idx,
+                        const double* values, data_size_t cnt) {
+    const int kBlockSize = 256;
+    uint32_t bins[kBlockSize];
+    const BinMapper* bin_mapper = bin_mappers_[sub_feature_idx].get();
+    const uint32_t most_freq_bin = bin_mapper->GetMostFreqBin();
+    for (data_size_t block_start = 0; block_start < cnt; block_start += kBlockSize) {
+      const int block_cnt = static_cast<int>(std::min<data_size_t>(kBlockSize, cnt - block_start));
+      bin_mapper->ValueToBin(values + block_start, block_cnt, bins);
+      for (int i = 0; i < block_cnt; ++i) {
+        uint32_t bin = bins[i];
+        if (bin == most_freq_bin) {
+          continue;
+        }
+        if (most_freq_bin == 0) {
+          bin -= 1;
+        }
+        const data_size_t row = row_indices == nullptr ? start_idx + block_start + i : row_indices[block_start + i];
+        if (is_multi_val_) {
+          multi_bin_data_[sub_feature_idx]->Push(tid, row, bin + 1);
+        } else {
+          bin_data_->Push(tid, row, bin + bin_offsets_[sub_feature_idx]);
+        }
+      }
+    }
+  }
+
   void CreateBinData(int num_data, bool is_multi_val, bool force_dense, bool force_sparse) {
     if (is_multi_val) {
       multi_bin_data_.clear();
@@ -623,6 +770,7 @@ class FeatureGroup {
   bool is_multi_val_;
   bool is_dense_multi_val_;
   bool is_sparse_;
+  bool is_mapped_ = false;
   int num_total_bin_;
 };
 
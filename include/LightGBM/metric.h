@@ -12,6 +12,7 @@
 #include <LightGBM/utils/log.h>
 #include <LightGBM/utils/common.h>
 
+#include <cmath>
 #include <string>
 #include <vector>
 
@@ -87,6 +88,51 @@ class DCGCalculator {
     const label_t* label, const double* score,
     data_size_t num_data, std::vector<double>* out);
 
+  /*!
+  * \brief Calculate the DCG score at multi position, with a buffer for the sorted indices
+  * \param ks The positions to evaluate
+  * \param label Pointer of label
+  * \param score Pointer of score
+  * \param num_data Number of data
+  * \param out Output result
+  * \param sorted_idx Buffer for the sorted indices, can be reused between queries
+  */
+  static void CalDCG(const std::vector<data_size_t>& ks,
+    const label_t* label, const double* score,
+    data_size_t num_data, std::vector<double>* out,
+    std::vector<data_size_t>* sorted_idx);
+
+  /*!
+  * \brief Get the indices of the top k scores, in the order of IsRankedBefore
+  * \param k Number of top positions, all data are sorted if it is not less than num_data
+  * \param score Pointer of score
+  * \param num_data Number of data
+  * \param sorted_idx Output sorted indices, its first min(k, num_data) entries are valid
+  */
+  static void SortTopK(data_size_t k, const double* score, data_size_t num_data,
+    std::vector<data_size_t>* sorted_idx);
+
+  /*!
+  * \brief Whether a document is ranked before another one, by descending score with ties in the order of
+  *        their indices. NaN scores are ranked below all other scores, so this is a strict total order
+  * \param score_a Score of the first document
+  * \param idx_a Index of the first document
+  * \param score_b Score of the second document
+  * \param idx_b Index of the second document
+  * \return True if the first document is ranked before the second one
+  */
+  static inline bool IsRankedBefore(double score_a, data_size_t idx_a, double score_b, data_size_t idx_b) {
+    const bool is_nan_a = std::isnan(score_a);
+    const bool is_nan_b = std::isnan(score_b);
+    if (is_nan_a != is_nan_b) {
+      return is_nan_b;
+    }
+    if (!is_nan_a && score_a != score_b) {
+      return score_a > score_b;
+    }
+    return idx_a < idx_b;
+  }
+
   /*!
   * \brief Calculate the Max DCG score at position k
   * \param k The position want to eval at
@@ -11,6 +11,7 @@
 #include <LightGBM/utils/threading.h>
 
 #include <algorithm>
+#include <cstring>
 #include <memory>
 #include <vector>
 
@@ -270,6 +271,10 @@ struct TrainingShareStates {
   bool is_constant_hessian = true;
   const data_size_t* bagging_use_indices;
   data_size_t bagging_indices_cnt;
+  /*! \brief Range of data indices whose gradients and hessians are already gathered into the ordered buffers,
+   *         at the same offsets, by the tree learner */
+  const data_size_t* ordered_indices = nullptr;
+  data_size_t ordered_indices_cnt = 0;
 
   TrainingShareStates() {
     multi_val_bin_wrapper_.reset(nullptr);
@@ -287,6 +292,55 @@ struct TrainingShareStates {
     return (multi_val_bin_wrapper_ != nullptr && multi_val_bin_wrapper_->IsSparse());
   }
 
+  /*! \brief Approximate size in bytes of the multi-value bin */
+  double MultiValBinSize(data_size_t num_data) const {
+    const int bytes_per_element = num_total_bin_ <= 256 ? 1 : (num_total_bin_ <= 65536 ? 2 : 4);
+    return num_elements_per_row_ * num_data * bytes_per_element;
+  }
+
+  /*!
+  * \brief Keep a row-wise state besides this col-wise one, with the costs of both to choose between them for each call
+  * \param row_wise_state Row-wise state with the same histogram layout
+  * \param col_wise_fixed_cost Cost of a col-wise call without data
+  * \param col_wise_cost_per_row Cost of col-wise for one data with all feature groups used
+  * \param row_wise_fixed_cost Cost of a row-wise call without data
+  * \param row_wise_cost_per_row Cost of row-wise for one data
+  */
+  void SetRowWiseState(TrainingShareStates* row_wise_state,
+                       double col_wise_fixed_cost, double col_wise_cost_per_row,
+                       double row_wise_fixed_cost, double row_wise_cost_per_row);
+
+  /*! \brief The row-wise state kept besides this col-wise one, nullptr if there is none */
+  TrainingShareStates* row_wise_state() { return row_wise_state_.get(); }
+
+  /*! \brief Buffer for the histograms of the row-wise state, nullptr if they have the same layout as this state */
+  hist_t* row_wise_hist_buf() {
+    return row_wise_hist_buf_.empty() ? nullptr : row_wise_hist_buf_.data();
+  }
+
+  /*! \brief Move the feature histograms in row_wise_hist_buf() to their places in hist_data */
+  template <bool USE_QUANT_GRAD, int HIST_BITS>
+  void MoveRowWiseHist(hist_t* hist_data) const {
+    const size_t entry_size = USE_QUANT_GRAD ? (HIST_BITS == 16 ? 2 * sizeof(int16_t) : 2 * sizeof(int32_t))
+                                             : 2 * sizeof(hist_t);
+    const char* src = reinterpret_cast<const char*>(row_wise_hist_buf_.data());
+    char* dest = reinterpret_cast<char*>(hist_data);
+    for (size_t i = 0; i < row_wise_hist_move_src_.size(); ++i) {
+      std::memcpy(dest + row_wise_hist_move_dest_[i] * entry_size, src + row_wise_hist_move_src_[i] * entry_size,
+                   row_wise_hist_move_size_[i] * entry_size);
+    }
+  }
+
+  /*!
+  * \brief Whether row-wise histogram building is expected to be faster than col-wise for a call
+  * \param num_data Number of data used in the call
+  * \param used_group_ratio Fraction of the feature groups used in the call
+  */
+  bool UseRowWise(data_size_t num_data, double used_group_ratio) const {
+    return row_wise_fixed_cost_ + row_wise_cost_per_row_ * num_data <
+           col_wise_fixed_cost_ + col_wise_cost_per_row_ * used_group_ratio * num_data;
+  }
+
   void SetMultiValBin(MultiValBin* bin, data_size_t num_data,
     const std::vector<std::unique_ptr<FeatureGroup>>& feature_groups,
     bool dense_only, bool sparse_only, const int num_grad_quant_bins);
@@ -304,6 +358,11 @@ struct TrainingShareStates {
         bagging_use_indices,
         bagging_indices_cnt);
     }
+    if (row_wise_state_ != nullptr) {
+      row_wise_state_->bagging_use_indices = bagging_use_indices;
+      row_wise_state_->bagging_indices_cnt = bagging_indices_cnt;
+      row_wise_state_->InitTrain(group_feature_start, feature_groups, is_feature_used);
+    }
   }
 
   template <bool USE_INDICES, bool ORDERED, bool USE_QUANT_GRAD, int HIST_BITS>
@@ -322,12 +381,18 @@ struct TrainingShareStates {
     if (multi_val_bin_wrapper_ != nullptr) {
       multi_val_bin_wrapper_->SetUseSubrow(is_use_subrow);
     }
+    if (row_wise_state_ != nullptr) {
+      row_wise_state_->SetUseSubrow(is_use_subrow);
+    }
   }
 
   void SetSubrowCopied(bool is_subrow_copied) {
     if (multi_val_bin_wrapper_ != nullptr) {
       multi_val_bin_wrapper_->SetSubrowCopied(is_subrow_copied);
     }
+    if (row_wise_state_ != nullptr) {
+      row_wise_state_->SetSubrowCopied(is_subrow_copied);
+    }
   }
 
 
@@ -358,6 +423,15 @@ struct TrainingShareStates {
   std::vector<hist_t, Common::AlignmentAllocator<hist_t, kAlignedSize>> hist_buf_;
   int num_total_bin_ = 0;
   double num_elements_per_row_ = 0.0f;
+  std::unique_ptr<TrainingShareStates> row_wise_state_;
+  std::vector<hist_t, Common::AlignmentAllocator<hist_t, kAlignedSize>> row_wise_hist_buf_;
+  std::vector<uint32_t> row_wise_hist_move_src_;
+  std::vector<uint32_t> row_wise_hist_move_dest_;
+  std::vector<uint32_t> row_wise_hist_move_size_;
+  double col_wise_fixed_cost_ = 0.0;
+  double col_wise_cost_per_row_ = 0.0;
+  double row_wise_fixed_cost_ = 0.0;
+  double row_wise_cost_per_row_ = 0.0;
 };
 
 }  // namespace LightGBM
@@ -332,6 +332,18 @@ class Tree {
 
   std::string CategoricalDecisionIfElse(int node) const;
 
+  /*!
+  * \brief Adding prediction value of this tree model to scores, for trees without linear models.
+  *        Rows are processed in blocks, and the rows of a block at each node are split together
+  *        by the bins of its feature, instead of walking each row from the root.
+  * \param data The dataset
+  * \param used_data_indices Indices of used data, nullptr for all data
+  * \param num_data Number of used data
+  * \param score Will add prediction to score
+  */
+  void AddPredictionToScoreByBlock(const Dataset* data, const data_size_t* used_data_indices,
+                                   data_size_t num_data, double* score) const;
+
   inline int NumericalDecision(double fval, int node) const {
     uint8_t missing_type = GetMissingType(decision_type_[node]);
     if (std::isnan(fval) && missing_type != MissingType::NaN) {
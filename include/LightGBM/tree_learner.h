@@ -91,6 +91,25 @@ class TreeLearner {
   */
   virtual void AddPredictionToScore(const Tree* tree, double* out_score) const = 0;
 
+  /*!
+  * \brief Add validation data, its data is partitioned into the leaves of each tree during training
+  * \param valid_data Validation data, with the same bin mappers as training data
+  */
+  virtual void AddValidData(const Dataset* /*valid_data*/) {}
+
+  /*!
+  * \brief Using last trained tree to predict score of validation data then adding to out_score
+  * \param valid_idx Index of validation data, in the order they were added
+  * \param tree Last trained tree
+  * \param num_data Number of data of the validation data, the length of out_score
+  * \param out_score output score
+  * \return False if the validation data is not partitioned, then the caller should predict by the tree
+  */
+  virtual bool AddPredictionToValidScore(int /*valid_idx*/, const Tree* /*tree*/, data_size_t /*num_data*/,
+                                         double* /*out_score*/) const {
+    return false;
+  }
+
   virtual void RenewTreeOutput(Tree* tree, const ObjectiveFunction* obj, std::function<double(const label_t*, int)> residual_getter,
                                data_size_t total_num_data, const data_size_t* bag_indices, data_size_t bag_cnt, const double* train_score) const = 0;
 
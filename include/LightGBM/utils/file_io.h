@@ -29,6 +29,14 @@ struct VirtualFileWriter : BinaryWriter {
    */
   virtual bool Init() = 0;
 
+  /*!
+   * \brief Write out all buffered data and finish the file.
+   *        Compressed writers only write the end of the stream here, a writer destroyed
+   *        without Close() leaves a truncated file
+   * \return True when all data was written
+   */
+  virtual bool Close() = 0;
+
   /*!
    * \brief Create appropriate writer for filename
    * \param filename Filename of the data
@@ -73,6 +81,36 @@ struct VirtualFileReader {
   static std::unique_ptr<VirtualFileReader> Make(const std::string& filename);
 };
 
+/*!
+ * \brief A read-only memory mapped file, pages are read from disk on first access
+ *        and can be dropped again by the kernel under memory pressure
+ */
+struct MappedFile {
+  virtual ~MappedFile() {}
+  /*! \brief Start of the mapped file */
+  virtual const char* data() const = 0;
+  /*! \brief Size of the mapped file in bytes */
+  virtual size_t size() const = 0;
+  /*!
+   * \brief Ask the kernel to read a range of the file in the background
+   * \param offset Offset of the range
+   * \param bytes Size of the range
+   */
+  virtual void WillNeed(size_t offset, size_t bytes) const = 0;
+  /*!
+   * \brief Release the pages of a range of the file, they are read again on next access
+   * \param offset Offset of the range
+   * \param bytes Size of the range
+   */
+  virtual void DontNeed(size_t offset, size_t bytes) const = 0;
+  /*!
+   * \brief Map a local uncompressed file into memory
+   * \param filename Filename of the data
+   * \return Mapped file, nullptr if the file cannot be mapped on this platform
+   */
+  static std::unique_ptr<MappedFile> Make(const std::string& filename);
+};
+
 }  // namespace LightGBM
 
 #endif   // LightGBM_UTILS_FILE_IO_H_
@@ -9,9 +9,14 @@
 #include <LightGBM/utils/log.h>
 
 #include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <cstdio>
+#include <deque>
+#include <exception>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <thread>
 #include <utility>
 #include <vector>
@@ -19,48 +24,159 @@
 namespace LightGBM {
 
 /*!
-* \brief A pipeline file reader, use 2 threads, one read block from file, the other process the block
+* \brief Time costs of one PipelineReader::Read call
+*/
+struct PipelineReadStats {
+  /*! \brief Number of blocks read from file */
+  size_t num_blocks = 0;
+  /*! \brief Number of bytes read from file, excluding skipped bytes */
+  size_t num_bytes = 0;
+  /*! \brief Seconds spent by the I/O thread in reading */
+  double read_seconds = 0.0;
+  /*! \brief Seconds spent in process_fun */
+  double process_seconds = 0.0;
+  /*! \brief Seconds that process_fun waited for the I/O thread */
+  double wait_seconds = 0.0;
+};
+
+/*!
+* \brief A pipeline file reader, one persistent thread reads blocks from file into a ring of buffers,
+*        the calling thread processes the blocks in order
 */
 class PipelineReader {
  public:
+  /*! \brief Default size of each block */
+  static const size_t kDefaultBlockSize = 16 * 1024 * 1024;
+  /*! \brief Default number of buffers, one is processed while the other is read */
+  static const int kDefaultNumBuffers = 2;
+
   /*!
   * \brief Read data from a file, use pipeline methods
   * \param filename Filename of data
-  * \process_fun Process function
+  * \param skip_bytes Number of bytes to skip at the beginning of file
+  * \param process_fun Process function, the block is writable and stays valid until process_fun returns
+  * \param block_size Size of each block
+  * \param num_buffers Number of blocks in flight, at least 2
+  * \param out_stats If not nullptr, store the time costs of reading and processing
+  * \return Sum of the return values of process_fun
   */
-  static size_t Read(const char* filename, int skip_bytes, const std::function<size_t(const char*, size_t)>& process_fun) {
+  static size_t Read(const char* filename, int skip_bytes, const std::function<size_t(char*, size_t)>& process_fun,
+                     size_t block_size = kDefaultBlockSize, int num_buffers = kDefaultNumBuffers,
+                     PipelineReadStats* out_stats = nullptr) {
     auto reader = VirtualFileReader::Make(filename);
     if (!reader->Init()) {
       return 0;
     }
-    size_t cnt = 0;
-    const size_t buffer_size =  16 * 1024 * 1024;
-    // buffer used for the process_fun
-    auto buffer_process = std::vector<char>(buffer_size);
-    // buffer used for the file reading
-    auto buffer_read = std::vector<char>(buffer_size);
-    size_t read_cnt = 0;
+    block_size = std::max(block_size, static_cast<size_t>(1));
+    num_buffers = std::max(num_buffers, 2);
+    std::vector<std::vector<char>> buffers(num_buffers, std::vector<char>(block_size));
     if (skip_bytes > 0) {
       // skip first k bytes
-      read_cnt = reader->Read(buffer_process.data(), skip_bytes);
+      size_t remain = static_cast<size_t>(skip_bytes);
+      while (remain > 0) {
+        size_t read_cnt = reader->Read(buffers[0].data(), std::min(remain, block_size));
+        if (read_cnt == 0) {
+          break;
+        }
+        remain -= read_cnt;
+      }
     }
-    // read first block
-    read_cnt = reader->Read(buffer_process.data(), buffer_size);
 
-    size_t last_read_cnt = 0;
-    while (read_cnt > 0) {
-      // start read thread
-      std::thread read_worker = std::thread(
-        [=, &last_read_cnt, &reader, &buffer_read] {
-        last_read_cnt = reader->Read(buffer_read.data(), buffer_size);
-      });
-      // start process
-      cnt += process_fun(buffer_process.data(), read_cnt);
-      // wait for read thread
+    PipelineReadStats stats;
+    // buffers that are ready for reading, and filled blocks ready for processing
+    std::deque<int> free_buffers;
+    std::deque<std::pair<int, size_t>> filled_blocks;
+    for (int i = 0; i < num_buffers; ++i) {
+      free_buffers.push_back(i);
+    }
+    std::mutex mutex;
+    std::condition_variable free_cond, filled_cond;
+    bool stop = false;
+    std::exception_ptr read_exception = nullptr;
+
+    std::thread read_worker([&] {
+      try {
+        while (true) {
+          int buffer_idx = -1;
+          {
+            std::unique_lock<std::mutex> lock(mutex);
+            free_cond.wait(lock, [&] { return stop || !free_buffers.empty(); });
+            if (stop) {
+              return;
+            }
+            buffer_idx = free_buffers.front();
+            free_buffers.pop_front();
+          }
+          auto start_time = std::chrono::steady_clock::now();
+          size_t read_cnt = reader->Read(buffers[buffer_idx].data(), block_size);
+          stats.read_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+          {
+            std::lock_guard<std::mutex> lock(mutex);
+            filled_blocks.emplace_back(buffer_idx, read_cnt);
+          }
+          filled_cond.notify_one();
+          if (read_cnt == 0) {
+            return;
+          }
+        }
+      } catch (...) {
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          read_exception = std::current_exception();
+          filled_blocks.emplace_back(-1, 0);
+        }
+        filled_cond.notify_one();
+      }
+    });
+    // stop the read thread even if process_fun throws
+    auto stop_reader = [&] {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+      }
+      free_cond.notify_one();
       read_worker.join();
-      // exchange the buffer
-      std::swap(buffer_process, buffer_read);
-      read_cnt = last_read_cnt;
+    };
+
+    size_t cnt = 0;
+    try {
+      while (true) {
+        std::pair<int, size_t> block;
+        {
+          auto start_time = std::chrono::steady_clock::now();
+          std::unique_lock<std::mutex> lock(mutex);
+          filled_cond.wait(lock, [&] { return !filled_blocks.empty(); });
+          block = filled_blocks.front();
+          filled_blocks.pop_front();
+          stats.wait_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+        }
+        if (block.second == 0) {
+          break;
+        }
+        ++stats.num_blocks;
+        stats.num_bytes += block.second;
+        auto start_time = std::chrono::steady_clock::now();
+        cnt += process_fun(buffers[block.first].data(), block.second);
+        stats.process_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          free_buffers.push_back(block.first);
+        }
+        free_cond.notify_one();
+      }
+    } catch (...) {
+      stop_reader();
+      throw;
+    }
+    stop_reader();
+    if (read_exception != nullptr) {
+      std::rethrow_exception(read_exception);
+    }
+    Log::Debug("Read %zu blocks (%.1f MBs) from %s: %.2f seconds reading, %.2f seconds processing, %.2f seconds waiting for reads",
+               stats.num_blocks, 1.0 * stats.num_bytes / (1024 * 1024), filename,
+               stats.read_seconds, stats.process_seconds, stats.wait_seconds);
+    if (out_stats != nullptr) {
+      *out_stats = stats;
     }
     return cnt;
   }
@@ -5,6 +5,7 @@
 #ifndef LIGHTGBM_UTILS_RANDOM_H_
 #define LIGHTGBM_UTILS_RANDOM_H_
 
+#include <cmath>
 #include <cstdint>
 #include <random>
 #include <set>
@@ -60,6 +61,16 @@ class Random {
     // get random float in [0,1)
     return static_cast<float>(RandInt16()) / (32768.0f);
   }
+
+  /*!
+  * \brief Threshold for comparing with NextShort(0, 32768) without float conversion,
+  *        NextShort(0, 32768) < ShortThreshold(prob) is the same as NextFloat() < prob
+  * \param prob Probability
+  * \return The threshold
+  */
+  inline static int ShortThreshold(double prob) {
+    return static_cast<int>(std::ceil(prob * 32768.0));
+  }
   /*!
   * \brief Sample K data from {0,1,...,N-1}
   * \param N
@@ -9,16 +9,92 @@
 #include <LightGBM/utils/pipeline_reader.h>
 #include <LightGBM/utils/random.h>
 
+#include <algorithm>
 #include <string>
 #include <cstdio>
 #include <functional>
 #include <sstream>
+#include <utility>
 #include <vector>
 
 namespace LightGBM {
 
 const size_t kGbs = size_t(1024) * 1024 * 1024;
 
+/*!
+* \brief Non-owning view of one line of text, the content is always terminated by '\0'
+*/
+class TextLine {
+ public:
+  TextLine() : data_(""), size_(0) {}
+  TextLine(const char* data, size_t size) : data_(data), size_(size) {}
+  inline const char* c_str() const { return data_; }
+  inline const char* data() const { return data_; }
+  inline size_t size() const { return size_; }
+  inline bool empty() const { return size_ == 0; }
+  inline std::string ToString() const { return std::string(data_, size_); }
+
+ private:
+  const char* data_;
+  size_t size_;
+};
+
+/*!
+* \brief Owns lines of text packed into large chunks, avoid one allocation per line
+*/
+class TextLineBuffer {
+ public:
+  TextLineBuffer() {}
+  TextLineBuffer(TextLineBuffer&&) = default;
+  TextLineBuffer& operator=(TextLineBuffer&&) = default;
+  /*! \brief Disable copy, lines point into the chunks */
+  TextLineBuffer(const TextLineBuffer&) = delete;
+  TextLineBuffer& operator=(const TextLineBuffer&) = delete;
+
+  /*!
+  * \brief Append a copy of one line
+  * \param buffer Content of line, doesn't need to be terminated
+  * \param size Length of line
+  */
+  inline void Append(const char* buffer, size_t size) {
+    if (chunks_.empty() || chunks_.back().capacity() - chunks_.back().size() < size + 1) {
+      // grow chunk size with the total size, chunks are never reallocated so lines stay valid
+      size_t chunk_size = total_bytes_ < kMinChunkSize ? kMinChunkSize : total_bytes_;
+      chunk_size = chunk_size > kMaxChunkSize ? kMaxChunkSize : chunk_size;
+      chunk_size = chunk_size < size + 1 ? size + 1 : chunk_size;
+      chunks_.emplace_back();
+      chunks_.back().reserve(chunk_size);
+    }
+    auto& chunk = chunks_.back();
+    const size_t offset = chunk.size();
+    chunk.insert(chunk.end(), buffer, buffer + size);
+    chunk.push_back('\0');
+    total_bytes_ += size + 1;
+    lines_.emplace_back(chunk.data() + offset, size);
+  }
+
+  inline size_t size() const { return lines_.size(); }
+  inline bool empty() const { return lines_.empty(); }
+  inline const TextLine& operator[](size_t i) const { return lines_[i]; }
+
+  /*! \brief Release all lines */
+  inline void clear() {
+    std::vector<TextLine>().swap(lines_);
+    std::vector<std::vector<char>>().swap(chunks_);
+    total_bytes_ = 0;
+  }
+
+ private:
+  static const size_t kMinChunkSize = 64 * 1024;
+  static const size_t kMaxChunkSize = 16 * 1024 * 1024;
+  /*! \brief Storage of line contents */
+  std::vector<std::vector<char>> chunks_;
+  /*! \brief Views into chunks_ */
+  std::vector<TextLine> lines_;
+  /*! \brief Bytes used in chunks_ */
+  size_t total_bytes_ = 0;
+};
+
 /*!
 * \brief Read text data from file
 */
@@ -29,9 +105,14 @@ class TextReader {
   * \brief Constructor
   * \param filename Filename of data
   * \param is_skip_first_line True if need to skip header
+  * \param progress_interval_bytes Interval of bytes to log the reading progress
+  * \param read_block_size Size of each block read from file
+  * \param read_num_buffers Number of blocks read ahead of processing
   */
-  TextReader(const char* filename, bool is_skip_first_line, size_t progress_interval_bytes = SIZE_MAX):
-    filename_(filename), is_skip_first_line_(is_skip_first_line), read_progress_interval_bytes_(progress_interval_bytes) {
+  TextReader(const char* filename, bool is_skip_first_line, size_t progress_interval_bytes = SIZE_MAX,
+             size_t read_block_size = PipelineReader::kDefaultBlockSize, int read_num_buffers = PipelineReader::kDefaultNumBuffers):
+    filename_(filename), is_skip_first_line_(is_skip_first_line), read_progress_interval_bytes_(progress_interval_bytes),
+    read_block_size_(read_block_size), read_num_buffers_(read_num_buffers) {
     if (is_skip_first_line_) {
       auto reader = VirtualFileReader::Make(filename);
       if (!reader->Init()) {
@@ -61,41 +142,11 @@ class TextReader {
     }
   }
   /*!
-  * \brief Destructor
-  */
-  ~TextReader() {
-    Clear();
-  }
-  /*!
-  * \brief Clear cached data
-  */
-  inline void Clear() {
-    lines_.clear();
-    lines_.shrink_to_fit();
-  }
-  /*!
   * \brief return first line of data
   */
   inline std::string first_line() {
     return first_line_;
   }
-  /*!
-  * \brief Get text data that read from file
-  * \return Text data, store in std::vector by line
-  */
-  inline std::vector<std::string>& Lines() { return lines_; }
-  /*!
-  * \brief Get joined text data that read from file
-  * \return Text data, store in std::string, joined all lines by delimiter
-  */
-  inline std::string JoinedLines(std::string delimiter = "\n") {
-    std::stringstream ss;
-    for (auto line : lines_) {
-      ss << line << delimiter;
-    }
-    return ss.str();
-  }
-
   INDEX_T ReadAllAndProcess(const std::function<void(INDEX_T, const char*, size_t)>& process_fun) {
     last_line_ = "";
     INDEX_T total_cnt = 0;
@@ -124,7 +175,7 @@ class TextReader {
           ++i;
           ++total_cnt;
           // skip end of line
-          while ((buffer_process[i] == '\n' || buffer_process[i] == '\r') && i < read_cnt) { ++i; }
+          while (i < read_cnt && (buffer_process[i] == '\n' || buffer_process[i] == '\r')) { ++i; }
           last_i = i;
         } else {
           ++i;
@@ -141,7 +192,7 @@ class TextReader {
       }
 
       return cnt;
-    });
+    }, read_block_size_, read_num_buffers_);
     // if last line of file doesn't contain end of line
     if (last_line_.size() > 0) {
       Log::Info("Warning: last line of %s has no end of line, still using this line", filename_);
@@ -153,13 +204,24 @@ class TextReader {
   }
 
   /*!
-  * \brief Read all text data from file in memory
+  * \brief Read all text data from file in memory, one string per line
   * \return number of lines of text data
   */
-  INDEX_T ReadAllLines() {
+  INDEX_T ReadAllLines(std::vector<std::string>* out_lines) {
     return ReadAllAndProcess(
       [=](INDEX_T, const char* buffer, size_t size) {
-      lines_.emplace_back(buffer, size);
+      out_lines->emplace_back(buffer, size);
+    });
+  }
+
+  /*!
+  * \brief Read all text data from file in memory, packed into out_lines
+  * \return number of lines of text data
+  */
+  INDEX_T ReadAllLines(TextLineBuffer* out_lines) {
+    return ReadAllAndProcess(
+      [=](INDEX_T, const char* buffer, size_t size) {
+      out_lines->Append(buffer, size);
     });
   }
 
@@ -197,21 +259,24 @@ class TextReader {
       }
     });
   }
+
   /*!
-  * \brief Read part of text data from file in memory, use filter_fun to filter data
+  * \brief Read part of text data from file in memory, packed into out_lines
   * \param filter_fun Function that perform data filter
   * \param out_used_data_indices Store line indices that read text data
+  * \param out_lines Store the used lines
   * \return The number of total data
   */
-  INDEX_T ReadAndFilterLines(const std::function<bool(INDEX_T)>& filter_fun, std::vector<INDEX_T>* out_used_data_indices) {
+  INDEX_T ReadAndFilterLines(const std::function<bool(INDEX_T)>& filter_fun, std::vector<INDEX_T>* out_used_data_indices,
+                             TextLineBuffer* out_lines) {
     out_used_data_indices->clear();
     INDEX_T total_cnt = ReadAllAndProcess(
-        [&filter_fun, &out_used_data_indices, this]
+        [&filter_fun, &out_used_data_indices, &out_lines]
     (INDEX_T line_idx , const char* buffer, size_t size) {
       bool is_used = filter_fun(line_idx);
       if (is_used) {
         out_used_data_indices->push_back(line_idx);
-        lines_.emplace_back(buffer, size);
+        out_lines->Append(buffer, size);
       }
     });
     return total_cnt;
@@ -248,14 +313,22 @@ class TextReader {
     });
   }
 
-  INDEX_T ReadAllAndProcessParallelWithFilter(const std::function<void(INDEX_T, const std::vector<std::string>&)>& process_fun, const std::function<bool(INDEX_T, INDEX_T)>& filter_fun) {
+  /*!
+  * \brief Read lines block by block, and process each block of lines in parallel.
+  *        Lines are views into the read buffer and only valid inside process_fun.
+  * \param process_fun Process function, first argument is index of first line in the block
+  * \param filter_fun Function that perform data filter, arguments are number of used lines and number of total lines
+  * \return The number of total data
+  */
+  INDEX_T ReadAllAndProcessParallelWithFilter(const std::function<void(INDEX_T, const std::vector<TextLine>&)>& process_fun, const std::function<bool(INDEX_T, INDEX_T)>& filter_fun) {
     last_line_ = "";
     INDEX_T total_cnt = 0;
     size_t bytes_read = 0;
     INDEX_T used_cnt = 0;
+    std::vector<TextLine> line_views;
     PipelineReader::Read(filename_, skip_bytes_,
-        [&process_fun, &filter_fun, &total_cnt, &bytes_read, &used_cnt, this]
-    (const char* buffer_process, size_t read_cnt) {
+        [&process_fun, &filter_fun, &total_cnt, &bytes_read, &used_cnt, &line_views, this]
+    (char* buffer_process, size_t read_cnt) {
       size_t cnt = 0;
       size_t i = 0;
       size_t last_i = 0;
@@ -270,13 +343,17 @@ class TextReader {
           if (last_line_.size() > 0) {
             last_line_.append(buffer_process + last_i, i - last_i);
             if (filter_fun(used_cnt, total_cnt)) {
-              lines_.push_back(last_line_);
+              // keep the line crossing blocks alive until the block is processed
+              std::swap(cross_line_, last_line_);
+              line_views.emplace_back(cross_line_.c_str(), cross_line_.size());
               ++used_cnt;
             }
             last_line_ = "";
           } else {
             if (filter_fun(used_cnt, total_cnt)) {
-              lines_.emplace_back(buffer_process + last_i, i - last_i);
+              // terminate the line inside the read buffer
+              buffer_process[i] = '\0';
+              line_views.emplace_back(buffer_process + last_i, i - last_i);
               ++used_cnt;
             }
           }
@@ -284,14 +361,14 @@ class TextReader {
           ++i;
           ++total_cnt;
           // skip end of line
-          while ((buffer_process[i] == '\n' || buffer_process[i] == '\r') && i < read_cnt) { ++i; }
+          while (i < read_cnt && (buffer_process[i] == '\n' || buffer_process[i] == '\r')) { ++i; }
           last_i = i;
         } else {
           ++i;
         }
       }
-      process_fun(start_idx, lines_);
-      lines_.clear();
+      process_fun(start_idx, line_views);
+      line_views.clear();
       if (last_i != read_cnt) {
         last_line_.append(buffer_process + last_i, read_cnt - last_i);
       }
@@ -303,27 +380,28 @@ class TextReader {
       }
 
       return cnt;
-    });
+    }, read_block_size_, read_num_buffers_);
     // if last line of file doesn't contain end of line
     if (last_line_.size() > 0) {
       Log::Info("Warning: last line of %s has no end of line, still using this line", filename_);
       if (filter_fun(used_cnt, total_cnt)) {
-        lines_.push_back(last_line_);
-        process_fun(used_cnt, lines_);
+        line_views.emplace_back(last_line_.c_str(), last_line_.size());
+        process_fun(used_cnt, line_views);
       }
-      lines_.clear();
+      line_views.clear();
       ++total_cnt;
       ++used_cnt;
       last_line_ = "";
     }
+    std::string().swap(cross_line_);
     return total_cnt;
   }
 
-  INDEX_T ReadAllAndProcessParallel(const std::function<void(INDEX_T, const std::vector<std::string>&)>& process_fun) {
+  INDEX_T ReadAllAndProcessParallel(const std::function<void(INDEX_T, const std::vector<TextLine>&)>& process_fun) {
     return ReadAllAndProcessParallelWithFilter(process_fun, [](INDEX_T, INDEX_T) { return true; });
   }
 
-  INDEX_T ReadPartAndProcessParallel(const std::vector<INDEX_T>& used_data_indices, const std::function<void(INDEX_T, const std::vector<std::string>&)>& process_fun) {
+  INDEX_T ReadPartAndProcessParallel(const std::vector<INDEX_T>& used_data_indices, const std::function<void(INDEX_T, const std::vector<TextLine>&)>& process_fun) {
     return ReadAllAndProcessParallelWithFilter(process_fun,
       [&used_data_indices](INDEX_T used_cnt, INDEX_T total_cnt) {
       if (static_cast<size_t>(used_cnt) < used_data_indices.size() && total_cnt == used_data_indices[used_cnt]) {
@@ -337,15 +415,19 @@ class TextReader {
  private:
   /*! \brief Filename of text data */
   const char* filename_;
-  /*! \brief Cache the read text data */
-  std::vector<std::string> lines_;
   /*! \brief Buffer for last line */
   std::string last_line_;
+  /*! \brief Completed line that crossed two read blocks */
+  std::string cross_line_;
   /*! \brief first line */
   std::string first_line_ = "";
   /*! \brief is skip first line */
   bool is_skip_first_line_ = false;
   size_t read_progress_interval_bytes_;
+  /*! \brief Size of each block read from file */
+  size_t read_block_size_;
+  /*! \brief Number of blocks read ahead of processing */
+  int read_num_buffers_;
   /*! \brief is skip first line */
   int skip_bytes_ = 0;
 };
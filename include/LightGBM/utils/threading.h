@@ -114,11 +114,25 @@ class ParallelPartitionRunner {
     }
   }
 
-  template<bool FORCE_SIZE>
+  /*!
+   * \brief Partition cnt indices in parallel blocks, and write the left part then the right part into out
+   * \tparam IN_PLACE With two buffers and a single block, func writes the left part directly into out
+   *         instead of the left buffer, which saves copying it. Only for a func that reads its input
+   *         in order from out itself, i.e. the j-th index of the block from out[j] before it writes
+   *         the (j + 1)-th left index, so it never reads a position it has already written.
+   *         Without IN_PLACE, func must not read its input through out
+   * \param func Partitions one block, returns the number of indices in its left part
+   * \param out Output indices
+   * \param placed_fun If not nullptr, called with each range of out once its indices are placed,
+   *        and with the number of indices in the left part
+   * \return Number of indices in the left part
+   */
+  template<bool FORCE_SIZE, bool IN_PLACE = false>
   INDEX_T Run(
       INDEX_T cnt,
       const std::function<INDEX_T(int, INDEX_T, INDEX_T, INDEX_T*, INDEX_T*)>& func,
-      INDEX_T* out) {
+      INDEX_T* out,
+      const std::function<void(INDEX_T, INDEX_T, INDEX_T)>& placed_fun = nullptr) {
     int nblock = 1;
     INDEX_T inner_size = cnt;
     if (FORCE_SIZE) {
@@ -141,7 +155,8 @@ class ParallelPartitionRunner {
         right_cnts_[i] = 0;
         continue;
       }
-      auto left_ptr = left_.data() + cur_start;
+      // the left part of a single block is written in place, behind the reading position of func
+      auto left_ptr = (IN_PLACE && TWO_BUFFER && nblock == 1) ? out : left_.data() + cur_start;
       INDEX_T* right_ptr = nullptr;
       if (TWO_BUFFER) {
         right_ptr = right_.data() + cur_start;
@@ -168,6 +183,14 @@ class ParallelPartitionRunner {
     data_size_t left_cnt = left_write_pos_[nblock - 1] + left_cnts_[nblock - 1];
 
     auto right_start = out + left_cnt;
+    if (IN_PLACE && TWO_BUFFER && nblock == 1) {
+      std::copy_n(right_.data(), right_cnts_[0], right_start);
+      if (placed_fun != nullptr) {
+        placed_fun(0, left_cnt, left_cnt);
+        placed_fun(left_cnt, right_cnts_[0], left_cnt);
+      }
+      return left_cnt;
+    }
 #pragma omp parallel for schedule(static, 1) num_threads(num_threads_)
     for (int i = 0; i < nblock; ++i) {
       std::copy_n(left_.data() + offsets_[i], left_cnts_[i],
@@ -179,6 +202,11 @@ class ParallelPartitionRunner {
         std::copy_n(left_.data() + offsets_[i] + left_cnts_[i], right_cnts_[i],
                     right_start + right_write_pos_[i]);
       }
+      // the indices are still in cache
+      if (placed_fun != nullptr) {
+        placed_fun(left_write_pos_[i], left_cnts_[i], left_cnt);
+        placed_fun(left_cnt + right_write_pos_[i], right_cnts_[i], left_cnt);
+      }
     }
     return left_cnt;
   }
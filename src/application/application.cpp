@@ -57,9 +57,10 @@ void Application::LoadParameters(int argc, char** argv) {
   bool config_file_ok = true;
   if (all_params.count("config") > 0) {
     TextReader<size_t> config_reader(all_params["config"][0].c_str(), false);
-    config_reader.ReadAllLines();
-    if (!config_reader.Lines().empty()) {
-      for (auto& line : config_reader.Lines()) {
+    std::vector<std::string> config_lines;
+    config_reader.ReadAllLines(&config_lines);
+    if (!config_lines.empty()) {
+      for (auto& line : config_lines) {
         // remove str after "#"
         if (line.size() > 0 && std::string::npos != line.find_first_of("#")) {
           line.erase(line.find_first_of("#"));
@@ -115,7 +116,7 @@ void Application::LoadData() {
   }
   // need save binary file
   if (config_.save_binary) {
-    train_data_->SaveBinaryFile(nullptr);
+    train_data_->SaveBinaryFile(nullptr, config_.save_binary_num_shards);
   }
   // create training metric
   if (config_.is_provide_training_metric) {
@@ -142,7 +143,7 @@ void Application::LoadData() {
       valid_datas_.push_back(std::move(new_dataset));
       // need save binary file
       if (config_.save_binary) {
-        valid_datas_.back()->SaveBinaryFile(nullptr);
+        valid_datas_.back()->SaveBinaryFile(nullptr, config_.save_binary_num_shards);
       }
 
       // add metric for validation data
@@ -225,25 +226,26 @@ void Application::Predict() {
     predictor.Predict(config_.data.c_str(), config_.output_result.c_str(), config_.header, config_.predict_disable_shape_check,
                       config_.precise_float_parser);
     TextReader<int> result_reader(config_.output_result.c_str(), false);
-    result_reader.ReadAllLines();
+    std::vector<std::string> result_lines;
+    result_reader.ReadAllLines(&result_lines);
 
-    size_t nrow = result_reader.Lines().size();
+    size_t nrow = result_lines.size();
     size_t ncol = 0;
     if (nrow > 0) {
-      ncol = Common::StringToArray<int>(result_reader.Lines()[0], '\t').size();
+      ncol = Common::StringToArray<int>(result_lines[0], '\t').size();
     }
     std::vector<int> pred_leaf;
     pred_leaf.resize(nrow * ncol);
 
     #pragma omp parallel for num_threads(OMP_NUM_THREADS()) schedule(static)
     for (int irow = 0; irow < static_cast<int>(nrow); ++irow) {
-      auto line_vec = Common::StringToArray<int>(result_reader.Lines()[irow], '\t');
+      auto line_vec = Common::StringToArray<int>(result_lines[irow], '\t');
       CHECK_EQ(line_vec.size(), ncol);
       for (int i_row_item = 0; i_row_item < static_cast<int>(ncol); ++i_row_item) {
         pred_leaf[irow * ncol + i_row_item] = line_vec[i_row_item];
       }
       // Free memory
-      result_reader.Lines()[irow].clear();
+      result_lines[irow].clear();
     }
     DatasetLoader dataset_loader(config_, nullptr,
                                  config_.num_class, config_.data.c_str());
@@ -227,9 +227,9 @@ class Predictor {
       }
     };
 
-    std::function<void(data_size_t, const std::vector<std::string>&)>
+    std::function<void(data_size_t, const std::vector<TextLine>&)>
         process_fun = [&parser_fun, &writer, this](
-                          data_size_t, const std::vector<std::string>& lines) {
+                          data_size_t, const std::vector<TextLine>& lines) {
       std::vector<std::pair<int, double>> oneline_features;
       std::vector<std::string> result_to_write(lines.size());
       OMP_INIT_EX();
@@ -253,6 +253,9 @@ class Predictor {
       }
     };
     predict_data_reader.ReadAllAndProcessParallel(process_fun);
+    if (!writer->Close()) {
+      Log::Fatal("Prediction results file %s cannot be written", result_filename);
+    }
   }
 
  private:
@@ -6,6 +6,7 @@
 #ifndef LIGHTGBM_BOOSTING_BAGGING_HPP_
 #define LIGHTGBM_BOOSTING_BAGGING_HPP_
 
+#include <algorithm>
 #include <string>
 
 namespace LightGBM {
@@ -158,18 +159,8 @@ class BaggingSampleStrategy : public SampleStrategy {
     if (cnt <= 0) {
       return 0;
     }
-    data_size_t cur_left_cnt = 0;
-    data_size_t cur_right_pos = cnt;
-    // random bagging, minimal unit is one record
-    for (data_size_t i = 0; i < cnt; ++i) {
-      auto cur_idx = start + i;
-      if (bagging_rands_[cur_idx / bagging_rand_block_].NextFloat() < config_->bagging_fraction) {
-        buffer[cur_left_cnt++] = cur_idx;
-      } else {
-        buffer[--cur_right_pos] = cur_idx;
-      }
-    }
-    return cur_left_cnt;
+    const int threshold = Random::ShortThreshold(config_->bagging_fraction);
+    return BaggingHelperInner(start, cnt, buffer, [threshold](data_size_t) { return threshold; });
   }
 
   data_size_t BalancedBaggingHelper(data_size_t start, data_size_t cnt, data_size_t* buffer) {
@@ -177,24 +168,34 @@ class BaggingSampleStrategy : public SampleStrategy {
       return 0;
     }
     auto label_ptr = train_data_->metadata().label();
+    const int pos_threshold = Random::ShortThreshold(config_->pos_bagging_fraction);
+    const int neg_threshold = Random::ShortThreshold(config_->neg_bagging_fraction);
+    return BaggingHelperInner(start, cnt, buffer, [=](data_size_t idx) {
+      return label_ptr[idx] > 0 ? pos_threshold : neg_threshold;
+    });
+  }
+
+  /*!
+  * \brief Put the in-bag data of [start, start + cnt) at the beginning of buffer, the rest at the end in reverse order
+  * \param get_threshold Returns the threshold of Random::ShortThreshold for a record
+  */
+  template <typename THRESHOLD_FUN>
+  data_size_t BaggingHelperInner(data_size_t start, data_size_t cnt, data_size_t* buffer,
+                                 const THRESHOLD_FUN& get_threshold) {
     data_size_t cur_left_cnt = 0;
     data_size_t cur_right_pos = cnt;
     // random bagging, minimal unit is one record
-    for (data_size_t i = 0; i < cnt; ++i) {
-      auto cur_idx = start + i;
-      bool is_pos = label_ptr[start + i] > 0;
-      bool is_in_bag = false;
-      if (is_pos) {
-        is_in_bag = bagging_rands_[cur_idx / bagging_rand_block_].NextFloat() <
-                    config_->pos_bagging_fraction;
-      } else {
-        is_in_bag = bagging_rands_[cur_idx / bagging_rand_block_].NextFloat() <
-                    config_->neg_bagging_fraction;
-      }
-      if (is_in_bag) {
-        buffer[cur_left_cnt++] = cur_idx;
-      } else {
-        buffer[--cur_right_pos] = cur_idx;
+    for (data_size_t i = 0; i < cnt;) {
+      const data_size_t cur_idx = start + i;
+      Random* rand = &bagging_rands_[cur_idx / bagging_rand_block_];
+      const data_size_t block_end = std::min(cnt, i + bagging_rand_block_ - cur_idx % bagging_rand_block_);
+      for (; i < block_end; ++i) {
+        // write both ends and move one of them, so there is no branch on a random outcome
+        const data_size_t is_in_bag = rand->NextShort(0, 32768) < get_threshold(start + i);
+        buffer[cur_left_cnt] = start + i;
+        buffer[cur_right_pos - 1] = start + i;
+        cur_left_cnt += is_in_bag;
+        cur_right_pos -= 1 - is_in_bag;
       }
     }
     return cur_left_cnt;
@@ -70,6 +70,10 @@ inline void CUDAScoreUpdater::AddScore(const TreeLearner* tree_learner, const Tr
   }
 }
 
+inline void CUDAScoreUpdater::AddScore(const TreeLearner*, int, const Tree* tree, int cur_tree_id) {
+  AddScore(tree, cur_tree_id);
+}
+
 inline void CUDAScoreUpdater::AddScore(const Tree* tree, const data_size_t* data_indices,
                       data_size_t data_cnt, int cur_tree_id) {
   Common::FunctionTimer fun_timer("ScoreUpdater::AddScore", global_timer);
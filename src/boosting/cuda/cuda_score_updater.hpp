@@ -26,6 +26,8 @@ class CUDAScoreUpdater: public ScoreUpdater {
 
   inline void AddScore(const TreeLearner* tree_learner, const Tree* tree, int cur_tree_id) override;
 
+  inline void AddScore(const TreeLearner* tree_learner, int valid_idx, const Tree* tree, int cur_tree_id) override;
+
   inline void AddScore(const Tree* tree, const data_size_t* data_indices,
                        data_size_t data_cnt, int cur_tree_id) override;
 
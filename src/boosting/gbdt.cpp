@@ -202,6 +202,7 @@ void GBDT::AddValidDataset(const Dataset* valid_data,
     }
   }
   valid_score_updater_.push_back(std::move(new_score_updater));
+  tree_learner_->AddValidData(valid_data);
   valid_metrics_.emplace_back();
   for (const auto& metric : valid_metrics) {
     valid_metrics_.back().push_back(metric);
@@ -503,8 +504,8 @@ void GBDT::UpdateScore(const Tree* tree, const int cur_tree_id) {
 
 
   // update validation score
-  for (auto& score_updater : valid_score_updater_) {
-    score_updater->AddScore(tree, cur_tree_id);
+  for (size_t i = 0; i < valid_score_updater_.size(); ++i) {
+    valid_score_updater_[i]->AddScore(tree_learner_.get(), static_cast<int>(i), tree, cur_tree_id);
   }
 }
 
@@ -415,7 +415,7 @@ bool GBDT::SaveModelToFile(int start_iteration, int num_iteration, int feature_i
   }
   std::string str_to_write = SaveModelToString(start_iteration, num_iteration, feature_importance_type);
   auto size = writer->Write(str_to_write.c_str(), str_to_write.size());
-  return size > 0;
+  return writer->Close() && size > 0;
 }
 
 bool GBDT::LoadModelFromString(const char* buffer, size_t len) {
@@ -6,11 +6,13 @@
 #ifndef LIGHTGBM_BOOSTING_GOSS_HPP_
 #define LIGHTGBM_BOOSTING_GOSS_HPP_
 
-#include <LightGBM/utils/array_args.h>
 #include <LightGBM/sample_strategy.h>
 
 #include <algorithm>
+#include <cstring>
+#include <functional>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 namespace LightGBM {
@@ -127,8 +129,7 @@ class GOSSStrategy : public SampleStrategy {
     data_size_t top_k = static_cast<data_size_t>(cnt * config_->top_rate);
     data_size_t other_k = static_cast<data_size_t>(cnt * config_->other_rate);
     top_k = std::max(1, top_k);
-    ArrayArgs<score_t>::ArgMaxAtK(&tmp_gradients, 0, static_cast<int>(tmp_gradients.size()), top_k - 1);
-    score_t threshold = tmp_gradients[top_k - 1];
+    score_t threshold = KthLargest(tmp_gradients, top_k);
 
     score_t multiply = static_cast<score_t>(cnt - top_k) / other_k;
     data_size_t cur_left_cnt = 0;
@@ -136,20 +137,15 @@ class GOSSStrategy : public SampleStrategy {
     data_size_t big_weight_cnt = 0;
     for (data_size_t i = 0; i < cnt; ++i) {
       auto cur_idx = start + i;
-      score_t grad = 0.0f;
-      for (int cur_tree_id = 0; cur_tree_id < num_tree_per_iteration_; ++cur_tree_id) {
-        size_t idx = static_cast<size_t>(cur_tree_id) * num_data_ + cur_idx;
-        grad += std::fabs(gradients[idx] * hessians[idx]);
-      }
-      if (grad >= threshold) {
+      if (tmp_gradients[i] >= threshold) {
         buffer[cur_left_cnt++] = cur_idx;
         ++big_weight_cnt;
       } else {
         data_size_t sampled = cur_left_cnt - big_weight_cnt;
-        data_size_t rest_need = other_k - sampled;
-        data_size_t rest_all = (cnt - i) - (top_k - big_weight_cnt);
-        double prob = (rest_need) / static_cast<double>(rest_all);
-        if (bagging_rands_[cur_idx / bagging_rand_block_].NextFloat() < prob) {
+        int64_t rest_need = other_k - sampled;
+        int64_t rest_all = (cnt - i) - (top_k - big_weight_cnt);
+        // the same as NextFloat() < rest_need / rest_all, without the division
+        if (bagging_rands_[cur_idx / bagging_rand_block_].NextShort(0, 32768) * rest_all < rest_need * 32768) {
           buffer[cur_left_cnt++] = cur_idx;
           for (int cur_tree_id = 0; cur_tree_id < num_tree_per_iteration_; ++cur_tree_id) {
             size_t idx = static_cast<size_t>(cur_tree_id) * num_data_ + cur_idx;
@@ -163,6 +159,47 @@ class GOSSStrategy : public SampleStrategy {
     }
     return cur_left_cnt;
   }
+
+  /*!
+  * \brief Get the k-th (1-based) largest of non-negative values.
+  *        Non-negative floating point numbers are ordered as their bits, so a histogram of the highest bits
+  *        finds the bucket that holds the k-th largest, and only the values in that bucket are selected from.
+  */
+  static score_t KthLargest(const std::vector<score_t>& values, data_size_t k) {
+    typedef std::conditional<sizeof(score_t) == 4, uint32_t, uint64_t>::type bits_t;
+    const int kNumBucketBits = 16;
+    const int shift = static_cast<int>(sizeof(score_t)) * 8 - kNumBucketBits;
+    const data_size_t cnt = static_cast<data_size_t>(values.size());
+    std::vector<score_t> candidates;
+    data_size_t num_larger = 0;
+    if (cnt < (1 << kNumBucketBits)) {
+      candidates = values;
+    } else {
+      auto bucket_of = [shift](score_t value) {
+        bits_t bits;
+        std::memcpy(&bits, &value, sizeof(score_t));
+        return static_cast<int>(bits >> shift);
+      };
+      std::vector<data_size_t> cnt_in_bucket(1 << kNumBucketBits, 0);
+      for (data_size_t i = 0; i < cnt; ++i) {
+        ++cnt_in_bucket[bucket_of(values[i])];
+      }
+      int bucket = (1 << kNumBucketBits) - 1;
+      while (num_larger + cnt_in_bucket[bucket] < k) {
+        num_larger += cnt_in_bucket[bucket];
+        --bucket;
+      }
+      candidates.reserve(cnt_in_bucket[bucket]);
+      for (data_size_t i = 0; i < cnt; ++i) {
+        if (bucket_of(values[i]) == bucket) {
+          candidates.push_back(values[i]);
+        }
+      }
+    }
+    std::nth_element(candidates.begin(), candidates.begin() + (k - num_larger - 1), candidates.end(),
+                     std::greater<score_t>());
+    return candidates[k - num_larger - 1];
+  }
 };
 
 }  // namespace LightGBM
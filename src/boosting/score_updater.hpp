@@ -91,6 +91,22 @@ class ScoreUpdater {
     tree_learner->AddPredictionToScore(tree, score_.data() + offset);
   }
   /*!
+  * \brief Adding prediction score, only used for validation data.
+  *        The validation data is partitioned into tree leaves along with training data,
+  *        if the tree learner does not do so, the tree is used to predict.
+  * \param tree_learner
+  * \param valid_idx Index of this validation data in tree_learner
+  * \param tree Trained tree model
+  * \param cur_tree_id Current tree for multiclass training
+  */
+  virtual inline void AddScore(const TreeLearner* tree_learner, int valid_idx, const Tree* tree, int cur_tree_id) {
+    Common::FunctionTimer fun_timer("ScoreUpdater::AddScore", global_timer);
+    const size_t offset = static_cast<size_t>(num_data_) * cur_tree_id;
+    if (!tree_learner->AddPredictionToValidScore(valid_idx, tree, num_data_, score_.data() + offset)) {
+      tree->AddPredictionToScore(data_, num_data_, score_.data() + offset);
+    }
+  }
+  /*!
   * \brief Using tree model to get prediction number, then adding to scores for parts of data
   *        Used for prediction of training out-of-bag data
   * \param tree Trained tree model
@@ -909,8 +909,12 @@ using LightGBM::Log;
 using LightGBM::Network;
 using LightGBM::Random;
 using LightGBM::ReduceScatterFunction;
+using LightGBM::RowBatch;
 using LightGBM::SingleRowPredictor;
 
+// number of sparse rows collected before their values are binned feature by feature
+const int kRowBatchSize = 1024;
+
 // some help functions used to convert data
 
 std::function<std::vector<double>(int row_idx)>
@@ -1215,13 +1219,18 @@ int LGBM_DatasetPushRowsByCSR(DatasetHandle dataset,
   if (p_dataset->has_raw()) {
     p_dataset->ResizeRaw(p_dataset->num_numeric_features() + nrow);
   }
+  const int num_blocks = (nrow + kRowBatchSize - 1) / kRowBatchSize;
+  std::vector<RowBatch> row_batches(OMP_NUM_THREADS());
   OMP_INIT_EX();
   #pragma omp parallel for num_threads(OMP_NUM_THREADS()) schedule(static)
-  for (int i = 0; i < nrow; ++i) {
+  for (int block = 0; block < num_blocks; ++block) {
     OMP_LOOP_EX_BEGIN();
     const int tid = omp_get_thread_num();
-    auto one_row = get_row_fun(i);
-    p_dataset->PushOneRow(tid, static_cast<data_size_t>(start_row + i), one_row);
+    const int block_end = std::min(nrow, (block + 1) * kRowBatchSize);
+    for (int i = block * kRowBatchSize; i < block_end; ++i) {
+      p_dataset->AddOneRow(static_cast<data_size_t>(start_row + i), get_row_fun(i), &row_batches[tid]);
+    }
+    p_dataset->PushRowBatch(tid, &row_batches[tid]);
     OMP_LOOP_EX_END();
   }
   OMP_THROW_EX();
@@ -1261,14 +1270,20 @@ int LGBM_DatasetPushRowsByCSRWithMetadata(DatasetHandle dataset,
 
   const int max_omp_threads = p_dataset->omp_max_threads() > 0 ? p_dataset->omp_max_threads() : OMP_NUM_THREADS();
 
+  const int num_blocks = (nrow + kRowBatchSize - 1) / kRowBatchSize;
+  std::vector<RowBatch> row_batches(OMP_NUM_THREADS());
   OMP_INIT_EX();
 #pragma omp parallel for num_threads(OMP_NUM_THREADS()) schedule(static)
-  for (int i = 0; i < nrow; ++i) {
+  for (int block = 0; block < num_blocks; ++block) {
     OMP_LOOP_EX_BEGIN();
     // convert internal thread id to be unique based on external thread id
     const int internal_tid = omp_get_thread_num() + (max_omp_threads * tid);
-    auto one_row = get_row_fun(i);
-    p_dataset->PushOneRow(internal_tid, static_cast<data_size_t>(start_row + i), one_row);
+    RowBatch* row_batch = &row_batches[omp_get_thread_num()];
+    const int block_end = std::min(nrow, (block + 1) * kRowBatchSize);
+    for (int i = block * kRowBatchSize; i < block_end; ++i) {
+      p_dataset->AddOneRow(static_cast<data_size_t>(start_row + i), get_row_fun(i), row_batch);
+    }
+    p_dataset->PushRowBatch(internal_tid, row_batch);
     OMP_LOOP_EX_END();
   }
   OMP_THROW_EX();
@@ -1379,15 +1394,30 @@ int LGBM_DatasetCreateFromMats(int32_t nmat,
       ret->ResizeRaw(total_nrow);
     }
   }
+  // rows are transposed block by block, so that each column of a block is binned in one batch
+  const int num_push_cols = std::min(ncol, ret->num_total_features());
+  const int row_block_size = std::max(1, std::min(1024, (1 << 16) / std::max(ncol, 1)));
   int32_t start_row = 0;
   for (int j = 0; j < nmat; ++j) {
+    const int num_blocks = (nrow[j] + row_block_size - 1) / row_block_size;
     OMP_INIT_EX();
     #pragma omp parallel for num_threads(OMP_NUM_THREADS()) schedule(static)
-    for (int i = 0; i < nrow[j]; ++i) {
+    for (int block = 0; block < num_blocks; ++block) {
       OMP_LOOP_EX_BEGIN();
       const int tid = omp_get_thread_num();
-      auto one_row = get_row_fun[j](i);
-      ret->PushOneRow(tid, start_row + i, one_row);
+      const int block_start = block * row_block_size;
+      const int block_cnt = std::min(row_block_size, nrow[j] - block_start);
+      std::vector<double> block_cols(static_cast<size_t>(num_push_cols) * block_cnt);
+      for (int i = 0; i < block_cnt; ++i) {
+        auto one_row = get_row_fun[j](block_start + i);
+        for (int k = 0; k < num_push_cols; ++k) {
+          block_cols[static_cast<size_t>(k) * block_cnt + i] = one_row[k];
+        }
+      }
+      for (int k = 0; k < num_push_cols; ++k) {
+        ret->PushOneColumn(tid, start_row + block_start, k, block_cols.data() + static_cast<size_t>(k) * block_cnt,
+                           block_cnt);
+      }
       OMP_LOOP_EX_END();
     }
     OMP_THROW_EX();
@@ -1456,13 +1486,19 @@ int LGBM_DatasetCreateFromCSR(const void* indptr,
       ret->ResizeRaw(nrow);
     }
   }
+  // rows are collected in blocks, so that the values of each feature in a block are binned in one batch
+  const int num_blocks = (nrow + kRowBatchSize - 1) / kRowBatchSize;
+  std::vector<RowBatch> row_batches(OMP_NUM_THREADS());
   OMP_INIT_EX();
   #pragma omp parallel for num_threads(OMP_NUM_THREADS()) schedule(static)
-  for (int i = 0; i < static_cast<int>(nindptr - 1); ++i) {
+  for (int block = 0; block < num_blocks; ++block) {
     OMP_LOOP_EX_BEGIN();
     const int tid = omp_get_thread_num();
-    auto one_row = get_row_fun(i);
-    ret->PushOneRow(tid, i, one_row);
+    const int block_end = std::min(nrow, (block + 1) * kRowBatchSize);
+    for (int i = block * kRowBatchSize; i < block_end; ++i) {
+      ret->AddOneRow(i, get_row_fun(i), &row_batches[tid]);
+    }
+    ret->PushRowBatch(tid, &row_batches[tid]);
     OMP_LOOP_EX_END();
   }
   OMP_THROW_EX();
@@ -1526,16 +1562,20 @@ int LGBM_DatasetCreateFromCSRFunc(void* get_row_funptr,
     }
   }
 
+  const int num_blocks = (num_rows + kRowBatchSize - 1) / kRowBatchSize;
+  std::vector<RowBatch> row_batches(OMP_NUM_THREADS());
   OMP_INIT_EX();
   std::vector<std::pair<int, double>> thread_buffer;
   #pragma omp parallel for num_threads(OMP_NUM_THREADS()) schedule(static) private(thread_buffer)
-  for (int i = 0; i < num_rows; ++i) {
+  for (int block = 0; block < num_blocks; ++block) {
     OMP_LOOP_EX_BEGIN();
-    {
-      const int tid = omp_get_thread_num();
+    const int tid = omp_get_thread_num();
+    const int block_end = std::min(num_rows, (block + 1) * kRowBatchSize);
+    for (int i = block * kRowBatchSize; i < block_end; ++i) {
       get_row_fun(i, thread_buffer);
-      ret->PushOneRow(tid, i, thread_buffer);
+      ret->AddOneRow(i, thread_buffer, &row_batches[tid]);
     }
+    ret->PushRowBatch(tid, &row_batches[tid]);
     OMP_LOOP_EX_END();
   }
   OMP_THROW_EX();
@@ -1607,6 +1647,15 @@ int LGBM_DatasetCreateFromCSC(const void* col_ptr,
     int sub_feature = ret->Feture2SubFeature(feature_idx);
     CSC_RowIterator col_it(col_ptr, col_ptr_type, indices, data, data_type, ncol_ptr, nelem, i);
     auto bin_mapper = ret->FeatureBinMapper(feature_idx);
+    // values are collected into blocks and binned in batches
+    const int kBlockSize = 1024;
+    std::vector<data_size_t> block_rows(kBlockSize);
+    std::vector<double> block_values(kBlockSize);
+    int block_cnt = 0;
+    auto push_block = [&]() {
+      ret->PushOneData(tid, block_rows.data(), group, feature_idx, sub_feature, block_values.data(), block_cnt);
+      block_cnt = 0;
+    };
     if (bin_mapper->GetDefaultBin() == bin_mapper->GetMostFreqBin()) {
       int row_idx = 0;
       while (row_idx < nrow) {
@@ -1614,14 +1663,18 @@ int LGBM_DatasetCreateFromCSC(const void* col_ptr,
         row_idx = pair.first;
         // no more data
         if (row_idx < 0) { break; }
-        ret->PushOneData(tid, row_idx, group, feature_idx, sub_feature, pair.second);
+        block_rows[block_cnt] = row_idx;
+        block_values[block_cnt++] = pair.second;
+        if (block_cnt == kBlockSize) { push_block(); }
       }
     } else {
       for (int row_idx = 0; row_idx < nrow; ++row_idx) {
-        auto val = col_it.Get(row_idx);
-        ret->PushOneData(tid, row_idx, group, feature_idx, sub_feature, val);
+        block_rows[block_cnt] = row_idx;
+        block_values[block_cnt++] = col_it.Get(row_idx);
+        if (block_cnt == kBlockSize) { push_block(); }
       }
     }
+    push_block();
     OMP_LOOP_EX_END();
   }
   OMP_THROW_EX();
@@ -1702,16 +1755,31 @@ int LGBM_DatasetCreateFromArrow(int64_t n_chunks,
   }
 
   // After sampling and properly initializing all bins, we can add our data to the dataset. Here,
-  // we parallelize across rows.
-  OMP_INIT_EX();
-  #pragma omp parallel for num_threads(OMP_NUM_THREADS()) schedule(static)
+  // we parallelize across feature groups, so that each bin is filled by a single thread, and
+  // push the columns chunk by chunk.
+  std::vector<std::vector<int>> group_columns(ret->num_feature_groups());
   for (int64_t j = 0; j < table.get_num_columns(); ++j) {
+    const int feature_idx = ret->InnerFeatureIndex(static_cast<int>(j));
+    if (feature_idx >= 0) {
+      group_columns[ret->Feature2Group(feature_idx)].push_back(static_cast<int>(j));
+    }
+  }
+  OMP_INIT_EX();
+  #pragma omp parallel for num_threads(OMP_NUM_THREADS()) schedule(dynamic)
+  for (int group = 0; group < ret->num_feature_groups(); ++group) {
     OMP_LOOP_EX_BEGIN();
     const int tid = omp_get_thread_num();
-    data_size_t idx = 0;
-    auto column = table.get_column(j);
-    for (auto it = column.begin<double>(), end = column.end<double>(); it != end; ++it) {
-      ret->PushOneValue(tid, idx++, j, *it);
+    std::vector<double> values;
+    for (int j : group_columns[group]) {
+      const auto& column = table.get_column(j);
+      for (int64_t k = 0; k < column.get_num_chunks(); ++k) {
+        const int64_t chunk_start = column.get_chunk_offset(k);
+        const int64_t chunk_length = column.get_chunk_offset(k + 1) - chunk_start;
+        values.resize(chunk_length);
+        column.copy_chunk(k, values.data());
+        ret->PushOneColumn(tid, static_cast<data_size_t>(chunk_start), j, values.data(),
+                           static_cast<data_size_t>(chunk_length));
+      }
     }
     OMP_LOOP_EX_END();
   }
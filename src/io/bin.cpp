@@ -580,6 +580,56 @@ namespace LightGBM {
     }
   }
 
+  void BinMapper::ValueToBin(const double* values, int cnt, uint32_t* out) const {
+    if (bin_type_ == BinType::CategoricalBin) {
+      for (int i = 0; i < cnt; ++i) {
+        out[i] = ValueToBin(values[i]);
+      }
+      return;
+    }
+    const bool nan_as_bin = missing_type_ == MissingType::NaN;
+    const uint32_t nan_bin = static_cast<uint32_t>(num_bin_ - 1);
+    // the search range of ValueToBin, the last searched bin has no upper bound
+    const int num_bounds = nan_as_bin ? num_bin_ - 2 : num_bin_ - 1;
+    const double* bounds = bin_upper_bound_.data();
+    // lanes are searched in lockstep, so their loads overlap instead of waiting for each other
+    const int kNumLanes = 8;
+    double lane_values[kNumLanes];
+    const double* lane_bases[kNumLanes];
+    for (int start = 0; start < cnt; start += kNumLanes) {
+      const int num_lanes = std::min(kNumLanes, cnt - start);
+      for (int k = 0; k < num_lanes; ++k) {
+        const double value = values[start + k];
+        lane_values[k] = std::isnan(value) ? 0.0 : value;
+        lane_bases[k] = bounds;
+      }
+      if (num_bounds <= 0) {
+        for (int k = 0; k < num_lanes; ++k) {
+          out[start + k] = 0;
+        }
+      } else {
+        int n = num_bounds;
+        while (n > 1) {
+          const int half = n / 2;
+          for (int k = 0; k < num_lanes; ++k) {
+            lane_bases[k] = lane_bases[k][half] < lane_values[k] ? lane_bases[k] + half : lane_bases[k];
+          }
+          n -= half;
+        }
+        for (int k = 0; k < num_lanes; ++k) {
+          out[start + k] = static_cast<uint32_t>(lane_bases[k] - bounds) + (*lane_bases[k] < lane_values[k] ? 1 : 0);
+        }
+      }
+      if (nan_as_bin) {
+        for (int k = 0; k < num_lanes; ++k) {
+          if (std::isnan(values[start + k])) {
+            out[start + k] = nan_bin;
+          }
+        }
+      }
+    }
+  }
+
   size_t BinMapper::SizesInByte() const {
     size_t ret = VirtualFileWriter::AlignedSize(sizeof(num_bin_)) +
                  VirtualFileWriter::AlignedSize(sizeof(missing_type_)) +
@@ -597,10 +647,12 @@ namespace LightGBM {
     return ret;
   }
 
-  template class DenseBin<uint8_t, true>;
-  template class DenseBin<uint8_t, false>;
-  template class DenseBin<uint16_t, false>;
-  template class DenseBin<uint32_t, false>;
+  template class DenseBin<uint8_t, 1>;
+  template class DenseBin<uint8_t, 2>;
+  template class DenseBin<uint8_t, 4>;
+  template class DenseBin<uint8_t, 0>;
+  template class DenseBin<uint16_t, 0>;
+  template class DenseBin<uint32_t, 0>;
 
   template class SparseBin<uint8_t>;
   template class SparseBin<uint16_t>;
@@ -610,15 +662,51 @@ namespace LightGBM {
   template class MultiValDenseBin<uint16_t>;
   template class MultiValDenseBin<uint32_t>;
 
-  Bin* Bin::CreateDenseBin(data_size_t num_data, int num_bin) {
+  int Bin::DenseBinBits(int num_bin) {
+#if !defined(USE_GPU) && !defined(USE_CUDA)
+    // the GPU and CUDA tree learners read 4-bit bins at the smallest
+    if (num_bin <= 2) {
+      return 1;
+    } else if (num_bin <= 4) {
+      return 2;
+    }
+#endif  // !USE_GPU && !USE_CUDA
+    return LegacyDenseBinBits(num_bin);
+  }
+
+  int Bin::LegacyDenseBinBits(int num_bin) {
     if (num_bin <= 16) {
-      return new DenseBin<uint8_t, true>(num_data);
+      return 4;
     } else if (num_bin <= 256) {
-      return new DenseBin<uint8_t, false>(num_data);
+      return 8;
     } else if (num_bin <= 65536) {
-      return new DenseBin<uint16_t, false>(num_data);
+      return 16;
     } else {
-      return new DenseBin<uint32_t, false>(num_data);
+      return 32;
+    }
+  }
+
+  Bin* Bin::CreateDenseBin(data_size_t num_data, int num_bin) {
+    return CreateDenseBinOfBits(num_data, DenseBinBits(num_bin));
+  }
+
+  Bin* Bin::CreateDenseBinOfBits(data_size_t num_data, int bits) {
+    switch (bits) {
+      case 1:
+        return new DenseBin<uint8_t, 1>(num_data);
+      case 2:
+        return new DenseBin<uint8_t, 2>(num_data);
+      case 4:
+        return new DenseBin<uint8_t, 4>(num_data);
+      case 8:
+        return new DenseBin<uint8_t, 0>(num_data);
+      case 16:
+        return new DenseBin<uint16_t, 0>(num_data);
+      case 32:
+        return new DenseBin<uint32_t, 0>(num_data);
+      default:
+        Log::Fatal("Unknown number of bits per dense bin: %d", bits);
+        return nullptr;
     }
   }
 
@@ -706,7 +794,7 @@ namespace LightGBM {
   }
 
   template <>
-  const void* DenseBin<uint8_t, false>::GetColWiseData(
+  const void* DenseBin<uint8_t, 0>::GetColWiseData(
     uint8_t* bit_type,
     bool* is_sparse,
     std::vector<BinIterator*>* bin_iterator,
@@ -714,11 +802,11 @@ namespace LightGBM {
     *is_sparse = false;
     *bit_type = 8;
     bin_iterator->clear();
-    return reinterpret_cast<const void*>(data_.data());
+    return reinterpret_cast<const void*>(data_ptr_);
   }
 
   template <>
-  const void* DenseBin<uint16_t, false>::GetColWiseData(
+  const void* DenseBin<uint16_t, 0>::GetColWiseData(
     uint8_t* bit_type,
     bool* is_sparse,
     std::vector<BinIterator*>* bin_iterator,
@@ -726,11 +814,11 @@ namespace LightGBM {
     *is_sparse = false;
     *bit_type = 16;
     bin_iterator->clear();
-    return reinterpret_cast<const void*>(data_.data());
+    return reinterpret_cast<const void*>(data_ptr_);
   }
 
   template <>
-  const void* DenseBin<uint32_t, false>::GetColWiseData(
+  const void* DenseBin<uint32_t, 0>::GetColWiseData(
     uint8_t* bit_type,
     bool* is_sparse,
     std::vector<BinIterator*>* bin_iterator,
@@ -738,11 +826,11 @@ namespace LightGBM {
     *is_sparse = false;
     *bit_type = 32;
     bin_iterator->clear();
-    return reinterpret_cast<const void*>(data_.data());
+    return reinterpret_cast<const void*>(data_ptr_);
   }
 
   template <>
-  const void* DenseBin<uint8_t, true>::GetColWiseData(
+  const void* DenseBin<uint8_t, 4>::GetColWiseData(
     uint8_t* bit_type,
     bool* is_sparse,
     std::vector<BinIterator*>* bin_iterator,
@@ -750,51 +838,97 @@ namespace LightGBM {
     *is_sparse = false;
     *bit_type = 4;
     bin_iterator->clear();
-    return reinterpret_cast<const void*>(data_.data());
+    return reinterpret_cast<const void*>(data_ptr_);
   }
 
   template <>
-  const void* DenseBin<uint8_t, false>::GetColWiseData(
+  const void* DenseBin<uint8_t, 1>::GetColWiseData(
+    uint8_t* bit_type,
+    bool* is_sparse,
+    std::vector<BinIterator*>* bin_iterator,
+    const int /*num_threads*/) const {
+    *is_sparse = false;
+    *bit_type = 1;
+    bin_iterator->clear();
+    return reinterpret_cast<const void*>(data_ptr_);
+  }
+
+  template <>
+  const void* DenseBin<uint8_t, 2>::GetColWiseData(
+    uint8_t* bit_type,
+    bool* is_sparse,
+    std::vector<BinIterator*>* bin_iterator,
+    const int /*num_threads*/) const {
+    *is_sparse = false;
+    *bit_type = 2;
+    bin_iterator->clear();
+    return reinterpret_cast<const void*>(data_ptr_);
+  }
+
+  template <>
+  const void* DenseBin<uint8_t, 0>::GetColWiseData(
     uint8_t* bit_type,
     bool* is_sparse,
     BinIterator** bin_iterator) const {
     *is_sparse = false;
     *bit_type = 8;
     *bin_iterator = nullptr;
-    return reinterpret_cast<const void*>(data_.data());
+    return reinterpret_cast<const void*>(data_ptr_);
   }
 
   template <>
-  const void* DenseBin<uint16_t, false>::GetColWiseData(
+  const void* DenseBin<uint16_t, 0>::GetColWiseData(
     uint8_t* bit_type,
     bool* is_sparse,
     BinIterator** bin_iterator) const {
     *is_sparse = false;
     *bit_type = 16;
     *bin_iterator = nullptr;
-    return reinterpret_cast<const void*>(data_.data());
+    return reinterpret_cast<const void*>(data_ptr_);
   }
 
   template <>
-  const void* DenseBin<uint32_t, false>::GetColWiseData(
+  const void* DenseBin<uint32_t, 0>::GetColWiseData(
     uint8_t* bit_type,
     bool* is_sparse,
     BinIterator** bin_iterator) const {
     *is_sparse = false;
     *bit_type = 32;
     *bin_iterator = nullptr;
-    return reinterpret_cast<const void*>(data_.data());
+    return reinterpret_cast<const void*>(data_ptr_);
   }
 
   template <>
-  const void* DenseBin<uint8_t, true>::GetColWiseData(
+  const void* DenseBin<uint8_t, 4>::GetColWiseData(
     uint8_t* bit_type,
     bool* is_sparse,
     BinIterator** bin_iterator) const {
     *is_sparse = false;
     *bit_type = 4;
     *bin_iterator = nullptr;
-    return reinterpret_cast<const void*>(data_.data());
+    return reinterpret_cast<const void*>(data_ptr_);
+  }
+
+  template <>
+  const void* DenseBin<uint8_t, 1>::GetColWiseData(
+    uint8_t* bit_type,
+    bool* is_sparse,
+    BinIterator** bin_iterator) const {
+    *is_sparse = false;
+    *bit_type = 1;
+    *bin_iterator = nullptr;
+    return reinterpret_cast<const void*>(data_ptr_);
+  }
+
+  template <>
+  const void* DenseBin<uint8_t, 2>::GetColWiseData(
+    uint8_t* bit_type,
+    bool* is_sparse,
+    BinIterator** bin_iterator) const {
+    *is_sparse = false;
+    *bit_type = 2;
+    *bin_iterator = nullptr;
+    return reinterpret_cast<const void*>(data_ptr_);
   }
 
   template <>
@@ -415,6 +415,14 @@ void Config::CheckParamConflict(const std::unordered_map<std::string, std::strin
       Log::Warning("Although \"deterministic\" is set, the results ran by GPU may be non-deterministic.");
     }
   }
+  if (out_of_core && !force_col_wise) {
+    // row-wise histograms would copy all bins into memory
+    if (force_row_wise) {
+      Log::Warning("Out-of-core training only works with col-wise histograms, set force_row_wise=false.");
+    }
+    force_col_wise = true;
+    force_row_wise = false;
+  }
   // linear tree learner must be serial type and run on CPU device
   if (linear_tree) {
     if (device_type != std::string("cpu")) {
@@ -199,6 +199,7 @@ const std::unordered_set<std::string>& Config::parameter_set() {
   "deterministic",
   "force_col_wise",
   "force_row_wise",
+  "row_wise_cache_size",
   "histogram_pool_size",
   "max_depth",
   "min_data_in_leaf",
@@ -269,6 +270,8 @@ const std::unordered_set<std::string>& Config::parameter_set() {
   "feature_pre_filter",
   "pre_partition",
   "two_round",
+  "file_read_block_size",
+  "file_read_num_buffers",
   "header",
   "label_column",
   "weight_column",
@@ -277,6 +280,9 @@ const std::unordered_set<std::string>& Config::parameter_set() {
   "categorical_feature",
   "forcedbins_filename",
   "save_binary",
+  "save_binary_num_shards",
+  "out_of_core",
+  "out_of_core_cache_size",
   "precise_float_parser",
   "parser_config_file",
   "start_iteration_predict",
@@ -351,6 +357,8 @@ void Config::GetMembersFromString(const std::unordered_map<std::string, std::str
 
   GetBool(params, "force_row_wise", &force_row_wise);
 
+  GetDouble(params, "row_wise_cache_size", &row_wise_cache_size);
+
   GetDouble(params, "histogram_pool_size", &histogram_pool_size);
 
   GetInt(params, "max_depth", &max_depth);
@@ -541,6 +549,12 @@ void Config::GetMembersFromString(const std::unordered_map<std::string, std::str
 
   GetBool(params, "two_round", &two_round);
 
+  GetInt(params, "file_read_block_size", &file_read_block_size);
+  CHECK_GT(file_read_block_size, 0);
+
+  GetInt(params, "file_read_num_buffers", &file_read_num_buffers);
+  CHECK_GE(file_read_num_buffers, 2);
+
   GetBool(params, "header", &header);
 
   GetString(params, "label_column", &label_column);
@@ -557,6 +571,13 @@ void Config::GetMembersFromString(const std::unordered_map<std::string, std::str
 
   GetBool(params, "save_binary", &save_binary);
 
+  GetInt(params, "save_binary_num_shards", &save_binary_num_shards);
+  CHECK_GT(save_binary_num_shards, 0);
+
+  GetBool(params, "out_of_core", &out_of_core);
+
+  GetDouble(params, "out_of_core_cache_size", &out_of_core_cache_size);
+
   GetBool(params, "precise_float_parser", &precise_float_parser);
 
   GetString(params, "parser_config_file", &parser_config_file);
@@ -679,6 +700,7 @@ std::string Config::SaveMembersToString() const {
   str_buf << "[deterministic: " << deterministic << "]\n";
   str_buf << "[force_col_wise: " << force_col_wise << "]\n";
   str_buf << "[force_row_wise: " << force_row_wise << "]\n";
+  str_buf << "[row_wise_cache_size: " << row_wise_cache_size << "]\n";
   str_buf << "[histogram_pool_size: " << histogram_pool_size << "]\n";
   str_buf << "[max_depth: " << max_depth << "]\n";
   str_buf << "[min_data_in_leaf: " << min_data_in_leaf << "]\n";
@@ -746,6 +768,8 @@ std::string Config::SaveMembersToString() const {
   str_buf << "[feature_pre_filter: " << feature_pre_filter << "]\n";
   str_buf << "[pre_partition: " << pre_partition << "]\n";
   str_buf << "[two_round: " << two_round << "]\n";
+  str_buf << "[file_read_block_size: " << file_read_block_size << "]\n";
+  str_buf << "[file_read_num_buffers: " << file_read_num_buffers << "]\n";
   str_buf << "[header: " << header << "]\n";
   str_buf << "[label_column: " << label_column << "]\n";
   str_buf << "[weight_column: " << weight_column << "]\n";
@@ -804,6 +828,7 @@ const std::unordered_map<std::string, std::vector<std::string>>& Config::paramet
     {"deterministic", {}},
     {"force_col_wise", {}},
     {"force_row_wise", {}},
+    {"row_wise_cache_size", {}},
     {"histogram_pool_size", {"hist_pool_size"}},
     {"max_depth", {}},
     {"min_data_in_leaf", {"min_data_per_leaf", "min_data", "min_child_samples", "min_samples_leaf"}},
@@ -874,6 +899,8 @@ const std::unordered_map<std::string, std::vector<std::string>>& Config::paramet
     {"feature_pre_filter", {}},
     {"pre_partition", {"is_pre_partition"}},
     {"two_round", {"two_round_loading", "use_two_round_loading"}},
+    {"file_read_block_size", {}},
+    {"file_read_num_buffers", {}},
     {"header", {"has_header"}},
     {"label_column", {"label"}},
     {"weight_column", {"weight"}},
@@ -882,6 +909,9 @@ const std::unordered_map<std::string, std::vector<std::string>>& Config::paramet
     {"categorical_feature", {"cat_feature", "categorical_column", "cat_column", "categorical_features"}},
     {"forcedbins_filename", {}},
     {"save_binary", {"is_save_binary", "is_save_binary_file"}},
+    {"save_binary_num_shards", {}},
+    {"out_of_core", {}},
+    {"out_of_core_cache_size", {}},
     {"precise_float_parser", {}},
     {"parser_config_file", {}},
     {"start_iteration_predict", {}},
@@ -948,6 +978,7 @@ const std::unordered_map<std::string, std::string>& Config::ParameterTypes() {
     {"deterministic", "bool"},
     {"force_col_wise", "bool"},
     {"force_row_wise", "bool"},
+    {"row_wise_cache_size", "double"},
     {"histogram_pool_size", "double"},
     {"max_depth", "int"},
     {"min_data_in_leaf", "int"},
@@ -1018,6 +1049,8 @@ const std::unordered_map<std::string, std::string>& Config::ParameterTypes() {
     {"feature_pre_filter", "bool"},
     {"pre_partition", "bool"},
     {"two_round", "bool"},
+    {"file_read_block_size", "int"},
+    {"file_read_num_buffers", "int"},
     {"header", "bool"},
     {"label_column", "string"},
     {"weight_column", "string"},
@@ -1026,6 +1059,9 @@ const std::unordered_map<std::string, std::string>& Config::ParameterTypes() {
     {"categorical_feature", "vector<int>"},
     {"forcedbins_filename", "string"},
     {"save_binary", "bool"},
+    {"save_binary_num_shards", "int"},
+    {"out_of_core", "bool"},
+    {"out_of_core_cache_size", "double"},
     {"precise_float_parser", "bool"},
     {"parser_config_file", "string"},
     {"start_iteration_predict", "int"},
@@ -14,15 +14,26 @@
 #include <chrono>
 #include <cstdio>
 #include <limits>
+#include <random>
 #include <sstream>
+#include <type_traits>
 #include <unordered_map>
 
+#include "dense_bin.hpp"
+
 namespace LightGBM {
 
 const int Dataset::kSerializedReferenceVersionLength = 2;
 const char* Dataset::serialized_reference_version = "v1";
 
 const char* Dataset::binary_file_token =
+    "______LightGBM_Binary_File_Token_v2___\n";
+const char* Dataset::binary_shards_file_token =
+    "______LightGBM_Binary_Shards_Token_v2_\n";
+const char* Dataset::binary_shard_token =
+    "______LightGBM_Binary_Shard_Token_v2__\n";
+const int Dataset::kNumBinaryShardHeaderFields = 5;
+const char* Dataset::legacy_binary_file_token =
     "______LightGBM_Binary_File_Token______\n";
 const char* Dataset::binary_serialized_reference_token =
     "______LightGBM_Binary_Serialized_Token______\n";
@@ -613,7 +624,7 @@ TrainingShareStates* Dataset::GetShareStates(
     score_t* gradients, score_t* hessians,
     const std::vector<int8_t>& is_feature_used, bool is_constant_hessian,
     bool force_col_wise, bool force_row_wise,
-    const int num_grad_quant_bins) const {
+    const int num_grad_quant_bins, double row_wise_cache_size) const {
   Common::FunctionTimer fun_timer("Dataset::TestMultiThreadingMethod",
                                   global_timer);
   if (force_col_wise && force_row_wise) {
@@ -697,6 +708,66 @@ TrainingShareStates* Dataset::GetShareStates(
                         hist_data.data());
     row_wise_time = std::chrono::steady_clock::now() - start_time;
 
+    if (row_wise_cache_size != 0.0 &&
+        (row_wise_cache_size < 0.0 ||
+         row_wise_state->MultiValBinSize(num_data_) <= row_wise_cache_size * 1024 * 1024)) {
+      // time both again, and on every kCostSampleStep-th data, to fit a fixed cost and a cost per data of each
+      const data_size_t kCostSampleStep = 16;
+      std::vector<data_size_t> sample_indices;
+      for (data_size_t i = 0; i < num_data_; i += kCostSampleStep) {
+        sample_indices.push_back(i);
+      }
+      const data_size_t num_sample = static_cast<data_size_t>(sample_indices.size());
+      std::vector<score_t> ordered_gradients(num_sample), ordered_hessians(num_sample);
+      auto time_state = [&] (TrainingShareStates* state, const data_size_t* data_indices, data_size_t num_data,
+                             int num_repeat) {
+        std::chrono::duration<double, std::milli> best_time = std::chrono::duration<double, std::milli>::max();
+        for (int i = 0; i < num_repeat; ++i) {
+          auto repeat_start_time = std::chrono::steady_clock::now();
+          ConstructHistograms<USE_QUANT_GRAD, HIST_BITS>(is_feature_used, data_indices, num_data, gradients,
+                              hessians, ordered_gradients.data(), ordered_hessians.data(), state,
+                              hist_data.data());
+          best_time = std::min<std::chrono::duration<double, std::milli>>(
+            best_time, std::chrono::steady_clock::now() - repeat_start_time);
+        }
+        return best_time.count();
+      };
+      const double col_wise_full_cost = std::min(col_wise_time.count(),
+                                                 time_state(col_wise_state.get(), nullptr, num_data_, 1));
+      const double row_wise_full_cost = std::min(row_wise_time.count(),
+                                                 time_state(row_wise_state.get(), nullptr, num_data_, 1));
+      const double col_wise_sample_cost = time_state(col_wise_state.get(), sample_indices.data(), num_sample, 3);
+      const double row_wise_sample_cost = time_state(row_wise_state.get(), sample_indices.data(), num_sample, 3);
+      const data_size_t num_rest = std::max<data_size_t>(num_data_ - num_sample, 1);
+      double col_wise_cost_per_row = std::max(col_wise_full_cost - col_wise_sample_cost, 0.0) / num_rest;
+      const double col_wise_fixed_cost = std::max(col_wise_sample_cost - col_wise_cost_per_row * num_sample, 0.0);
+      const double row_wise_cost_per_row = std::max(row_wise_full_cost - row_wise_sample_cost, 0.0) / num_rest;
+      const double row_wise_fixed_cost = std::max(row_wise_sample_cost - row_wise_cost_per_row * num_sample, 0.0);
+      // col-wise cost scales with the used feature groups, row-wise always builds all of them
+      int num_used_group = 0;
+      for (int group = 0; group < num_groups_; ++group) {
+        for (int j = 0; j < group_feature_cnt_[group]; ++j) {
+          if (is_feature_used[group_feature_start_[group] + j]) {
+            ++num_used_group;
+            break;
+          }
+        }
+      }
+      col_wise_cost_per_row *= static_cast<double>(num_groups_) / std::max(num_used_group, 1);
+      Log::Info(
+          "Choosing between row-wise and col-wise multi-threading for each leaf, "
+          "the overhead of testing was %f seconds.",
+          (col_wise_init_time.count() + row_wise_init_time.count() + col_wise_time.count() +
+           row_wise_time.count() + col_wise_full_cost + row_wise_full_cost +
+           3 * (col_wise_sample_cost + row_wise_sample_cost)) * 1e-3);
+      Log::Debug(
+          "col-wise cost %f + %g * #data ms, row-wise cost %f + %g * #data ms",
+          col_wise_fixed_cost, col_wise_cost_per_row, row_wise_fixed_cost, row_wise_cost_per_row);
+      col_wise_state->SetRowWiseState(row_wise_state.release(), col_wise_fixed_cost, col_wise_cost_per_row,
+                                      row_wise_fixed_cost, row_wise_cost_per_row);
+      return col_wise_state.release();
+    }
+
     if (col_wise_time < row_wise_time) {
       auto overhead_cost = row_wise_init_time + row_wise_time + col_wise_time;
       Log::Info(
@@ -727,19 +798,19 @@ template TrainingShareStates* Dataset::GetShareStates<false, 0>(
     score_t* gradients, score_t* hessians,
     const std::vector<int8_t>& is_feature_used, bool is_constant_hessian,
     bool force_col_wise, bool force_row_wise,
-    const int num_grad_quant_bins) const;
+    const int num_grad_quant_bins, double row_wise_cache_size) const;
 
 template TrainingShareStates* Dataset::GetShareStates<true, 16>(
     score_t* gradients, score_t* hessians,
     const std::vector<int8_t>& is_feature_used, bool is_constant_hessian,
     bool force_col_wise, bool force_row_wise,
-    const int num_grad_quant_bins) const;
+    const int num_grad_quant_bins, double row_wise_cache_size) const;
 
 template TrainingShareStates* Dataset::GetShareStates<true, 32>(
     score_t* gradients, score_t* hessians,
     const std::vector<int8_t>& is_feature_used, bool is_constant_hessian,
     bool force_col_wise, bool force_row_wise,
-    const int num_grad_quant_bins) const;
+    const int num_grad_quant_bins, double row_wise_cache_size) const;
 
 void Dataset::CopyFeatureMapperFrom(const Dataset* dataset) {
   feature_groups_.clear();
@@ -1015,7 +1086,7 @@ bool Dataset::GetIntField(const char* field_name, data_size_t* out_len,
   return true;
 }
 
-void Dataset::SaveBinaryFile(const char* bin_filename) {
+void Dataset::SaveBinaryFile(const char* bin_filename, int num_shards) {
   if (bin_filename != nullptr && std::string(bin_filename) == data_filename_) {
     Log::Warning("Binary file %s already exists", bin_filename);
     return;
@@ -1038,9 +1109,12 @@ void Dataset::SaveBinaryFile(const char* bin_filename) {
     if (!writer->Init()) {
       Log::Fatal("Cannot write binary data to %s ", bin_filename);
     }
+    num_shards = std::max(1, std::min(num_shards, num_groups_));
+    const bool is_sharded = num_shards > 1;
     Log::Info("Saving data to binary file %s", bin_filename);
-    size_t size_of_token = std::strlen(binary_file_token);
-    writer->AlignedWrite(binary_file_token, size_of_token);
+    const char* token = is_sharded ? binary_shards_file_token : binary_file_token;
+    size_t size_of_token = std::strlen(token);
+    writer->AlignedWrite(token, size_of_token);
 
     // Write the basic header information for the dataset
     SerializeHeader(writer.get());
@@ -1052,12 +1126,57 @@ void Dataset::SaveBinaryFile(const char* bin_filename) {
     metadata_.SaveBinaryToFile(writer.get());
 
     // write feature data
-    for (int i = 0; i < num_groups_; ++i) {
-      // get size of feature
-      size_t size_of_feature = feature_groups_[i]->SizesInByte();
-      writer->Write(&size_of_feature, sizeof(size_of_feature));
-      // write feature
-      feature_groups_[i]->SerializeToBinary(writer.get());
+    if (!is_sharded) {
+      SaveFeatureGroupsToBinary(writer.get(), 0, num_groups_);
+    } else {
+      // split feature groups into contiguous shards of similar sizes
+      std::vector<size_t> group_sizes(num_groups_);
+      size_t total_size = 0;
+      for (int i = 0; i < num_groups_; ++i) {
+        group_sizes[i] = feature_groups_[i]->SizesInByte();
+        total_size += group_sizes[i];
+      }
+      std::vector<size_t> shard_group_begin(num_shards + 1, 0);
+      size_t cur_size = 0;
+      int cur_shard = 1;
+      for (int i = 0; i < num_groups_ && cur_shard < num_shards; ++i) {
+        cur_size += group_sizes[i];
+        // leave at least one group for each of the remaining shards
+        if ((cur_size * num_shards >= total_size * cur_shard && num_groups_ - i - 1 >= num_shards - cur_shard)
+            || num_groups_ - i - 1 == num_shards - cur_shard) {
+          shard_group_begin[cur_shard++] = i + 1;
+        }
+      }
+      shard_group_begin[num_shards] = num_groups_;
+      // random id of this set of shards, so shards left over from another save are not mixed in
+      std::random_device rd;
+      const size_t shard_set_id = (static_cast<size_t>(rd()) << 16) ^ rd();
+      size_t size_of_shards = static_cast<size_t>(num_shards);
+      writer->Write(&size_of_shards, sizeof(size_of_shards));
+      writer->Write(shard_group_begin.data(), sizeof(size_t) * shard_group_begin.size());
+      writer->Write(&shard_set_id, sizeof(shard_set_id));
+      OMP_INIT_EX();
+      #pragma omp parallel for num_threads(OMP_NUM_THREADS()) schedule(dynamic)
+      for (int i = 0; i < num_shards; ++i) {
+        OMP_LOOP_EX_BEGIN();
+        const std::string shard_filename = BinaryShardFilename(bin_filename, i);
+        auto shard_writer = VirtualFileWriter::Make(shard_filename);
+        if (!shard_writer->Init()) {
+          Log::Fatal("Cannot write binary data to %s ", shard_filename.c_str());
+        }
+        shard_writer->AlignedWrite(binary_shard_token, std::strlen(binary_shard_token));
+        const size_t shard_header[kNumBinaryShardHeaderFields] = {shard_set_id, size_of_shards, static_cast<size_t>(i),
+                                                                  shard_group_begin[i], shard_group_begin[i + 1]};
+        shard_writer->Write(shard_header, sizeof(shard_header));
+        SaveFeatureGroupsToBinary(shard_writer.get(), static_cast<int>(shard_group_begin[i]),
+                                  static_cast<int>(shard_group_begin[i + 1]));
+        if (!shard_writer->Close()) {
+          Log::Fatal("Cannot write binary data to %s ", shard_filename.c_str());
+        }
+        OMP_LOOP_EX_END();
+      }
+      OMP_THROW_EX();
+      Log::Info("Saved feature groups to %d shards %s", num_shards, BinaryShardFilename(bin_filename, -1).c_str());
     }
 
     // write raw data; use row-major order so we can read row-by-row
@@ -1071,7 +1190,112 @@ void Dataset::SaveBinaryFile(const char* bin_filename) {
         }
       }
     }
+    if (!writer->Close()) {
+      Log::Fatal("Cannot write binary data to %s ", bin_filename);
+    }
+  }
+}
+
+void Dataset::SaveFeatureGroupsToBinary(BinaryWriter* writer, int group_begin, int group_end) const {
+  for (int i = group_begin; i < group_end; ++i) {
+    // get size of feature
+    size_t size_of_feature = feature_groups_[i]->SizesInByte();
+    writer->Write(&size_of_feature, sizeof(size_of_feature));
+    // write feature
+    feature_groups_[i]->SerializeToBinary(writer);
+  }
+}
+
+std::string Dataset::BinaryShardFilename(const std::string& bin_filename, int shard_idx) {
+  std::stringstream str_buf;
+  str_buf << bin_filename << ".shard_";
+  if (shard_idx >= 0) {
+    str_buf << shard_idx;
+  } else {
+    str_buf << "*";
+  }
+  return str_buf.str();
+}
+
+BinPageCache::BinPageCache(int num_groups, double capacity)
+    : groups_(num_groups), capacity_(capacity) {}
+
+int BinPageCache::AddFile(std::unique_ptr<MappedFile> file) {
+  files_.push_back(std::move(file));
+  return static_cast<int>(files_.size()) - 1;
+}
+
+void BinPageCache::AddGroup(int group, int file_idx, size_t offset, size_t size) {
+  groups_[group].file_idx = file_idx;
+  groups_[group].offset = offset;
+  groups_[group].size = size;
+}
+
+void BinPageCache::Prefetch(const std::vector<int>& groups) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++num_prefetch_;
+  int num_paged_in = 0;
+  size_t paged_in_bytes = 0;
+  for (int group : groups) {
+    auto& range = groups_[group];
+    if (range.file_idx < 0) {
+      continue;
+    }
+    range.last_use = num_prefetch_;
+    if (range.is_resident) {
+      lru_.splice(lru_.begin(), lru_, range.lru_pos);
+      continue;
+    }
+    // the kernel reads the group while the histograms of the previous groups are constructed
+    files_[range.file_idx]->WillNeed(range.offset, range.size);
+    range.is_resident = true;
+    lru_.push_front(group);
+    range.lru_pos = lru_.begin();
+    resident_bytes_ += range.size;
+    paged_in_bytes += range.size;
+    ++num_paged_in;
+  }
+  paged_in_bytes_ += paged_in_bytes;
+  if (capacity_ < 0) {
+    return;
+  }
+  int num_released = 0;
+  size_t released_bytes = 0;
+  // never release the groups that are about to be used
+  while (static_cast<double>(resident_bytes_) > capacity_ && !lru_.empty()
+         && groups_[lru_.back()].last_use != num_prefetch_) {
+    auto& range = groups_[lru_.back()];
+    files_[range.file_idx]->DontNeed(range.offset, range.size);
+    range.is_resident = false;
+    lru_.pop_back();
+    resident_bytes_ -= range.size;
+    released_bytes += range.size;
+    ++num_released;
+  }
+  released_bytes_ += released_bytes;
+  if (num_paged_in > 0 || num_released > 0) {
+    Log::Debug("Paged in %d feature groups (%.1f MB), released %d feature groups (%.1f MB)",
+               num_paged_in, paged_in_bytes / 1024.0 / 1024.0,
+               num_released, released_bytes / 1024.0 / 1024.0);
+  }
+}
+
+void Dataset::PrefetchFeatureGroups(const std::vector<int8_t>& is_feature_used) const {
+  if (bin_page_cache_ == nullptr) {
+    return;
+  }
+  std::vector<int> used_groups;
+  for (int group = 0; group < num_groups_; ++group) {
+    const int f_start = group_feature_start_[group];
+    const int f_cnt = group_feature_cnt_[group];
+    for (int j = 0; j < f_cnt; ++j) {
+      if (is_feature_used.empty() || is_feature_used[f_start + j]) {
+        used_groups.push_back(group);
+        break;
+      }
+    }
   }
+  bin_page_cache_->Prefetch(used_groups);
 }
 
 void Dataset::SerializeReference(ByteBuffer* buffer) {
@@ -1291,23 +1515,75 @@ void Dataset::ConstructHistogramsInner(
     }
   }
   int num_used_dense_group = static_cast<int>(used_dense_group.size());
+  TrainingShareStates* row_wise_state = share_state->row_wise_state();
+  if (row_wise_state != nullptr &&
+      share_state->UseRowWise(num_data, static_cast<double>(num_used_dense_group + (multi_val_groud_id >= 0 ? 1 : 0)) /
+                                        num_groups_)) {
+    hist_t* row_wise_hist_data = share_state->row_wise_hist_buf();
+    ConstructHistogramsMultiVal<USE_INDICES, false, USE_QUANT_GRAD, HIST_BITS>(
+        data_indices, num_data, gradients, hessians, row_wise_state,
+        row_wise_hist_data != nullptr ? row_wise_hist_data : hist_data);
+    if (row_wise_hist_data != nullptr) {
+      share_state->MoveRowWiseHist<USE_QUANT_GRAD, HIST_BITS>(hist_data);
+    }
+    return;
+  }
+  // with enough dense groups of at most 8-bit bins to keep all threads busy, they are processed kNumFusedGroups
+  // at a time, ordered by bin width: the tasks before fused_task_end[i] have (1 << i)-bit bins
+  std::vector<int> fused_dense_group;
+  int fused_task_end[4] = {0, 0, 0, 0};
+  if (num_used_dense_group >= kNumFusedGroups * share_state->num_threads) {
+    std::vector<int> dense_group_by_bits[4];
+    std::vector<int> other_dense_group;
+    for (int group : used_dense_group) {
+      uint8_t bit_type = 0;
+      bool is_sparse = false;
+      BinIterator* bin_iterator = nullptr;
+      if (!feature_groups_[group]->is_sparse_) {
+        feature_groups_[group]->bin_data_->GetColWiseData(&bit_type, &is_sparse, &bin_iterator);
+      }
+      if (!is_sparse && (bit_type == 1 || bit_type == 2 || bit_type == 4 || bit_type == 8)) {
+        dense_group_by_bits[bit_type == 1 ? 0 : (bit_type == 2 ? 1 : (bit_type == 4 ? 2 : 3))].push_back(group);
+      } else {
+        other_dense_group.push_back(group);
+      }
+    }
+    for (int i = 0; i < 4; ++i) {
+      const std::vector<int>& groups = dense_group_by_bits[i];
+      const size_t num_fused = groups.size() / kNumFusedGroups * kNumFusedGroups;
+      fused_dense_group.insert(fused_dense_group.end(), groups.begin(), groups.begin() + num_fused);
+      other_dense_group.insert(other_dense_group.end(), groups.begin() + num_fused, groups.end());
+      fused_task_end[i] = static_cast<int>(fused_dense_group.size()) / kNumFusedGroups;
+    }
+    used_dense_group = std::move(other_dense_group);
+  }
+  const int num_fused_tasks = fused_task_end[3];
+  const int num_tasks = num_fused_tasks + static_cast<int>(used_dense_group.size());
   global_timer.Start("Dataset::dense_bin_histogram");
   auto ptr_ordered_grad = gradients;
   auto ptr_ordered_hess = hessians;
+  const bool is_ordered = USE_INDICES && share_state->ordered_indices != nullptr &&
+                          data_indices >= share_state->ordered_indices &&
+                          data_indices + num_data <= share_state->ordered_indices + share_state->ordered_indices_cnt;
   if (num_used_dense_group > 0) {
     if (USE_QUANT_GRAD) {
       int16_t* ordered_gradients_and_hessians = reinterpret_cast<int16_t*>(ordered_gradients);
       const int16_t* gradients_and_hessians = reinterpret_cast<const int16_t*>(gradients);
-      if (USE_INDICES) {
+      if (USE_INDICES && !is_ordered) {
   #pragma omp parallel for num_threads(OMP_NUM_THREADS()) schedule(static, 512) if (num_data >= 1024)
         for (data_size_t i = 0; i < num_data; ++i) {
           ordered_gradients_and_hessians[i] = gradients_and_hessians[data_indices[i]];
         }
+      }
+      if (USE_INDICES) {
         ptr_ordered_grad = reinterpret_cast<const score_t*>(ordered_gradients);
         ptr_ordered_hess = nullptr;
       }
     } else {
-      if (USE_INDICES) {
+      if (USE_INDICES && is_ordered) {
+        ptr_ordered_grad = ordered_gradients;
+        ptr_ordered_hess = USE_HESSIAN ? ordered_hessians : hessians;
+      } else if (USE_INDICES) {
         if (USE_HESSIAN) {
   #pragma omp parallel for num_threads(OMP_NUM_THREADS()) schedule(static, 512) if (num_data >= 1024)
           for (data_size_t i = 0; i < num_data; ++i) {
@@ -1327,9 +1603,27 @@ void Dataset::ConstructHistogramsInner(
     }
     OMP_INIT_EX();
 #pragma omp parallel for schedule(static) num_threads(share_state->num_threads)
-    for (int gi = 0; gi < num_used_dense_group; ++gi) {
+    for (int gi = 0; gi < num_tasks; ++gi) {
       OMP_LOOP_EX_BEGIN();
-      int group = used_dense_group[gi];
+      if (gi < num_fused_tasks) {
+        const double constant_hessian = (USE_HESSIAN || USE_QUANT_GRAD) ? 0.0 : hessians[0];
+        const int* groups = fused_dense_group.data() + gi * kNumFusedGroups;
+        if (gi < fused_task_end[0]) {
+          ConstructHistogramsFusedDense<USE_INDICES, USE_HESSIAN, USE_QUANT_GRAD, HIST_BITS, 1>(
+              groups, data_indices, num_data, ptr_ordered_grad, ptr_ordered_hess, constant_hessian, hist_data);
+        } else if (gi < fused_task_end[1]) {
+          ConstructHistogramsFusedDense<USE_INDICES, USE_HESSIAN, USE_QUANT_GRAD, HIST_BITS, 2>(
+              groups, data_indices, num_data, ptr_ordered_grad, ptr_ordered_hess, constant_hessian, hist_data);
+        } else if (gi < fused_task_end[2]) {
+          ConstructHistogramsFusedDense<USE_INDICES, USE_HESSIAN, USE_QUANT_GRAD, HIST_BITS, 4>(
+              groups, data_indices, num_data, ptr_ordered_grad, ptr_ordered_hess, constant_hessian, hist_data);
+        } else {
+          ConstructHistogramsFusedDense<USE_INDICES, USE_HESSIAN, USE_QUANT_GRAD, HIST_BITS, 8>(
+              groups, data_indices, num_data, ptr_ordered_grad, ptr_ordered_hess, constant_hessian, hist_data);
+        }
+        continue;
+      }
+      int group = used_dense_group[gi - num_fused_tasks];
       const int num_bin = feature_groups_[group]->num_total_bin_;
       if (USE_QUANT_GRAD) {
         if (HIST_BITS == 16) {
@@ -1453,6 +1747,154 @@ void Dataset::ConstructHistogramsInner(
   }
 }
 
+template <bool USE_INDICES, bool USE_HESSIAN, bool USE_QUANT_GRAD, int HIST_BITS, int BITS>
+void Dataset::ConstructHistogramsFusedDense(const int* groups,
+                                            const data_size_t* data_indices,
+                                            data_size_t num_data,
+                                            const score_t* ordered_gradients,
+                                            const score_t* ordered_hessians,
+                                            double constant_hessian,
+                                            hist_t* hist_data) const {
+  typedef typename std::conditional<HIST_BITS == 16, int32_t, int64_t>::type PACKED_HIST_T;
+  // bin idx is in byte idx >> kLogValuesPerByte
+  const int kLogValuesPerByte = BITS == 1 ? 3 : (BITS == 2 ? 2 : (BITS == 4 ? 1 : 0));
+  const data_size_t kPosMask = (1 << kLogValuesPerByte) - 1;
+  const uint32_t kBinMask = (1u << BITS) - 1;
+  const uint8_t* data[kNumFusedGroups];
+  hist_t* out[kNumFusedGroups];
+  PACKED_HIST_T* int_out[kNumFusedGroups];
+  for (int k = 0; k < kNumFusedGroups; ++k) {
+    const int group = groups[k];
+    uint8_t bit_type = 0;
+    bool is_sparse = false;
+    BinIterator* bin_iterator = nullptr;
+    data[k] = reinterpret_cast<const uint8_t*>(
+        feature_groups_[group]->bin_data_->GetColWiseData(&bit_type, &is_sparse, &bin_iterator));
+    CHECK_EQ(bit_type, BITS);
+    const int num_bin = feature_groups_[group]->num_total_bin_;
+    if (USE_QUANT_GRAD) {
+      out[k] = nullptr;
+      if (HIST_BITS == 16) {
+        int_out[k] = reinterpret_cast<PACKED_HIST_T*>(reinterpret_cast<int32_t*>(hist_data) + group_bin_boundaries_[group]);
+        std::memset(reinterpret_cast<void*>(int_out[k]), 0, num_bin * kInt16HistEntrySize);
+      } else {
+        int_out[k] = reinterpret_cast<PACKED_HIST_T*>(hist_data + group_bin_boundaries_[group]);
+        std::memset(reinterpret_cast<void*>(int_out[k]), 0, num_bin * kInt32HistEntrySize);
+      }
+    } else {
+      int_out[k] = nullptr;
+      out[k] = hist_data + group_bin_boundaries_[group] * 2;
+      std::memset(reinterpret_cast<void*>(out[k]), 0, num_bin * kHistEntrySize);
+    }
+  }
+  const int16_t* int_gradients = reinterpret_cast<const int16_t*>(ordered_gradients);
+  const data_size_t pf_offset = 64;
+  // the float sums are added in the same order as DenseBin::ConstructHistogram of each group,
+  // so the histograms are bit-identical to the ones constructed per group
+  typedef DenseBin<uint8_t, BITS == 8 ? 0 : BITS> DENSE_BIN_T;
+  if (!USE_QUANT_GRAD && DENSE_BIN_T::UseSubHistograms(0, num_data)) {
+    const int kNumSub = DENSE_BIN_T::kNumSubHistograms;
+    const int kNumBin = 1 << BITS;
+    hist_t sub_grad[kNumFusedGroups][kNumSub][kNumBin];
+    hist_t sub_hess[kNumFusedGroups][USE_HESSIAN ? kNumSub : 1][USE_HESSIAN ? kNumBin : 1];
+    std::memset(sub_grad, 0, sizeof(sub_grad));
+    std::memset(sub_hess, 0, sizeof(sub_hess));
+    auto add_row = [&](data_size_t i, int sub) {
+      const data_size_t idx = USE_INDICES ? data_indices[i] : i;
+      const score_t gradient = ordered_gradients[i];
+      const score_t hessian = USE_HESSIAN ? ordered_hessians[i] : 0.0f;
+      for (int k = 0; k < kNumFusedGroups; ++k) {
+        const uint32_t bin = (data[k][idx >> kLogValuesPerByte] >> ((idx & kPosMask) * BITS)) & kBinMask;
+        sub_grad[k][sub][bin] += gradient;
+        if (USE_HESSIAN) {
+          sub_hess[k][sub][bin] += hessian;
+        } else {
+          ++reinterpret_cast<hist_cnt_t*>(out[k])[(bin << 1) + 1];
+        }
+      }
+    };
+    data_size_t i = 0;
+    for (; i + kNumSub <= num_data; i += kNumSub) {
+      if (USE_INDICES && i + kNumSub + pf_offset <= num_data) {
+        for (int sub = 0; sub < kNumSub; ++sub) {
+          const data_size_t pf_idx = data_indices[i + pf_offset + sub];
+          for (int k = 0; k < kNumFusedGroups; ++k) {
+            PREFETCH_T0(data[k] + (pf_idx >> kLogValuesPerByte));
+          }
+        }
+      }
+      for (int sub = 0; sub < kNumSub; ++sub) {
+        add_row(i + sub, sub);
+      }
+    }
+    for (; i < num_data; ++i) {
+      add_row(i, 0);
+    }
+    for (int k = 0; k < kNumFusedGroups; ++k) {
+      const int num_bin = feature_groups_[groups[k]]->num_total_bin_;
+      for (int bin = 0; bin < num_bin; ++bin) {
+        hist_t sum_grad = sub_grad[k][0][bin];
+        for (int sub = 1; sub < kNumSub; ++sub) {
+          sum_grad += sub_grad[k][sub][bin];
+        }
+        if (USE_HESSIAN) {
+          hist_t sum_hess = sub_hess[k][0][bin];
+          for (int sub = 1; sub < kNumSub; ++sub) {
+            sum_hess += sub_hess[k][sub][bin];
+          }
+          if (sum_grad != 0 || sum_hess != 0) {
+            out[k][bin << 1] += sum_grad;
+            out[k][(bin << 1) + 1] += sum_hess;
+          }
+        } else if (reinterpret_cast<const hist_cnt_t*>(out[k])[(bin << 1) + 1] != 0) {
+          out[k][bin << 1] += sum_grad;
+        }
+      }
+    }
+  } else {
+    const data_size_t pf_end = USE_INDICES ? num_data - pf_offset : 0;
+    for (data_size_t i = 0; i < num_data; ++i) {
+      const data_size_t idx = USE_INDICES ? data_indices[i] : i;
+      if (USE_INDICES && i < pf_end) {
+        const data_size_t pf_idx = data_indices[i + pf_offset];
+        for (int k = 0; k < kNumFusedGroups; ++k) {
+          PREFETCH_T0(data[k] + (pf_idx >> kLogValuesPerByte));
+        }
+      }
+      if (USE_QUANT_GRAD) {
+        const int16_t gradient_16 = int_gradients[i];
+        const PACKED_HIST_T packed_grad = static_cast<PACKED_HIST_T>(static_cast<int8_t>(gradient_16 >> 8)) << HIST_BITS;
+        const PACKED_HIST_T gradient_packed = USE_HESSIAN ? (packed_grad | (gradient_16 & 0xff)) : (packed_grad | 1);
+        for (int k = 0; k < kNumFusedGroups; ++k) {
+          const uint32_t bin = (data[k][idx >> kLogValuesPerByte] >> ((idx & kPosMask) * BITS)) & kBinMask;
+          int_out[k][bin] += gradient_packed;
+        }
+      } else {
+        const score_t gradient = ordered_gradients[i];
+        const score_t hessian = USE_HESSIAN ? ordered_hessians[i] : 0.0f;
+        for (int k = 0; k < kNumFusedGroups; ++k) {
+          const uint32_t ti = ((data[k][idx >> kLogValuesPerByte] >> ((idx & kPosMask) * BITS)) & kBinMask) << 1;
+          out[k][ti] += gradient;
+          if (USE_HESSIAN) {
+            out[k][ti + 1] += hessian;
+          } else {
+            ++reinterpret_cast<hist_cnt_t*>(out[k])[ti + 1];
+          }
+        }
+      }
+    }
+  }
+  if (!USE_QUANT_GRAD && !USE_HESSIAN) {
+    for (int k = 0; k < kNumFusedGroups; ++k) {
+      const int num_bin = feature_groups_[groups[k]]->num_total_bin_;
+      auto cnt_dst = reinterpret_cast<hist_cnt_t*>(out[k] + 1);
+      for (int i = 0; i < num_bin * 2; i += 2) {
+        out[k][i + 1] = static_cast<double>(cnt_dst[i]) * constant_hessian;
+      }
+    }
+  }
+}
+
 // explicitly initialize template methods, for cross module call
 #define CONSTRUCT_HISTOGRAMS_INNER_PARMA \
   const std::vector<int8_t>& is_feature_used, const data_size_t* data_indices, \
@@ -11,6 +11,7 @@
 #include <LightGBM/utils/openmp_wrapper.h>
 
 #include <chrono>
+#include <cstring>
 #include <fstream>
 
 namespace LightGBM {
@@ -45,8 +46,9 @@ void DatasetLoader::SetHeader(const char* filename) {
     } else if (!config_.parser_config_file.empty()) {
       // support to get header from parser config, so could utilize following label name to id mapping logic.
       TextReader<data_size_t> parser_config_reader(config_.parser_config_file.c_str(), false);
-      parser_config_reader.ReadAllLines();
-      std::string parser_config_str = parser_config_reader.JoinedLines();
+      std::vector<std::string> parser_config_lines;
+      parser_config_reader.ReadAllLines(&parser_config_lines);
+      std::string parser_config_str = Common::Join(parser_config_lines, "\n");
       if (!parser_config_str.empty()) {
         std::string header_in_parser_config = Common::GetFromParserConfig(parser_config_str, "header");
         if (!header_in_parser_config.empty()) {
@@ -414,6 +416,30 @@ Dataset* DatasetLoader::LoadFromSerializedReference(const char* binary_data, siz
   return dataset.release();
 }
 
+/*!
+* \brief Map a local binary dataset file for out-of-core training
+* \param filename Filename of the binary file
+* \param token Expected token at the beginning of the file, nullptr to skip the check
+* \param page_cache Page cache that owns the mapped file
+* \return Index of the file in page_cache, -1 if the file cannot be mapped
+*/
+int MapBinaryFile(const std::string& filename, const char* token, BinPageCache* page_cache) {
+  auto file = MappedFile::Make(filename);
+  if (file == nullptr) {
+    Log::Warning("Could not map %s, it is loaded into memory", filename.c_str());
+    return -1;
+  }
+  if (token != nullptr) {
+    const size_t size_of_token = std::strlen(token);
+    if (file->size() < size_of_token || std::memcmp(file->data(), token, size_of_token) != 0) {
+      // compressed binary files can only be read front to back
+      Log::Warning("Could not map compressed binary file %s, it is loaded into memory", filename.c_str());
+      return -1;
+    }
+  }
+  return page_cache->AddFile(std::move(file));
+}
+
 Dataset* DatasetLoader::LoadFromBinFile(const char* data_filename, const char* bin_filename,
                                         int rank, int num_machines, int* num_global_data,
                                         std::vector<data_size_t>* used_data_indices) {
@@ -436,7 +462,11 @@ Dataset* DatasetLoader::LoadFromBinFile(const char* data_filename, const char* b
   if (read_cnt < sizeof(char) * size_of_token) {
     Log::Fatal("Binary file error: token has the wrong size");
   }
-  if (std::string(buffer.data()) != std::string(Dataset::binary_file_token)) {
+  const std::string token(buffer.data());
+  // files saved before the number of bits per dense bin was recorded, their dense bins are repacked
+  const bool is_legacy_layout = token == Dataset::legacy_binary_file_token;
+  const bool is_sharded = token == Dataset::binary_shards_file_token;
+  if (!is_sharded && !is_legacy_layout && token != Dataset::binary_file_token) {
     Log::Fatal("Input file is not LightGBM binary file");
   }
 
@@ -525,31 +555,103 @@ Dataset* DatasetLoader::LoadFromBinFile(const char* data_filename, const char* b
     dataset->num_data_ = static_cast<data_size_t>((*used_data_indices).size());
   }
   dataset->metadata_.PartitionLabel(*used_data_indices);
+  const bool out_of_core = config_.out_of_core && used_data_indices->empty() && !dataset->has_raw();
+  if (config_.out_of_core && !out_of_core) {
+    Log::Warning("Out-of-core training does not support partitioned data or linear trees, %s is loaded into memory",
+                 bin_filename);
+  }
+  if (out_of_core) {
+    dataset->bin_page_cache_.reset(new BinPageCache(dataset->num_groups_,
+                                                    config_.out_of_core_cache_size * 1024 * 1024));
+  }
   // read feature data
-  for (int i = 0; i < dataset->num_groups_; ++i) {
-    // read feature size
+  dataset->feature_groups_.resize(dataset->num_groups_);
+  if (!is_sharded) {
+    const int file_idx = out_of_core ? MapBinaryFile(bin_filename, token.c_str(),
+                                                     dataset->bin_page_cache_.get()) : -1;
+    if (file_idx >= 0) {
+      const size_t offset = VirtualFileWriter::AlignedSize(sizeof(char) * size_of_token)
+                            + sizeof(size_t) + size_of_head + sizeof(size_t) + size_of_metadata;
+      LoadFeatureGroupsFromMappedFile(dataset->bin_page_cache_.get(), file_idx, offset, 0, dataset->num_groups_,
+                                      *num_global_data, is_legacy_layout, &dataset->feature_groups_);
+    } else {
+      LoadFeatureGroupsFromBinary(reader.get(), 0, dataset->num_groups_, *num_global_data,
+                                  *used_data_indices, is_legacy_layout, &buffer, &dataset->feature_groups_);
+    }
+  } else {
     read_cnt = reader->Read(buffer.data(), sizeof(size_t));
     if (read_cnt != sizeof(size_t)) {
-      Log::Fatal("Binary file error: feature %d has the wrong size", i);
+      Log::Fatal("Binary file error: number of shards has the wrong size");
     }
-    size_t size_of_feature = *(reinterpret_cast<size_t*>(buffer.data()));
-    // re-allocate space if not enough
-    if (size_of_feature > buffer_size) {
-      buffer_size = size_of_feature;
-      buffer.resize(buffer_size);
+    const int num_shards = static_cast<int>(*(reinterpret_cast<size_t*>(buffer.data())));
+    std::vector<size_t> shard_group_begin(num_shards + 1);
+    read_cnt = reader->Read(shard_group_begin.data(), sizeof(size_t) * shard_group_begin.size());
+    if (read_cnt != sizeof(size_t) * shard_group_begin.size() || shard_group_begin[0] != 0
+        || shard_group_begin[num_shards] != static_cast<size_t>(dataset->num_groups_)) {
+      Log::Fatal("Binary file error: shards of feature groups are incorrect");
     }
-
-    read_cnt = reader->Read(buffer.data(), size_of_feature);
-
-    if (read_cnt != size_of_feature) {
-      Log::Fatal("Binary file error: feature %d is incorrect, read count: %zu", i, read_cnt);
+    size_t shard_set_id = 0;
+    if (reader->Read(&shard_set_id, sizeof(shard_set_id)) != sizeof(shard_set_id)) {
+      Log::Fatal("Binary file error: id of shards has the wrong size");
     }
-    dataset->feature_groups_.emplace_back(std::unique_ptr<FeatureGroup>(
-      new FeatureGroup(buffer.data(),
-                       *num_global_data,
-                       *used_data_indices, i)));
+    const size_t size_of_shard_header = VirtualFileWriter::AlignedSize(std::strlen(Dataset::binary_shard_token))
+                                        + sizeof(size_t) * Dataset::kNumBinaryShardHeaderFields;
+    Log::Info("Load feature groups from %d shards %s", num_shards,
+              Dataset::BinaryShardFilename(bin_filename, -1).c_str());
+    // open and check all shards before loading any of them
+    std::vector<int> shard_file_idx(num_shards, -1);
+    std::vector<std::unique_ptr<VirtualFileReader>> shard_readers(num_shards);
+    for (int i = 0; i < num_shards; ++i) {
+      const std::string shard_filename = Dataset::BinaryShardFilename(bin_filename, i);
+      if (out_of_core) {
+        shard_file_idx[i] = MapBinaryFile(shard_filename, Dataset::binary_shard_token, dataset->bin_page_cache_.get());
+      }
+      if (shard_file_idx[i] >= 0) {
+        const MappedFile* file = dataset->bin_page_cache_->file(shard_file_idx[i]);
+        CheckBinaryShardHeader(shard_filename, file->data(), std::min(file->size(), size_of_shard_header),
+                               shard_set_id, num_shards, i, shard_group_begin[i], shard_group_begin[i + 1]);
+      } else {
+        shard_readers[i] = VirtualFileReader::Make(shard_filename);
+        if (!shard_readers[i]->Init()) {
+          Log::Fatal("Could not read binary data from %s", shard_filename.c_str());
+        }
+        std::vector<char> header(size_of_shard_header);
+        CheckBinaryShardHeader(shard_filename, header.data(), shard_readers[i]->Read(header.data(), header.size()),
+                               shard_set_id, num_shards, i, shard_group_begin[i], shard_group_begin[i + 1]);
+      }
+    }
+    OMP_INIT_EX();
+    #pragma omp parallel for num_threads(OMP_NUM_THREADS()) schedule(dynamic)
+    for (int i = 0; i < num_shards; ++i) {
+      OMP_LOOP_EX_BEGIN();
+      if (shard_file_idx[i] >= 0) {
+        LoadFeatureGroupsFromMappedFile(dataset->bin_page_cache_.get(), shard_file_idx[i], size_of_shard_header,
+                                        static_cast<int>(shard_group_begin[i]),
+                                        static_cast<int>(shard_group_begin[i + 1]), *num_global_data, false,
+                                        &dataset->feature_groups_);
+      } else {
+        std::vector<char> shard_buffer;
+        LoadFeatureGroupsFromBinary(shard_readers[i].get(), static_cast<int>(shard_group_begin[i]),
+                                    static_cast<int>(shard_group_begin[i + 1]), *num_global_data,
+                                    *used_data_indices, false, &shard_buffer, &dataset->feature_groups_);
+        shard_readers[i].reset(nullptr);
+      }
+      OMP_LOOP_EX_END();
+    }
+    OMP_THROW_EX();
   }
   dataset->feature_groups_.shrink_to_fit();
+  if (out_of_core) {
+    int num_mapped_groups = 0;
+    for (const auto& group : dataset->feature_groups_) {
+      num_mapped_groups += group->is_mapped() ? 1 : 0;
+    }
+    Log::Info("Out-of-core training: %d of %d feature groups are paged from %s", num_mapped_groups,
+              dataset->num_groups_, bin_filename);
+    if (num_mapped_groups == 0) {
+      dataset->bin_page_cache_.reset(nullptr);
+    }
+  }
 
   // raw data
   dataset->numeric_feature_map_ = std::vector<int>(dataset->num_features_, false);
@@ -590,6 +692,78 @@ Dataset* DatasetLoader::LoadFromBinFile(const char* data_filename, const char* b
   return dataset.release();
 }
 
+void DatasetLoader::CheckBinaryShardHeader(const std::string& filename, const char* header, size_t size,
+                                           size_t shard_set_id, int num_shards, int shard_idx,
+                                           size_t group_begin, size_t group_end) {
+  const size_t size_of_token = std::strlen(Dataset::binary_shard_token);
+  const size_t size_of_token_in_file = VirtualFileWriter::AlignedSize(size_of_token);
+  if (size < size_of_token_in_file + sizeof(size_t) * Dataset::kNumBinaryShardHeaderFields
+      || std::memcmp(header, Dataset::binary_shard_token, size_of_token) != 0) {
+    Log::Fatal("Binary file error: %s is not a shard of a LightGBM binary file", filename.c_str());
+  }
+  std::vector<size_t> fields(Dataset::kNumBinaryShardHeaderFields);
+  std::memcpy(fields.data(), header + size_of_token_in_file, sizeof(size_t) * fields.size());
+  if (fields[0] != shard_set_id || fields[1] != static_cast<size_t>(num_shards)) {
+    Log::Fatal("Binary file error: %s belongs to another set of shards, the binary file and all its shards "
+               "must come from the same save", filename.c_str());
+  }
+  if (fields[2] != static_cast<size_t>(shard_idx) || fields[3] != group_begin || fields[4] != group_end) {
+    Log::Fatal("Binary file error: %s holds other feature groups than the binary file expects", filename.c_str());
+  }
+}
+
+void DatasetLoader::LoadFeatureGroupsFromMappedFile(BinPageCache* page_cache, int file_idx, size_t offset,
+                                                    int group_begin, int group_end, data_size_t num_global_data,
+                                                    bool is_legacy_layout,
+                                                    std::vector<std::unique_ptr<FeatureGroup>>* out_groups) {
+  const MappedFile* file = page_cache->file(file_idx);
+  const std::vector<data_size_t> all_data_indices;
+  for (int i = group_begin; i < group_end; ++i) {
+    size_t size_of_feature = 0;
+    if (file->size() < sizeof(size_t) || offset > file->size() - sizeof(size_t)) {
+      Log::Fatal("Binary file error: feature %d has the wrong size", i);
+    }
+    std::memcpy(&size_of_feature, file->data() + offset, sizeof(size_t));
+    offset += sizeof(size_t);
+    if (size_of_feature > file->size() - offset) {
+      Log::Fatal("Binary file error: feature %d is incorrect", i);
+    }
+    (*out_groups)[i].reset(new FeatureGroup(file->data() + offset, num_global_data, all_data_indices, i, true,
+                                            is_legacy_layout));
+    if ((*out_groups)[i]->is_mapped()) {
+      page_cache->AddGroup(i, file_idx, offset, size_of_feature);
+    }
+    offset += size_of_feature;
+  }
+}
+
+void DatasetLoader::LoadFeatureGroupsFromBinary(const VirtualFileReader* reader, int group_begin, int group_end,
+                                                data_size_t num_global_data,
+                                                const std::vector<data_size_t>& used_data_indices,
+                                                bool is_legacy_layout, std::vector<char>* buffer,
+                                                std::vector<std::unique_ptr<FeatureGroup>>* out_groups) {
+  for (int i = group_begin; i < group_end; ++i) {
+    // read feature size
+    size_t size_of_feature = 0;
+    size_t read_cnt = reader->Read(&size_of_feature, sizeof(size_t));
+    if (read_cnt != sizeof(size_t)) {
+      Log::Fatal("Binary file error: feature %d has the wrong size", i);
+    }
+    // re-allocate space if not enough
+    if (size_of_feature > buffer->size()) {
+      buffer->resize(size_of_feature);
+    }
+
+    read_cnt = reader->Read(buffer->data(), size_of_feature);
+
+    if (read_cnt != size_of_feature) {
+      Log::Fatal("Binary file error: feature %d is incorrect, read count: %zu", i, read_cnt);
+    }
+    (*out_groups)[i].reset(new FeatureGroup(buffer->data(), num_global_data, used_data_indices, i, false,
+                                            is_legacy_layout));
+  }
+}
+
 Dataset* DatasetLoader::ConstructFromSampleData(double** sample_values,
                                                 int** sample_indices,
                                                 int num_col,
@@ -957,14 +1131,17 @@ void DatasetLoader::CheckDataset(const Dataset* dataset, bool is_load_from_binar
   }
 }
 
-std::vector<std::string> DatasetLoader::LoadTextDataToMemory(const char* filename, const Metadata& metadata,
-                                                             int rank, int num_machines, int* num_global_data,
-                                                             std::vector<data_size_t>* used_data_indices) {
-  TextReader<data_size_t> text_reader(filename, config_.header, config_.file_load_progress_interval_bytes);
+TextLineBuffer DatasetLoader::LoadTextDataToMemory(const char* filename, const Metadata& metadata,
+                                                   int rank, int num_machines, int* num_global_data,
+                                                   std::vector<data_size_t>* used_data_indices) {
+  TextReader<data_size_t> text_reader(filename, config_.header, config_.file_load_progress_interval_bytes,
+                                      static_cast<size_t>(config_.file_read_block_size) * 1024 * 1024,
+                                      config_.file_read_num_buffers);
+  TextLineBuffer text_data;
   used_data_indices->clear();
   if (num_machines == 1 || config_.pre_partition) {
     // read all lines
-    *num_global_data = text_reader.ReadAllLines();
+    *num_global_data = text_reader.ReadAllLines(&text_data);
   } else {  // need partition data
             // get query data
     const data_size_t* query_boundaries = metadata.query_boundaries();
@@ -977,7 +1154,7 @@ std::vector<std::string> DatasetLoader::LoadTextDataToMemory(const char* filenam
         } else {
           return false;
         }
-      }, used_data_indices);
+      }, used_data_indices, &text_data);
     } else {
       // if contain query data, minimal sample unit is one query
       data_size_t num_queries = metadata.num_queries();
@@ -999,13 +1176,13 @@ std::vector<std::string> DatasetLoader::LoadTextDataToMemory(const char* filenam
           ++qid;
         }
         return is_query_used;
-      }, used_data_indices);
+      }, used_data_indices, &text_data);
     }
   }
-  return std::move(text_reader.Lines());
+  return text_data;
 }
 
-std::vector<std::string> DatasetLoader::SampleTextDataFromMemory(const std::vector<std::string>& data) {
+std::vector<std::string> DatasetLoader::SampleTextDataFromMemory(const TextLineBuffer& data) {
   int sample_cnt = config_.bin_construct_sample_cnt;
   if (static_cast<size_t>(sample_cnt) > data.size()) {
     sample_cnt = static_cast<int>(data.size());
@@ -1014,7 +1191,7 @@ std::vector<std::string> DatasetLoader::SampleTextDataFromMemory(const std::vect
   std::vector<std::string> out(sample_indices.size());
   for (size_t i = 0; i < sample_indices.size(); ++i) {
     const size_t idx = sample_indices[i];
-    out[i] = data[idx];
+    out[i] = data[idx].ToString();
   }
   return out;
 }
@@ -1023,7 +1200,9 @@ std::vector<std::string> DatasetLoader::SampleTextDataFromFile(const char* filen
                                                                int rank, int num_machines, int* num_global_data,
                                                                std::vector<data_size_t>* used_data_indices) {
   const data_size_t sample_cnt = static_cast<data_size_t>(config_.bin_construct_sample_cnt);
-  TextReader<data_size_t> text_reader(filename, config_.header, config_.file_load_progress_interval_bytes);
+  TextReader<data_size_t> text_reader(filename, config_.header, config_.file_load_progress_interval_bytes,
+                                      static_cast<size_t>(config_.file_read_block_size) * 1024 * 1024,
+                                      config_.file_read_num_buffers);
   std::vector<std::string> out_data;
   if (num_machines == 1 || config_.pre_partition) {
     *num_global_data = static_cast<data_size_t>(text_reader.SampleFromFile(&random_, sample_cnt, &out_data));
@@ -1260,58 +1439,62 @@ void DatasetLoader::ConstructBinMappersFromTextData(int rank, int num_machines,
 }
 
 /*! \brief Extract local features from memory */
-void DatasetLoader::ExtractFeaturesFromMemory(std::vector<std::string>* text_data, const Parser* parser, Dataset* dataset) {
+// number of text lines parsed before their values are binned feature by feature
+const data_size_t kRowBatchSize = 1024;
+
+void DatasetLoader::ExtractFeaturesFromMemory(TextLineBuffer* text_data, const Parser* parser, Dataset* dataset) {
   std::vector<std::pair<int, double>> oneline_features;
   double tmp_label = 0.0f;
   auto& ref_text_data = *text_data;
   std::vector<float> feature_row(dataset->num_features_);
+  // rows are collected in blocks, so that the values of each feature in a block are binned in one batch
+  const data_size_t num_blocks = (dataset->num_data_ + kRowBatchSize - 1) / kRowBatchSize;
+  std::vector<RowBatch> row_batches(OMP_NUM_THREADS());
   if (!predict_fun_) {
     OMP_INIT_EX();
     // if doesn't need to prediction with initial model
     #pragma omp parallel for num_threads(OMP_NUM_THREADS()) schedule(static) private(oneline_features) firstprivate(tmp_label, feature_row)
-    for (data_size_t i = 0; i < dataset->num_data_; ++i) {
+    for (data_size_t block = 0; block < num_blocks; ++block) {
       OMP_LOOP_EX_BEGIN();
       const int tid = omp_get_thread_num();
-      oneline_features.clear();
-      // parser
-      parser->ParseOneLine(ref_text_data[i].c_str(), &oneline_features, &tmp_label);
-      // set label
-      dataset->metadata_.SetLabelAt(i, static_cast<label_t>(tmp_label));
-      // free processed line:
-      ref_text_data[i].clear();
-      // shrink_to_fit will be very slow in linux, and seems not free memory, disable for now
-      // text_reader_->Lines()[i].shrink_to_fit();
-      std::vector<bool> is_feature_added(dataset->num_features_, false);
-      // push data
-      for (auto& inner_data : oneline_features) {
-        if (inner_data.first >= dataset->num_total_features_) { continue; }
-        int feature_idx = dataset->used_feature_map_[inner_data.first];
-        if (feature_idx >= 0) {
-          is_feature_added[feature_idx] = true;
-          // if is used feature
-          int group = dataset->feature2group_[feature_idx];
-          int sub_feature = dataset->feature2subfeature_[feature_idx];
-          dataset->feature_groups_[group]->PushData(tid, sub_feature, i, inner_data.second);
-          if (dataset->has_raw()) {
-            feature_row[feature_idx] = static_cast<float>(inner_data.second);
-          }
-        } else {
-          if (inner_data.first == weight_idx_) {
-            dataset->metadata_.SetWeightAt(i, static_cast<label_t>(inner_data.second));
-          } else if (inner_data.first == group_idx_) {
-            dataset->metadata_.SetQueryAt(i, static_cast<data_size_t>(inner_data.second));
+      const data_size_t block_end = std::min(dataset->num_data_, (block + 1) * kRowBatchSize);
+      for (data_size_t i = block * kRowBatchSize; i < block_end; ++i) {
+        oneline_features.clear();
+        // parser
+        parser->ParseOneLine(ref_text_data[i].c_str(), &oneline_features, &tmp_label);
+        // set label
+        dataset->metadata_.SetLabelAt(i, static_cast<label_t>(tmp_label));
+        std::vector<bool> is_feature_added(dataset->num_features_, false);
+        // push data
+        for (auto& inner_data : oneline_features) {
+          if (inner_data.first >= dataset->num_total_features_) { continue; }
+          int feature_idx = dataset->used_feature_map_[inner_data.first];
+          if (feature_idx >= 0) {
+            is_feature_added[feature_idx] = true;
+            // if is used feature
+            row_batches[tid].Add(feature_idx, i, inner_data.second);
+            if (dataset->has_raw()) {
+              feature_row[feature_idx] = static_cast<float>(inner_data.second);
+            }
+          } else {
+            if (inner_data.first == weight_idx_) {
+              dataset->metadata_.SetWeightAt(i, static_cast<label_t>(inner_data.second));
+            } else if (inner_data.first == group_idx_) {
+              dataset->metadata_.SetQueryAt(i, static_cast<data_size_t>(inner_data.second));
+            }
           }
         }
-      }
-      if (dataset->has_raw()) {
-        for (size_t j = 0; j < feature_row.size(); ++j) {
-          int feat_ind = dataset->numeric_feature_map_[j];
-          if (feat_ind >= 0) {
-            dataset->raw_data_[feat_ind][i] = feature_row[j];
+        if (dataset->has_raw()) {
+          for (size_t j = 0; j < feature_row.size(); ++j) {
+            int feat_ind = dataset->numeric_feature_map_[j];
+            if (feat_ind >= 0) {
+              dataset->raw_data_[feat_ind][i] = feature_row[j];
+            }
           }
         }
+        dataset->AddZerosOfRow(i, is_feature_added, &row_batches[tid]);
       }
-      dataset->FinishOneRow(tid, i, is_feature_added);
+      dataset->PushRowBatch(tid, &row_batches[tid]);
       OMP_LOOP_EX_END();
     }
     OMP_THROW_EX();
@@ -1320,55 +1503,53 @@ void DatasetLoader::ExtractFeaturesFromMemory(std::vector<std::string>* text_dat
     // if need to prediction with initial model
     std::vector<double> init_score(static_cast<size_t>(dataset->num_data_) * num_class_);
     #pragma omp parallel for num_threads(OMP_NUM_THREADS()) schedule(static) private(oneline_features) firstprivate(tmp_label, feature_row)
-    for (data_size_t i = 0; i < dataset->num_data_; ++i) {
+    for (data_size_t block = 0; block < num_blocks; ++block) {
       OMP_LOOP_EX_BEGIN();
       const int tid = omp_get_thread_num();
-      oneline_features.clear();
-      // parser
-      parser->ParseOneLine(ref_text_data[i].c_str(), &oneline_features, &tmp_label);
-      // set initial score
-      std::vector<double> oneline_init_score(num_class_);
-      predict_fun_(oneline_features, oneline_init_score.data());
-      for (int k = 0; k < num_class_; ++k) {
-        init_score[k * dataset->num_data_ + i] = static_cast<double>(oneline_init_score[k]);
-      }
-      // set label
-      dataset->metadata_.SetLabelAt(i, static_cast<label_t>(tmp_label));
-      // free processed line:
-      ref_text_data[i].clear();
-      // shrink_to_fit will be very slow in Linux, and seems not free memory, disable for now
-      // text_reader_->Lines()[i].shrink_to_fit();
-      // push data
-      std::vector<bool> is_feature_added(dataset->num_features_, false);
-      for (auto& inner_data : oneline_features) {
-        if (inner_data.first >= dataset->num_total_features_) { continue; }
-        int feature_idx = dataset->used_feature_map_[inner_data.first];
-        if (feature_idx >= 0) {
-          is_feature_added[feature_idx] = true;
-          // if is used feature
-          int group = dataset->feature2group_[feature_idx];
-          int sub_feature = dataset->feature2subfeature_[feature_idx];
-          dataset->feature_groups_[group]->PushData(tid, sub_feature, i, inner_data.second);
-          if (dataset->has_raw()) {
-            feature_row[feature_idx] = static_cast<float>(inner_data.second);
-          }
-        } else {
-          if (inner_data.first == weight_idx_) {
-            dataset->metadata_.SetWeightAt(i, static_cast<label_t>(inner_data.second));
-          } else if (inner_data.first == group_idx_) {
-            dataset->metadata_.SetQueryAt(i, static_cast<data_size_t>(inner_data.second));
+      const data_size_t block_end = std::min(dataset->num_data_, (block + 1) * kRowBatchSize);
+      for (data_size_t i = block * kRowBatchSize; i < block_end; ++i) {
+        oneline_features.clear();
+        // parser
+        parser->ParseOneLine(ref_text_data[i].c_str(), &oneline_features, &tmp_label);
+        // set initial score
+        std::vector<double> oneline_init_score(num_class_);
+        predict_fun_(oneline_features, oneline_init_score.data());
+        for (int k = 0; k < num_class_; ++k) {
+          init_score[k * dataset->num_data_ + i] = static_cast<double>(oneline_init_score[k]);
+        }
+        // set label
+        dataset->metadata_.SetLabelAt(i, static_cast<label_t>(tmp_label));
+        // push data
+        std::vector<bool> is_feature_added(dataset->num_features_, false);
+        for (auto& inner_data : oneline_features) {
+          if (inner_data.first >= dataset->num_total_features_) { continue; }
+          int feature_idx = dataset->used_feature_map_[inner_data.first];
+          if (feature_idx >= 0) {
+            is_feature_added[feature_idx] = true;
+            // if is used feature
+            row_batches[tid].Add(feature_idx, i, inner_data.second);
+            if (dataset->has_raw()) {
+              feature_row[feature_idx] = static_cast<float>(inner_data.second);
+            }
+          } else {
+            if (inner_data.first == weight_idx_) {
+              dataset->metadata_.SetWeightAt(i, static_cast<label_t>(inner_data.second));
+            } else if (inner_data.first == group_idx_) {
+              dataset->metadata_.SetQueryAt(i, static_cast<data_size_t>(inner_data.second));
+            }
           }
         }
-      }
-      dataset->FinishOneRow(tid, i, is_feature_added);
-      if (dataset->has_raw()) {
-        for (size_t j = 0; j < feature_row.size(); ++j) {
-          int feat_ind = dataset->numeric_feature_map_[j];
-          if (feat_ind >= 0) {
-            dataset->raw_data_[feat_ind][i] = feature_row[j];
+        dataset->AddZerosOfRow(i, is_feature_added, &row_batches[tid]);
+        if (dataset->has_raw()) {
+          for (size_t j = 0; j < feature_row.size(); ++j) {
+            int feat_ind = dataset->numeric_feature_map_[j];
+            if (feat_ind >= 0) {
+              dataset->raw_data_[feat_ind][i] = feature_row[j];
+            }
           }
         }
       }
+      dataset->PushRowBatch(tid, &row_batches[tid]);
       OMP_LOOP_EX_END();
     }
     OMP_THROW_EX();
@@ -1387,66 +1568,72 @@ void DatasetLoader::ExtractFeaturesFromFile(const char* filename, const Parser*
   if (predict_fun_) {
     init_score = std::vector<double>(static_cast<size_t>(dataset->num_data_) * num_class_);
   }
-  std::function<void(data_size_t, const std::vector<std::string>&)> process_fun =
-    [this, &init_score, &parser, &dataset]
-  (data_size_t start_idx, const std::vector<std::string>& lines) {
+  std::vector<RowBatch> row_batches(OMP_NUM_THREADS());
+  std::function<void(data_size_t, const std::vector<TextLine>&)> process_fun =
+    [this, &init_score, &parser, &dataset, &row_batches]
+  (data_size_t start_idx, const std::vector<TextLine>& lines) {
     std::vector<std::pair<int, double>> oneline_features;
     double tmp_label = 0.0f;
     std::vector<float> feature_row(dataset->num_features_);
+    const data_size_t num_blocks = (static_cast<data_size_t>(lines.size()) + kRowBatchSize - 1) / kRowBatchSize;
     OMP_INIT_EX();
     #pragma omp parallel for num_threads(OMP_NUM_THREADS()) schedule(static) private(oneline_features) firstprivate(tmp_label, feature_row)
-    for (data_size_t i = 0; i < static_cast<data_size_t>(lines.size()); ++i) {
+    for (data_size_t block = 0; block < num_blocks; ++block) {
       OMP_LOOP_EX_BEGIN();
       const int tid = omp_get_thread_num();
-      oneline_features.clear();
-      // parser
-      parser->ParseOneLine(lines[i].c_str(), &oneline_features, &tmp_label);
-      // set initial score
-      if (!init_score.empty()) {
-        std::vector<double> oneline_init_score(num_class_);
-        predict_fun_(oneline_features, oneline_init_score.data());
-        for (int k = 0; k < num_class_; ++k) {
-          init_score[k * dataset->num_data_ + start_idx + i] = static_cast<double>(oneline_init_score[k]);
-        }
-      }
-      // set label
-      dataset->metadata_.SetLabelAt(start_idx + i, static_cast<label_t>(tmp_label));
-      std::vector<bool> is_feature_added(dataset->num_features_, false);
-      // push data
-      for (auto& inner_data : oneline_features) {
-        if (inner_data.first >= dataset->num_total_features_) { continue; }
-        int feature_idx = dataset->used_feature_map_[inner_data.first];
-        if (feature_idx >= 0) {
-          is_feature_added[feature_idx] = true;
-          // if is used feature
-          int group = dataset->feature2group_[feature_idx];
-          int sub_feature = dataset->feature2subfeature_[feature_idx];
-          dataset->feature_groups_[group]->PushData(tid, sub_feature, start_idx + i, inner_data.second);
-          if (dataset->has_raw()) {
-            feature_row[feature_idx] = static_cast<float>(inner_data.second);
+      const data_size_t block_end = std::min(static_cast<data_size_t>(lines.size()), (block + 1) * kRowBatchSize);
+      for (data_size_t i = block * kRowBatchSize; i < block_end; ++i) {
+        oneline_features.clear();
+        // parser
+        parser->ParseOneLine(lines[i].c_str(), &oneline_features, &tmp_label);
+        // set initial score
+        if (!init_score.empty()) {
+          std::vector<double> oneline_init_score(num_class_);
+          predict_fun_(oneline_features, oneline_init_score.data());
+          for (int k = 0; k < num_class_; ++k) {
+            init_score[k * dataset->num_data_ + start_idx + i] = static_cast<double>(oneline_init_score[k]);
           }
-        } else {
-          if (inner_data.first == weight_idx_) {
-            dataset->metadata_.SetWeightAt(start_idx + i, static_cast<label_t>(inner_data.second));
-          } else if (inner_data.first == group_idx_) {
-            dataset->metadata_.SetQueryAt(start_idx + i, static_cast<data_size_t>(inner_data.second));
+        }
+        // set label
+        dataset->metadata_.SetLabelAt(start_idx + i, static_cast<label_t>(tmp_label));
+        std::vector<bool> is_feature_added(dataset->num_features_, false);
+        // push data
+        for (auto& inner_data : oneline_features) {
+          if (inner_data.first >= dataset->num_total_features_) { continue; }
+          int feature_idx = dataset->used_feature_map_[inner_data.first];
+          if (feature_idx >= 0) {
+            is_feature_added[feature_idx] = true;
+            // if is used feature
+            row_batches[tid].Add(feature_idx, start_idx + i, inner_data.second);
+            if (dataset->has_raw()) {
+              feature_row[feature_idx] = static_cast<float>(inner_data.second);
+            }
+          } else {
+            if (inner_data.first == weight_idx_) {
+              dataset->metadata_.SetWeightAt(start_idx + i, static_cast<label_t>(inner_data.second));
+            } else if (inner_data.first == group_idx_) {
+              dataset->metadata_.SetQueryAt(start_idx + i, static_cast<data_size_t>(inner_data.second));
+            }
           }
         }
-      }
-      if (dataset->has_raw()) {
-        for (size_t j = 0; j < feature_row.size(); ++j) {
-          int feat_ind = dataset->numeric_feature_map_[j];
-          if (feat_ind >= 0) {
-            dataset->raw_data_[feat_ind][i] = feature_row[j];
+        if (dataset->has_raw()) {
+          for (size_t j = 0; j < feature_row.size(); ++j) {
+            int feat_ind = dataset->numeric_feature_map_[j];
+            if (feat_ind >= 0) {
+              dataset->raw_data_[feat_ind][start_idx + i] = feature_row[j];
+            }
           }
         }
+        dataset->AddZerosOfRow(start_idx + i, is_feature_added, &row_batches[tid]);
       }
-      dataset->FinishOneRow(tid, i, is_feature_added);
+      dataset->PushRowBatch(tid, &row_batches[tid]);
       OMP_LOOP_EX_END();
     }
     OMP_THROW_EX();
   };
-  TextReader<data_size_t> text_reader(filename, config_.header, config_.file_load_progress_interval_bytes);
+  TextReader<data_size_t> text_reader(filename, config_.header, config_.file_load_progress_interval_bytes,
+                                      static_cast<size_t>(config_.file_read_block_size) * 1024 * 1024,
+                                      config_.file_read_num_buffers);
   if (!used_data_indices.empty()) {
     // only need part of data
     text_reader.ReadPartAndProcessParallel(used_data_indices, process_fun);
@@ -1483,7 +1670,9 @@ std::string DatasetLoader::CheckCanLoadFromBin(const char* filename) {
   size_t size_of_token = std::strlen(Dataset::binary_file_token);
   size_t read_cnt = reader->Read(buffer.data(), size_of_token);
   if (read_cnt == size_of_token
-      && std::string(buffer.data()) == std::string(Dataset::binary_file_token)) {
+      && (std::string(buffer.data()) == std::string(Dataset::binary_file_token)
+          || std::string(buffer.data()) == std::string(Dataset::binary_shards_file_token)
+          || std::string(buffer.data()) == std::string(Dataset::legacy_binary_file_token))) {
     return bin_filename;
   } else {
     return std::string();
@@ -9,19 +9,20 @@
 #include <LightGBM/bin.h>
 #include <LightGBM/cuda/vector_cudahost.h>
 
+#include <bitset>
 #include <cstdint>
 #include <cstring>
 #include <vector>
 
 namespace LightGBM {
 
-template <typename VAL_T, bool IS_4BIT>
+template <typename VAL_T, int PACKED_BITS>
 class DenseBin;
 
-template <typename VAL_T, bool IS_4BIT>
+template <typename VAL_T, int PACKED_BITS>
 class DenseBinIterator : public BinIterator {
  public:
-  explicit DenseBinIterator(const DenseBin<VAL_T, IS_4BIT>* bin_data,
+  explicit DenseBinIterator(const DenseBin<VAL_T, PACKED_BITS>* bin_data,
                             uint32_t min_bin, uint32_t max_bin,
                             uint32_t most_freq_bin)
       : bin_data_(bin_data),
@@ -39,7 +40,7 @@ class DenseBinIterator : public BinIterator {
   inline void Reset(data_size_t) override {}
 
  private:
-  const DenseBin<VAL_T, IS_4BIT>* bin_data_;
+  const DenseBin<VAL_T, PACKED_BITS>* bin_data_;
   VAL_T min_bin_;
   VAL_T max_bin_;
   VAL_T most_freq_bin_;
@@ -48,26 +49,39 @@ class DenseBinIterator : public BinIterator {
 /*!
  * \brief Used to store bins for dense feature
  * Use template to reduce memory cost
+ * \tparam PACKED_BITS 1, 2 or 4 to pack several bins into each uint8_t, 0 to store one bin per VAL_T
  */
-template <typename VAL_T, bool IS_4BIT>
+template <typename VAL_T, int PACKED_BITS>
 class DenseBin : public Bin {
  public:
-  friend DenseBinIterator<VAL_T, IS_4BIT>;
+  friend DenseBinIterator<VAL_T, PACKED_BITS>;
+  /*! \brief Number of bins in each element of data_ */
+  static const int kValuesPerByte = PACKED_BITS > 0 ? 8 / PACKED_BITS : 1;
+  /*! \brief log2(kValuesPerByte), the element of bin idx is idx >> kLogValuesPerByte */
+  static const int kLogValuesPerByte = PACKED_BITS == 1 ? 3 : (PACKED_BITS == 2 ? 2 : (PACKED_BITS == 4 ? 1 : 0));
+  /*! \brief Mask of one packed bin */
+  static const uint32_t kBinMask = (1u << PACKED_BITS) - 1;
+
   explicit DenseBin(data_size_t num_data)
       : num_data_(num_data) {
-    if (IS_4BIT) {
+    if (PACKED_BITS > 0) {
       CHECK_EQ(sizeof(VAL_T), 1);
-      data_.resize((num_data_ + 1) / 2, static_cast<uint8_t>(0));
-      buf_.resize((num_data_ + 1) / 2, static_cast<uint8_t>(0));
+      data_.resize(data_size(), static_cast<uint8_t>(0));
+      if (PACKED_BITS == 4) {
+        buf_.resize(data_size(), static_cast<uint8_t>(0));
+      } else {
+        buf_.resize(num_data_, static_cast<uint8_t>(0));
+      }
     } else {
       data_.resize(num_data_, static_cast<VAL_T>(0));
     }
+    data_ptr_ = data_.data();
   }
 
   ~DenseBin() {}
 
   void Push(int, data_size_t idx, uint32_t value) override {
-    if (IS_4BIT) {
+    if (PACKED_BITS == 4) {
       const int i1 = idx >> 1;
       const int i2 = (idx & 1) << 2;
       const uint8_t val = static_cast<uint8_t>(value) << i2;
@@ -76,6 +90,9 @@ class DenseBin : public Bin {
       } else {
         buf_[i1] = val;
       }
+    } else if (PACKED_BITS > 0) {
+      // more than two bins share a byte, so they are packed in FinishLoad
+      buf_[idx] = static_cast<uint8_t>(value);
     } else {
       data_[idx] = static_cast<VAL_T>(value);
     }
@@ -84,23 +101,136 @@ class DenseBin : public Bin {
   void ReSize(data_size_t num_data) override {
     if (num_data_ != num_data) {
       num_data_ = num_data;
-      if (IS_4BIT) {
-        data_.resize((num_data_ + 1) / 2, static_cast<VAL_T>(0));
+      if (PACKED_BITS > 0) {
+        data_.resize(data_size(), static_cast<VAL_T>(0));
       } else {
         data_.resize(num_data_);
       }
+      data_ptr_ = data_.data();
     }
   }
 
   BinIterator* GetIterator(uint32_t min_bin, uint32_t max_bin,
                            uint32_t most_freq_bin) const override;
 
+  /*! \brief Number of interleaved private histograms used for packed and 8-bit bins */
+  static const int kNumSubHistograms = 4;
+
+  /*! \brief Largest bin value + 1 stored by this bin type, only meaningful for packed and 8-bit bins */
+  static const int kNumSubHistogramBins = PACKED_BITS > 0 ? (1 << PACKED_BITS) : 256;
+
+  /*!
+   * \brief Whether to accumulate into private sub-histograms. Consecutive rows in the same bin
+   *        make the scatter-add wait for the previous store, so packed and 8-bit bins spread the rows
+   *        over kNumSubHistograms independent histograms and merge them once at the end.
+   *        The zeroing and merging cost is only paid back for enough rows.
+   */
+  static bool UseSubHistograms(data_size_t start, data_size_t end) {
+    return sizeof(VAL_T) == 1 && end - start >= (PACKED_BITS > 0 ? 256 : 2048);
+  }
+
+  /*! \brief Number of rows in [start, end) in bin 1, for 1-bit bins */
+  data_size_t CountOnes(data_size_t start, data_size_t end) const {
+    data_size_t cnt = 0;
+    data_size_t i = start;
+    for (; i < end && (i & 7) != 0; ++i) {
+      cnt += data(i);
+    }
+    for (; i + 64 <= end; i += 64) {
+      uint64_t word;
+      std::memcpy(&word, data_ptr_ + (i >> 3), sizeof(word));
+      cnt += static_cast<data_size_t>(std::bitset<64>(word).count());
+    }
+    for (; i < end; ++i) {
+      cnt += data(i);
+    }
+    return cnt;
+  }
+
+  template <bool USE_INDICES, bool USE_HESSIAN>
+  void ConstructHistogramSubInner(const data_size_t* data_indices,
+                                  data_size_t start, data_size_t end,
+                                  const score_t* ordered_gradients,
+                                  const score_t* ordered_hessians,
+                                  hist_t* out) const {
+    // the counts of 1-bit bins over a range of rows are popcounts
+    const bool count_ones = PACKED_BITS == 1 && !USE_INDICES && !USE_HESSIAN;
+    hist_t sub_hist[kNumSubHistograms][kNumSubHistogramBins * 2];
+    std::memset(sub_hist, 0, sizeof(sub_hist));
+    const data_size_t pf_offset = 64 / sizeof(VAL_T);
+    data_size_t i = start;
+    for (; i + kNumSubHistograms <= end; i += kNumSubHistograms) {
+      if (USE_INDICES && i + kNumSubHistograms + pf_offset <= end) {
+        for (int k = 0; k < kNumSubHistograms; ++k) {
+          const auto pf_idx = data_indices[i + pf_offset + k];
+          PREFETCH_T0(data_ptr_ + (pf_idx >> kLogValuesPerByte));
+        }
+      }
+      for (int k = 0; k < kNumSubHistograms; ++k) {
+        const auto idx = USE_INDICES ? data_indices[i + k] : i + k;
+        const auto ti = static_cast<uint32_t>(data(idx)) << 1;
+        sub_hist[k][ti] += ordered_gradients[i + k];
+        if (USE_HESSIAN) {
+          sub_hist[k][ti + 1] += ordered_hessians[i + k];
+        } else if (!count_ones) {
+          ++reinterpret_cast<hist_cnt_t*>(sub_hist[k])[ti + 1];
+        }
+      }
+    }
+    for (; i < end; ++i) {
+      const auto idx = USE_INDICES ? data_indices[i] : i;
+      const auto ti = static_cast<uint32_t>(data(idx)) << 1;
+      sub_hist[0][ti] += ordered_gradients[i];
+      if (USE_HESSIAN) {
+        sub_hist[0][ti + 1] += ordered_hessians[i];
+      } else if (!count_ones) {
+        ++reinterpret_cast<hist_cnt_t*>(sub_hist[0])[ti + 1];
+      }
+    }
+    if (count_ones) {
+      const data_size_t cnt_ones = CountOnes(start, end);
+      reinterpret_cast<hist_cnt_t*>(sub_hist[0])[1] = end - start - cnt_ones;
+      reinterpret_cast<hist_cnt_t*>(sub_hist[0])[3] = cnt_ones;
+    }
+    // bins beyond the feature group are never touched, so only non-zero entries are merged
+    for (int j = 0; j < kNumSubHistogramBins * 2; j += 2) {
+      hist_t sum_grad = sub_hist[0][j];
+      for (int k = 1; k < kNumSubHistograms; ++k) {
+        sum_grad += sub_hist[k][j];
+      }
+      if (USE_HESSIAN) {
+        hist_t sum_hess = sub_hist[0][j + 1];
+        for (int k = 1; k < kNumSubHistograms; ++k) {
+          sum_hess += sub_hist[k][j + 1];
+        }
+        if (sum_grad != 0 || sum_hess != 0) {
+          out[j] += sum_grad;
+          out[j + 1] += sum_hess;
+        }
+      } else {
+        hist_cnt_t sum_cnt = 0;
+        for (int k = 0; k < kNumSubHistograms; ++k) {
+          sum_cnt += reinterpret_cast<const hist_cnt_t*>(sub_hist[k])[j + 1];
+        }
+        if (sum_cnt != 0) {
+          out[j] += sum_grad;
+          reinterpret_cast<hist_cnt_t*>(out)[j + 1] += sum_cnt;
+        }
+      }
+    }
+  }
+
   template <bool USE_INDICES, bool USE_PREFETCH, bool USE_HESSIAN>
   void ConstructHistogramInner(const data_size_t* data_indices,
                                data_size_t start, data_size_t end,
                                const score_t* ordered_gradients,
                                const score_t* ordered_hessians,
                                hist_t* out) const {
+    if (UseSubHistograms(start, end)) {
+      ConstructHistogramSubInner<USE_INDICES, USE_HESSIAN>(
+          data_indices, start, end, ordered_gradients, ordered_hessians, out);
+      return;
+    }
     data_size_t i = start;
     hist_t* grad = out;
     hist_t* hess = out + 1;
@@ -112,11 +242,7 @@ class DenseBin : public Bin {
         const auto idx = USE_INDICES ? data_indices[i] : i;
         const auto pf_idx =
             USE_INDICES ? data_indices[i + pf_offset] : i + pf_offset;
-        if (IS_4BIT) {
-          PREFETCH_T0(data_.data() + (pf_idx >> 1));
-        } else {
-          PREFETCH_T0(data_.data() + pf_idx);
-        }
+        PREFETCH_T0(data_ptr_ + (pf_idx >> kLogValuesPerByte));
         const auto ti = static_cast<uint32_t>(data(idx)) << 1;
         if (USE_HESSIAN) {
           grad[ti] += ordered_gradients[i];
@@ -171,15 +297,68 @@ class DenseBin : public Bin {
   }
 
 
+  template <bool USE_HESSIAN, typename PACKED_HIST_T, int HIST_BITS>
+  static inline PACKED_HIST_T PackGradient(int16_t gradient_16) {
+    if (HIST_BITS == 8) {
+      return gradient_16;
+    }
+    const PACKED_HIST_T packed_grad = static_cast<PACKED_HIST_T>(static_cast<int8_t>(gradient_16 >> 8)) << HIST_BITS;
+    return USE_HESSIAN ? (packed_grad | (gradient_16 & 0xff)) : (packed_grad | 1);
+  }
+
+  template <bool USE_INDICES, bool USE_HESSIAN, typename PACKED_HIST_T, int HIST_BITS>
+  void ConstructHistogramIntSubInner(const data_size_t* data_indices,
+                                     data_size_t start, data_size_t end,
+                                     const score_t* ordered_gradients,
+                                     hist_t* out) const {
+    // integer sums wrap around the same way in any order, so the result is bit-identical to a single histogram
+    PACKED_HIST_T sub_hist[kNumSubHistograms][kNumSubHistogramBins];
+    std::memset(sub_hist, 0, sizeof(sub_hist));
+    const int16_t* gradients_ptr = reinterpret_cast<const int16_t*>(ordered_gradients);
+    const data_size_t pf_offset = 64 / sizeof(VAL_T);
+    data_size_t i = start;
+    for (; i + kNumSubHistograms <= end; i += kNumSubHistograms) {
+      if (USE_INDICES && i + kNumSubHistograms + pf_offset <= end) {
+        for (int k = 0; k < kNumSubHistograms; ++k) {
+          const auto pf_idx = data_indices[i + pf_offset + k];
+          PREFETCH_T0(data_ptr_ + (pf_idx >> kLogValuesPerByte));
+        }
+      }
+      for (int k = 0; k < kNumSubHistograms; ++k) {
+        const auto idx = USE_INDICES ? data_indices[i + k] : i + k;
+        sub_hist[k][data(idx)] += PackGradient<USE_HESSIAN, PACKED_HIST_T, HIST_BITS>(gradients_ptr[i + k]);
+      }
+    }
+    for (; i < end; ++i) {
+      const auto idx = USE_INDICES ? data_indices[i] : i;
+      sub_hist[0][data(idx)] += PackGradient<USE_HESSIAN, PACKED_HIST_T, HIST_BITS>(gradients_ptr[i]);
+    }
+    PACKED_HIST_T* out_ptr = reinterpret_cast<PACKED_HIST_T*>(out);
+    for (int j = 0; j < kNumSubHistogramBins; ++j) {
+      PACKED_HIST_T sum = sub_hist[0][j];
+      for (int k = 1; k < kNumSubHistograms; ++k) {
+        sum += sub_hist[k][j];
+      }
+      if (sum != 0) {
+        out_ptr[j] += sum;
+      }
+    }
+  }
+
   template <bool USE_INDICES, bool USE_PREFETCH, bool USE_HESSIAN, typename PACKED_HIST_T, int HIST_BITS>
   void ConstructHistogramIntInner(const data_size_t* data_indices,
                                data_size_t start, data_size_t end,
                                const score_t* ordered_gradients,
                                hist_t* out) const {
+    if (UseSubHistograms(start, end)) {
+      ConstructHistogramIntSubInner<USE_INDICES, USE_HESSIAN, PACKED_HIST_T, HIST_BITS>(
+          data_indices, start, end, ordered_gradients, out);
+      return;
+    }
     data_size_t i = start;
     PACKED_HIST_T* out_ptr = reinterpret_cast<PACKED_HIST_T*>(out);
     const int16_t* gradients_ptr = reinterpret_cast<const int16_t*>(ordered_gradients);
-    const VAL_T* data_ptr_base = data_.data();
+    const VAL_T* data_ptr_base = data_ptr_;
     if (USE_PREFETCH) {
       const data_size_t pf_offset = 64 / sizeof(VAL_T);
       const data_size_t pf_end = end - pf_offset;
@@ -187,11 +366,7 @@ class DenseBin : public Bin {
         const auto idx = USE_INDICES ? data_indices[i] : i;
         const auto pf_idx =
             USE_INDICES ? data_indices[i + pf_offset] : i + pf_offset;
-        if (IS_4BIT) {
-          PREFETCH_T0(data_ptr_base + (pf_idx >> 1));
-        } else {
-          PREFETCH_T0(data_ptr_base + pf_idx);
-        }
+        PREFETCH_T0(data_ptr_base + (pf_idx >> kLogValuesPerByte));
         const auto ti = static_cast<uint32_t>(data(idx));
         const int16_t gradient_16 = gradients_ptr[i];
         if (USE_HESSIAN) {
@@ -327,67 +502,43 @@ class DenseBin : public Bin {
     }
     const auto minb = static_cast<VAL_T>(min_bin);
     const auto maxb = static_cast<VAL_T>(max_bin);
+    // the side of missing values, and the side of the most frequent bin, which is not stored in this group
+    const bool missing_to_left = (MISS_IS_ZERO || MISS_IS_NA) && default_left;
+    const bool most_freq_to_left =
+        ((MISS_IS_NA && MFB_IS_NA) || (MISS_IS_ZERO && MFB_IS_ZERO)) ? missing_to_left : most_freq_bin <= threshold;
+    // every index is written to both sides and only the count of its side moves forward,
+    // so there is no branch on the bin values
     data_size_t lte_count = 0;
     data_size_t gt_count = 0;
-    data_size_t* default_indices = gt_indices;
-    data_size_t* default_count = &gt_count;
-    data_size_t* missing_default_indices = gt_indices;
-    data_size_t* missing_default_count = &gt_count;
-    if (most_freq_bin <= threshold) {
-      default_indices = lte_indices;
-      default_count = &lte_count;
-    }
-    if (MISS_IS_ZERO || MISS_IS_NA) {
-      if (default_left) {
-        missing_default_indices = lte_indices;
-        missing_default_count = &lte_count;
-      }
-    }
     if (min_bin < max_bin) {
       for (data_size_t i = 0; i < cnt; ++i) {
         const data_size_t idx = data_indices[i];
         const auto bin = data(idx);
-        if ((MISS_IS_ZERO && !MFB_IS_ZERO && bin == t_zero_bin) ||
-            (MISS_IS_NA && !MFB_IS_NA && bin == maxb)) {
-          missing_default_indices[(*missing_default_count)++] = idx;
-        } else if ((USE_MIN_BIN && (bin < minb || bin > maxb)) ||
-                   (!USE_MIN_BIN && bin == 0)) {
-          if ((MISS_IS_NA && MFB_IS_NA) || (MISS_IS_ZERO && MFB_IS_ZERO)) {
-            missing_default_indices[(*missing_default_count)++] = idx;
-          } else {
-            default_indices[(*default_count)++] = idx;
-          }
-        } else if (bin > th) {
-          gt_indices[gt_count++] = idx;
-        } else {
-          lte_indices[lte_count++] = idx;
-        }
+        const bool is_missing = (MISS_IS_ZERO && !MFB_IS_ZERO && bin == t_zero_bin) ||
+                                (MISS_IS_NA && !MFB_IS_NA && bin == maxb);
+        const bool is_most_freq = (USE_MIN_BIN && (bin < minb || bin > maxb)) || (!USE_MIN_BIN && bin == 0);
+        const bool to_left = (is_missing & missing_to_left) |
+                             (!is_missing & is_most_freq & most_freq_to_left) |
+                             (!is_missing & !is_most_freq & (bin <= th));
+        lte_indices[lte_count] = idx;
+        gt_indices[gt_count] = idx;
+        lte_count += to_left;
+        gt_count += !to_left;
       }
     } else {
-      data_size_t* max_bin_indices = gt_indices;
-      data_size_t* max_bin_count = &gt_count;
-      if (maxb <= th) {
-        max_bin_indices = lte_indices;
-        max_bin_count = &lte_count;
-      }
+      const bool max_bin_to_left = (MISS_IS_NA && !MFB_IS_NA) ? missing_to_left : maxb <= th;
       for (data_size_t i = 0; i < cnt; ++i) {
         const data_size_t idx = data_indices[i];
         const auto bin = data(idx);
-        if (MISS_IS_ZERO && !MFB_IS_ZERO && bin == t_zero_bin) {
-          missing_default_indices[(*missing_default_count)++] = idx;
-        } else if (bin != maxb) {
-          if ((MISS_IS_NA && MFB_IS_NA) || (MISS_IS_ZERO && MFB_IS_ZERO)) {
-            missing_default_indices[(*missing_default_count)++] = idx;
-          } else {
-            default_indices[(*default_count)++] = idx;
-          }
-        } else {
-          if (MISS_IS_NA && !MFB_IS_NA) {
-            missing_default_indices[(*missing_default_count)++] = idx;
-          } else {
-            max_bin_indices[(*max_bin_count)++] = idx;
-          }
-        }
+        const bool is_missing = MISS_IS_ZERO && !MFB_IS_ZERO && bin == t_zero_bin;
+        const bool is_max_bin = bin == maxb;
+        const bool to_left = (is_missing & missing_to_left) |
+                             (!is_missing & !is_max_bin & most_freq_to_left) |
+                             (!is_missing & is_max_bin & max_bin_to_left);
+        lte_indices[lte_count] = idx;
+        gt_indices[gt_count] = idx;
+        lte_count += to_left;
+        gt_count += !to_left;
       }
     }
     return lte_count;
@@ -505,18 +656,23 @@ class DenseBin : public Bin {
 
   data_size_t num_data() const override { return num_data_; }
 
-  void* get_data() override { return data_.data(); }
+  void* get_data() override { return const_cast<VAL_T*>(data_ptr_); }
 
   void FinishLoad() override {
-    if (IS_4BIT) {
+    if (PACKED_BITS > 0) {
       if (buf_.empty()) {
         return;
       }
-      int len = (num_data_ + 1) / 2;
-      for (int i = 0; i < len; ++i) {
-        data_[i] |= buf_[i];
+      if (PACKED_BITS == 4) {
+        int len = (num_data_ + 1) / 2;
+        for (int i = 0; i < len; ++i) {
+          data_[i] |= buf_[i];
+        }
+        buf_.clear();
+      } else {
+        PackBins(num_data_, [this](data_size_t i) { return buf_[i]; });
+        std::vector<uint8_t>().swap(buf_);
       }
-      buf_.clear();
     }
   }
 
@@ -525,25 +681,10 @@ class DenseBin : public Bin {
       const std::vector<data_size_t>& local_used_indices) override {
     const VAL_T* mem_data = reinterpret_cast<const VAL_T*>(memory);
     if (!local_used_indices.empty()) {
-      if (IS_4BIT) {
-        const data_size_t rest = num_data_ & 1;
-        for (int i = 0; i < num_data_ - rest; i += 2) {
-          // get old bins
-          data_size_t idx = local_used_indices[i];
-          const auto bin1 = static_cast<uint8_t>(
-              (mem_data[idx >> 1] >> ((idx & 1) << 2)) & 0xf);
-          idx = local_used_indices[i + 1];
-          const auto bin2 = static_cast<uint8_t>(
-              (mem_data[idx >> 1] >> ((idx & 1) << 2)) & 0xf);
-          // add
-          const int i1 = i >> 1;
-          data_[i1] = (bin1 | (bin2 << 4));
-        }
-        if (rest) {
-          data_size_t idx = local_used_indices[num_data_ - 1];
-          data_[num_data_ >> 1] =
-              (mem_data[idx >> 1] >> ((idx & 1) << 2)) & 0xf;
-        }
+      if (PACKED_BITS > 0) {
+        PackBins(num_data_, [mem_data, &local_used_indices](data_size_t i) {
+          return GetBin(mem_data, local_used_indices[i]);
+        });
       } else {
         for (int i = 0; i < num_data_; ++i) {
           data_[i] = mem_data[local_used_indices[i]];
@@ -554,52 +695,57 @@ class DenseBin : public Bin {
         data_[i] = mem_data[i];
       }
     }
+    DropPushBuffer();
   }
 
-  inline VAL_T data(data_size_t idx) const {
-    if (IS_4BIT) {
-      return (data_[idx >> 1] >> ((idx & 1) << 2)) & 0xf;
+  static inline VAL_T GetBin(const VAL_T* data, data_size_t idx) {
+    if (PACKED_BITS > 0) {
+      return (data[idx >> kLogValuesPerByte] >> ((idx & (kValuesPerByte - 1)) * PACKED_BITS)) & kBinMask;
     } else {
-      return data_[idx];
+      return data[idx];
     }
   }
 
+  inline VAL_T data(data_size_t idx) const {
+    return GetBin(data_ptr_, idx);
+  }
+
   void CopySubrow(const Bin* full_bin, const data_size_t* used_indices,
                   data_size_t num_used_indices) override {
-    auto other_bin = dynamic_cast<const DenseBin<VAL_T, IS_4BIT>*>(full_bin);
-    if (IS_4BIT) {
-      const data_size_t rest = num_used_indices & 1;
-      for (int i = 0; i < num_used_indices - rest; i += 2) {
-        data_size_t idx = used_indices[i];
-        const auto bin1 = static_cast<uint8_t>(
-            (other_bin->data_[idx >> 1] >> ((idx & 1) << 2)) & 0xf);
-        idx = used_indices[i + 1];
-        const auto bin2 = static_cast<uint8_t>(
-            (other_bin->data_[idx >> 1] >> ((idx & 1) << 2)) & 0xf);
-        const int i1 = i >> 1;
-        data_[i1] = (bin1 | (bin2 << 4));
-      }
-      if (rest) {
-        data_size_t idx = used_indices[num_used_indices - 1];
-        data_[num_used_indices >> 1] =
-            (other_bin->data_[idx >> 1] >> ((idx & 1) << 2)) & 0xf;
-      }
+    auto other_bin = dynamic_cast<const DenseBin<VAL_T, PACKED_BITS>*>(full_bin);
+    if (PACKED_BITS > 0) {
+      PackBins(num_used_indices, [other_bin, used_indices](data_size_t i) {
+        return other_bin->data(used_indices[i]);
+      });
     } else {
       for (int i = 0; i < num_used_indices; ++i) {
-        data_[i] = other_bin->data_[used_indices[i]];
+        data_[i] = other_bin->data_ptr_[used_indices[i]];
       }
     }
+    DropPushBuffer();
   }
 
   void SaveBinaryToFile(BinaryWriter* writer) const override {
-    writer->AlignedWrite(data_.data(), sizeof(VAL_T) * data_.size());
+    writer->AlignedWrite(data_ptr_, sizeof(VAL_T) * data_size());
   }
 
   size_t SizesInByte() const override {
-    return VirtualFileWriter::AlignedSize(sizeof(VAL_T) * data_.size());
+    return VirtualFileWriter::AlignedSize(sizeof(VAL_T) * data_size());
+  }
+
+  bool MapMemory(const void* memory, data_size_t num_data) override {
+    if (reinterpret_cast<uintptr_t>(memory) % alignof(VAL_T) != 0) {
+      return false;
+    }
+    num_data_ = num_data;
+    data_ptr_ = reinterpret_cast<const VAL_T*>(memory);
+    // the bins are read from the mapped memory from now on
+    decltype(data_)().swap(data_);
+    std::vector<uint8_t>().swap(buf_);
+    return true;
   }
 
-  DenseBin<VAL_T, IS_4BIT>* Clone() override;
+  DenseBin<VAL_T, PACKED_BITS>* Clone() override;
 
   const void* GetColWiseData(uint8_t* bit_type, bool* is_sparse, std::vector<BinIterator*>* bin_iterator, const int num_threads) const override;
 
@@ -613,18 +759,48 @@ class DenseBin : public Bin {
   std::vector<VAL_T, Common::AlignmentAllocator<VAL_T, kAlignedSize>> data_;
 #endif
   std::vector<uint8_t> buf_;
+  /*! \brief Points to data_, or to the mapped memory of a binary dataset file */
+  const VAL_T* data_ptr_;
+
+  /*! \brief Number of VAL_T elements of the bins */
+  size_t data_size() const {
+    return PACKED_BITS > 0 ? static_cast<size_t>((num_data_ + kValuesPerByte - 1) >> kLogValuesPerByte)
+                           : static_cast<size_t>(num_data_);
+  }
+
+  /*! \brief Pack get_bin(0), ..., get_bin(num_data - 1) into data_ */
+  template <typename GET_BIN>
+  void PackBins(data_size_t num_data, const GET_BIN& get_bin) {
+    for (data_size_t i = 0; i < num_data; i += kValuesPerByte) {
+      const int cnt = num_data - i < kValuesPerByte ? num_data - i : kValuesPerByte;
+      uint32_t packed = 0;
+      for (int k = 0; k < cnt; ++k) {
+        packed |= static_cast<uint32_t>(get_bin(i + k)) << (k * PACKED_BITS);
+      }
+      data_[i >> kLogValuesPerByte] = static_cast<VAL_T>(packed);
+    }
+  }
 
-  DenseBin(const DenseBin<VAL_T, IS_4BIT>& other)
-      : num_data_(other.num_data_), data_(other.data_) {}
+  /*! \brief Release the bins buffered by Push once the bins are filled otherwise, so FinishLoad keeps them */
+  void DropPushBuffer() {
+    if (PACKED_BITS > 0 && PACKED_BITS < 4) {
+      std::vector<uint8_t>().swap(buf_);
+    }
+  }
+
+  DenseBin(const DenseBin<VAL_T, PACKED_BITS>& other)
+      : num_data_(other.num_data_), data_(other.data_ptr_, other.data_ptr_ + other.data_size()) {
+    data_ptr_ = data_.data();
+  }
 };
 
-template <typename VAL_T, bool IS_4BIT>
-DenseBin<VAL_T, IS_4BIT>* DenseBin<VAL_T, IS_4BIT>::Clone() {
-  return new DenseBin<VAL_T, IS_4BIT>(*this);
+template <typename VAL_T, int PACKED_BITS>
+DenseBin<VAL_T, PACKED_BITS>* DenseBin<VAL_T, PACKED_BITS>::Clone() {
+  return new DenseBin<VAL_T, PACKED_BITS>(*this);
 }
 
-template <typename VAL_T, bool IS_4BIT>
-uint32_t DenseBinIterator<VAL_T, IS_4BIT>::Get(data_size_t idx) {
+template <typename VAL_T, int PACKED_BITS>
+uint32_t DenseBinIterator<VAL_T, PACKED_BITS>::Get(data_size_t idx) {
   auto ret = bin_data_->data(idx);
   if (ret >= min_bin_ && ret <= max_bin_) {
     return ret - min_bin_ + offset_;
@@ -633,15 +809,15 @@ uint32_t DenseBinIterator<VAL_T, IS_4BIT>::Get(data_size_t idx) {
   }
 }
 
-template <typename VAL_T, bool IS_4BIT>
-inline uint32_t DenseBinIterator<VAL_T, IS_4BIT>::RawGet(data_size_t idx) {
+template <typename VAL_T, int PACKED_BITS>
+inline uint32_t DenseBinIterator<VAL_T, PACKED_BITS>::RawGet(data_size_t idx) {
   return bin_data_->data(idx);
 }
 
-template <typename VAL_T, bool IS_4BIT>
-BinIterator* DenseBin<VAL_T, IS_4BIT>::GetIterator(
+template <typename VAL_T, int PACKED_BITS>
+BinIterator* DenseBin<VAL_T, PACKED_BITS>::GetIterator(
     uint32_t min_bin, uint32_t max_bin, uint32_t most_freq_bin) const {
-  return new DenseBinIterator<VAL_T, IS_4BIT>(this, min_bin, max_bin,
+  return new DenseBinIterator<VAL_T, PACKED_BITS>(this, min_bin, max_bin,
                                               most_freq_bin);
 }
 
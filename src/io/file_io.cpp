@@ -6,10 +6,29 @@
 #include <LightGBM/utils/file_io.h>
 
 #include <LightGBM/utils/log.h>
+#include <LightGBM/utils/openmp_wrapper.h>
 
 #include <algorithm>
+#include <cstring>
 #include <sstream>
 #include <unordered_map>
+#include <utility>
+
+#ifdef USE_ZLIB
+#include <zlib.h>
+#endif  // USE_ZLIB
+
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif  // USE_ZSTD
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define LIGHTGBM_HAS_MMAP
+#endif
 
 namespace LightGBM {
 
@@ -28,6 +47,12 @@ struct LocalFile : VirtualFileReader, VirtualFileWriter {
       fopen_s(&file_, filename_.c_str(), mode_.c_str());
 #else
       file_ = fopen(filename_.c_str(), mode_.c_str());
+#endif
+#if defined(__linux__) && defined(POSIX_FADV_SEQUENTIAL)
+      // files are always read front to back, let the kernel read ahead more aggressively
+      if (file_ != NULL && mode_[0] == 'r') {
+        posix_fadvise(fileno(file_), 0, 0, POSIX_FADV_SEQUENTIAL);
+      }
 #endif
     }
     return file_ != NULL;
@@ -46,20 +71,554 @@ struct LocalFile : VirtualFileReader, VirtualFileWriter {
     return fwrite(buffer, bytes, 1, file_) == 1 ? bytes : 0;
   }
 
+  bool Close() {
+    if (file_ == NULL) {
+      return true;
+    }
+    const bool is_ok = fclose(file_) == 0;
+    file_ = NULL;
+    return is_ok;
+  }
+
  private:
   FILE* file_ = NULL;
   const std::string filename_;
   const std::string mode_;
 };
 
+/*!
+ * \brief Pulls raw bytes from a reader, with a few bytes that were already peeked in front
+ */
+class SourceStream {
+ public:
+  SourceStream(std::unique_ptr<VirtualFileReader> reader, std::vector<char> peeked)
+      : reader_(std::move(reader)), peeked_(std::move(peeked)) {}
+
+  size_t Read(char* buffer, size_t bytes) {
+    size_t cnt = 0;
+    if (peeked_pos_ < peeked_.size()) {
+      cnt = std::min(bytes, peeked_.size() - peeked_pos_);
+      std::memcpy(buffer, peeked_.data() + peeked_pos_, cnt);
+      peeked_pos_ += cnt;
+    }
+    if (cnt < bytes) {
+      cnt += reader_->Read(buffer + cnt, bytes - cnt);
+    }
+    return cnt;
+  }
+
+ private:
+  std::unique_ptr<VirtualFileReader> reader_;
+  std::vector<char> peeked_;
+  size_t peeked_pos_ = 0;
+};
+
+/*!
+ * \brief Decodes a (possibly compressed) stream of bytes
+ */
+struct StreamDecoder {
+  virtual ~StreamDecoder() {}
+  virtual size_t Read(char* buffer, size_t bytes) = 0;
+};
+
+/*! \brief Decoder for uncompressed files */
+class PlainDecoder : public StreamDecoder {
+ public:
+  explicit PlainDecoder(std::unique_ptr<SourceStream> source) : source_(std::move(source)) {}
+
+  size_t Read(char* buffer, size_t bytes) override {
+    return source_->Read(buffer, bytes);
+  }
+
+ private:
+  std::unique_ptr<SourceStream> source_;
+};
+
+const size_t kCompressedInputBufferSize = 16 * 1024 * 1024;
+
+#ifdef USE_ZLIB
+/*! \brief Decoder for gzip files, concatenated gzip members are supported */
+class GzipDecoder : public StreamDecoder {
+ public:
+  explicit GzipDecoder(std::unique_ptr<SourceStream> source)
+      : source_(std::move(source)), in_(kCompressedInputBufferSize) {
+    std::memset(&stream_, 0, sizeof(stream_));
+    // 15 window bits, +32 to detect gzip and zlib headers automatically
+    if (inflateInit2(&stream_, 15 + 32) != Z_OK) {
+      Log::Fatal("Failed to initialize gzip decompression");
+    }
+  }
+
+  ~GzipDecoder() {
+    inflateEnd(&stream_);
+  }
+
+  size_t Read(char* buffer, size_t bytes) override {
+    size_t cnt = 0;
+    while (cnt < bytes && !is_finished_) {
+      if (stream_.avail_in == 0) {
+        stream_.next_in = reinterpret_cast<Bytef*>(in_.data());
+        stream_.avail_in = static_cast<uInt>(source_->Read(in_.data(), in_.size()));
+        if (stream_.avail_in == 0) {
+          if (!is_member_end_) {
+            Log::Fatal("Unexpected end of gzip compressed file");
+          }
+          is_finished_ = true;
+          break;
+        }
+      }
+      if (is_member_end_) {
+        // start next gzip member
+        inflateReset(&stream_);
+        is_member_end_ = false;
+      }
+      const size_t to_read = std::min(bytes - cnt, static_cast<size_t>(1) << 30);
+      stream_.next_out = reinterpret_cast<Bytef*>(buffer + cnt);
+      stream_.avail_out = static_cast<uInt>(to_read);
+      int ret = inflate(&stream_, Z_NO_FLUSH);
+      if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) {
+        Log::Fatal("Failed to decompress gzip data: %s", stream_.msg == nullptr ? "unknown error" : stream_.msg);
+      }
+      cnt += to_read - stream_.avail_out;
+      if (ret == Z_STREAM_END) {
+        is_member_end_ = true;
+      }
+    }
+    return cnt;
+  }
+
+ private:
+  std::unique_ptr<SourceStream> source_;
+  std::vector<char> in_;
+  z_stream stream_;
+  bool is_member_end_ = false;
+  bool is_finished_ = false;
+};
+#endif  // USE_ZLIB
+
+#ifdef USE_ZSTD
+/*!
+ * \brief Decoder for zstd files.
+ *        Consecutive frames with known content size (as written by the zstd writer, or by ``zstd`` seekable
+ *        and multi-threaded modes) are decompressed in parallel, other frames are streamed.
+ */
+class ZstdDecoder : public StreamDecoder {
+ public:
+  explicit ZstdDecoder(std::unique_ptr<SourceStream> source)
+      : source_(std::move(source)), in_(kCompressedInputBufferSize) {
+    dstream_ = ZSTD_createDStream();
+    ZSTD_initDStream(dstream_);
+  }
+
+  ~ZstdDecoder() {
+    ZSTD_freeDStream(dstream_);
+    for (auto dctx : dctxs_) {
+      ZSTD_freeDCtx(dctx);
+    }
+  }
+
+  size_t Read(char* buffer, size_t bytes) override {
+    size_t cnt = 0;
+    while (cnt < bytes) {
+      if (out_pos_ < out_.size()) {
+        size_t to_copy = std::min(bytes - cnt, out_.size() - out_pos_);
+        std::memcpy(buffer + cnt, out_.data() + out_pos_, to_copy);
+        out_pos_ += to_copy;
+        cnt += to_copy;
+        continue;
+      }
+      if (is_streaming_) {
+        cnt += ReadStreaming(buffer + cnt, bytes - cnt);
+        continue;
+      }
+      FillInput();
+      if (in_begin_ == in_end_) {
+        break;
+      }
+      if (!DecompressFrames()) {
+        // the next frame is too large or its size is unknown
+        is_streaming_ = true;
+      }
+    }
+    return cnt;
+  }
+
+ private:
+  /*! \brief Move the unused input to the front, and fill the rest of input buffer */
+  void FillInput() {
+    if (is_source_end_) {
+      return;
+    }
+    if (in_begin_ > 0) {
+      std::memmove(in_.data(), in_.data() + in_begin_, in_end_ - in_begin_);
+      in_end_ -= in_begin_;
+      in_begin_ = 0;
+    }
+    while (in_end_ < in_.size()) {
+      size_t read_cnt = source_->Read(in_.data() + in_end_, in_.size() - in_end_);
+      if (read_cnt == 0) {
+        is_source_end_ = true;
+        break;
+      }
+      in_end_ += read_cnt;
+    }
+  }
+
+  /*!
+   * \brief Decompress all complete frames with known content size in the input buffer in parallel
+   * \return False if the first frame cannot be decompressed in this way
+   */
+  bool DecompressFrames() {
+    std::vector<size_t> in_offsets, in_sizes, out_offsets;
+    size_t pos = in_begin_;
+    size_t total_out = 0;
+    while (pos < in_end_) {
+      const char* frame = in_.data() + pos;
+      unsigned long long content_size = ZSTD_getFrameContentSize(frame, in_end_ - pos);  // NOLINT
+      size_t frame_size = ZSTD_findFrameCompressedSize(frame, in_end_ - pos);
+      if (content_size == ZSTD_CONTENTSIZE_ERROR) {
+        if (in_end_ - pos >= kMaxFrameHeaderSize || is_source_end_) {
+          Log::Fatal("Failed to decompress zstd data: invalid frame header");
+        }
+        break;
+      }
+      if (content_size == ZSTD_CONTENTSIZE_UNKNOWN || ZSTD_isError(frame_size)
+          || content_size > kMaxBufferedFrameSize) {
+        if (ZSTD_isError(frame_size) && is_source_end_ && content_size != ZSTD_CONTENTSIZE_UNKNOWN) {
+          Log::Fatal("Failed to decompress zstd data: %s", ZSTD_getErrorName(frame_size));
+        }
+        break;
+      }
+      in_offsets.push_back(pos);
+      in_sizes.push_back(frame_size);
+      out_offsets.push_back(total_out);
+      total_out += static_cast<size_t>(content_size);
+      pos += frame_size;
+    }
+    if (in_offsets.empty()) {
+      return false;
+    }
+    out_.resize(total_out);
+    out_pos_ = 0;
+    const int num_frames = static_cast<int>(in_offsets.size());
+    const int num_threads = std::min(OMP_NUM_THREADS(), num_frames);
+    while (static_cast<int>(dctxs_.size()) < num_threads) {
+      dctxs_.push_back(ZSTD_createDCtx());
+    }
+    OMP_INIT_EX();
+    #pragma omp parallel for num_threads(num_threads) schedule(dynamic)
+    for (int i = 0; i < num_frames; ++i) {
+      OMP_LOOP_EX_BEGIN();
+      const size_t expected = (i + 1 < num_frames ? out_offsets[i + 1] : total_out) - out_offsets[i];
+      size_t ret = ZSTD_decompressDCtx(dctxs_[omp_get_thread_num()], out_.data() + out_offsets[i], expected,
+                                       in_.data() + in_offsets[i], in_sizes[i]);
+      if (ZSTD_isError(ret)) {
+        Log::Fatal("Failed to decompress zstd data: %s", ZSTD_getErrorName(ret));
+      }
+      if (ret != expected) {
+        Log::Fatal("Failed to decompress zstd data: frame size mismatch");
+      }
+      OMP_LOOP_EX_END();
+    }
+    OMP_THROW_EX();
+    in_begin_ = pos;
+    return true;
+  }
+
+  /*! \brief Decompress the current frame with streaming API */
+  size_t ReadStreaming(char* buffer, size_t bytes) {
+    ZSTD_outBuffer output = { buffer, bytes, 0 };
+    while (output.pos < output.size) {
+      if (in_begin_ == in_end_) {
+        FillInput();
+        if (in_begin_ == in_end_) {
+          Log::Fatal("Unexpected end of zstd compressed file");
+        }
+      }
+      ZSTD_inBuffer input = { in_.data(), in_end_, in_begin_ };
+      size_t ret = ZSTD_decompressStream(dstream_, &output, &input);
+      if (ZSTD_isError(ret)) {
+        Log::Fatal("Failed to decompress zstd data: %s", ZSTD_getErrorName(ret));
+      }
+      in_begin_ = input.pos;
+      if (ret == 0) {
+        // end of frame, go back to parallel decompression
+        is_streaming_ = false;
+        break;
+      }
+    }
+    return output.pos;
+  }
+
+  /*! \brief Same as ZSTD_FRAMEHEADERSIZE_MAX, which is only exposed in the static linking API */
+  static const size_t kMaxFrameHeaderSize = 18;
+  /*! \brief Frames larger than this are streamed instead of buffered */
+  static const size_t kMaxBufferedFrameSize = 64 * 1024 * 1024;
+  std::unique_ptr<SourceStream> source_;
+  std::vector<char> in_;
+  size_t in_begin_ = 0;
+  size_t in_end_ = 0;
+  bool is_source_end_ = false;
+  std::vector<char> out_;
+  size_t out_pos_ = 0;
+  bool is_streaming_ = false;
+  ZSTD_DStream* dstream_;
+  std::vector<ZSTD_DCtx*> dctxs_;
+};
+#endif  // USE_ZSTD
+
+/*!
+ * \brief Reader that detects gzip and zstd compressed files by their magic numbers
+ *        and decompresses them on the fly, other files are read as they are
+ */
+struct DecompressingReader : VirtualFileReader {
+  explicit DecompressingReader(std::unique_ptr<VirtualFileReader> reader)
+      : reader_(std::move(reader)) {}
+
+  bool Init() {
+    if (decoder_ != nullptr) {
+      return true;
+    }
+    if (!reader_->Init()) {
+      return false;
+    }
+    std::vector<char> magic(4);
+    size_t cnt = 0;
+    while (cnt < magic.size()) {
+      size_t read_cnt = reader_->Read(magic.data() + cnt, magic.size() - cnt);
+      if (read_cnt == 0) {
+        break;
+      }
+      cnt += read_cnt;
+    }
+    magic.resize(cnt);
+    const bool is_gzip = cnt >= 2 && static_cast<unsigned char>(magic[0]) == 0x1f
+                         && static_cast<unsigned char>(magic[1]) == 0x8b;
+    const bool is_zstd = cnt >= 4 && static_cast<unsigned char>(magic[0]) == 0x28
+                         && static_cast<unsigned char>(magic[1]) == 0xb5
+                         && static_cast<unsigned char>(magic[2]) == 0x2f
+                         && static_cast<unsigned char>(magic[3]) == 0xfd;
+    std::unique_ptr<SourceStream> source(new SourceStream(std::move(reader_), std::move(magic)));
+    if (is_gzip) {
+#ifdef USE_ZLIB
+      decoder_.reset(new GzipDecoder(std::move(source)));
+#else
+      Log::Fatal("Cannot read gzip compressed file, please rebuild LightGBM with -DUSE_ZLIB=ON");
+#endif  // USE_ZLIB
+    } else if (is_zstd) {
+#ifdef USE_ZSTD
+      decoder_.reset(new ZstdDecoder(std::move(source)));
+#else
+      Log::Fatal("Cannot read zstd compressed file, please rebuild LightGBM with -DUSE_ZSTD=ON");
+#endif  // USE_ZSTD
+    } else {
+      decoder_.reset(new PlainDecoder(std::move(source)));
+    }
+    return true;
+  }
+
+  size_t Read(void* buffer, size_t bytes) const {
+    return decoder_->Read(reinterpret_cast<char*>(buffer), bytes);
+  }
+
+ private:
+  std::unique_ptr<VirtualFileReader> reader_;
+  std::unique_ptr<StreamDecoder> decoder_;
+};
+
+const size_t kCompressedChunkSize = 4 * 1024 * 1024;
+
+#ifdef USE_ZLIB
+/*! \brief Writer of gzip files */
+struct GzipWriter : VirtualFileWriter {
+  explicit GzipWriter(std::unique_ptr<VirtualFileWriter> writer)
+      : writer_(std::move(writer)), out_(kCompressedChunkSize) {
+    std::memset(&stream_, 0, sizeof(stream_));
+  }
+
+  ~GzipWriter() {
+    if (is_init_) {
+      deflateEnd(&stream_);
+    }
+  }
+
+  bool Init() {
+    if (!is_init_) {
+      if (!writer_->Init()) {
+        return false;
+      }
+      // 15 window bits, +16 to write gzip header
+      if (deflateInit2(&stream_, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return false;
+      }
+      is_init_ = true;
+    }
+    return true;
+  }
+
+  size_t Write(const void* data, size_t bytes) {
+    const char* ptr = reinterpret_cast<const char*>(data);
+    size_t remain = bytes;
+    while (remain > 0) {
+      const size_t cnt = std::min(remain, static_cast<size_t>(1) << 30);
+      Compress(ptr, cnt, Z_NO_FLUSH);
+      ptr += cnt;
+      remain -= cnt;
+    }
+    return bytes;
+  }
+
+  bool Close() {
+    if (is_init_) {
+      Compress(nullptr, 0, Z_FINISH);
+      deflateEnd(&stream_);
+      is_init_ = false;
+    }
+    return writer_->Close();
+  }
+
+ private:
+  void Compress(const char* data, size_t bytes, int flush) {
+    stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    stream_.avail_in = static_cast<uInt>(bytes);
+    do {
+      stream_.next_out = reinterpret_cast<Bytef*>(out_.data());
+      stream_.avail_out = static_cast<uInt>(out_.size());
+      int ret = deflate(&stream_, flush);
+      if (ret == Z_STREAM_ERROR) {
+        Log::Fatal("Failed to compress gzip data");
+      }
+      const size_t cnt = out_.size() - stream_.avail_out;
+      if (cnt > 0 && writer_->Write(out_.data(), cnt) != cnt) {
+        Log::Fatal("Failed to write gzip compressed data");
+      }
+    } while (stream_.avail_out == 0);
+  }
+
+  std::unique_ptr<VirtualFileWriter> writer_;
+  std::vector<char> out_;
+  z_stream stream_;
+  bool is_init_ = false;
+};
+#endif  // USE_ZLIB
+
+#ifdef USE_ZSTD
+/*!
+ * \brief Writer of zstd files.
+ *        Data is cut into fixed size chunks, each compressed into an independent frame with known content size,
+ *        so chunks are compressed in parallel here, and decompressed in parallel by ZstdDecoder.
+ */
+struct ZstdWriter : VirtualFileWriter {
+  explicit ZstdWriter(std::unique_ptr<VirtualFileWriter> writer)
+      : writer_(std::move(writer)) {
+    const int num_threads = std::max(1, OMP_NUM_THREADS());
+    in_.reserve(kCompressedChunkSize * num_threads);
+  }
+
+  ~ZstdWriter() {
+    for (auto cctx : cctxs_) {
+      ZSTD_freeCCtx(cctx);
+    }
+  }
+
+  bool Init() {
+    is_init_ = is_init_ || writer_->Init();
+    return is_init_;
+  }
+
+  size_t Write(const void* data, size_t bytes) {
+    const char* ptr = reinterpret_cast<const char*>(data);
+    size_t remain = bytes;
+    while (remain > 0) {
+      const size_t cnt = std::min(remain, in_.capacity() - in_.size());
+      in_.insert(in_.end(), ptr, ptr + cnt);
+      ptr += cnt;
+      remain -= cnt;
+      if (in_.size() == in_.capacity()) {
+        Flush();
+      }
+    }
+    return bytes;
+  }
+
+  bool Close() {
+    if (is_init_) {
+      Flush();
+      is_init_ = false;
+    }
+    return writer_->Close();
+  }
+
+ private:
+  void Flush() {
+    if (in_.empty()) {
+      return;
+    }
+    const int num_chunks = static_cast<int>((in_.size() + kCompressedChunkSize - 1) / kCompressedChunkSize);
+    const int num_threads = std::min(OMP_NUM_THREADS(), num_chunks);
+    while (static_cast<int>(cctxs_.size()) < num_threads) {
+      cctxs_.push_back(ZSTD_createCCtx());
+    }
+    out_.resize(num_chunks);
+    OMP_INIT_EX();
+    #pragma omp parallel for num_threads(num_threads) schedule(static, 1)
+    for (int i = 0; i < num_chunks; ++i) {
+      OMP_LOOP_EX_BEGIN();
+      const size_t begin = i * kCompressedChunkSize;
+      const size_t size = std::min(kCompressedChunkSize, in_.size() - begin);
+      out_[i].resize(ZSTD_compressBound(size));
+      size_t ret = ZSTD_compressCCtx(cctxs_[omp_get_thread_num()], out_[i].data(), out_[i].size(),
+                                     in_.data() + begin, size, ZSTD_CLEVEL_DEFAULT);
+      if (ZSTD_isError(ret)) {
+        Log::Fatal("Failed to compress zstd data: %s", ZSTD_getErrorName(ret));
+      }
+      out_[i].resize(ret);
+      OMP_LOOP_EX_END();
+    }
+    OMP_THROW_EX();
+    for (int i = 0; i < num_chunks; ++i) {
+      if (writer_->Write(out_[i].data(), out_[i].size()) != out_[i].size()) {
+        Log::Fatal("Failed to write zstd compressed data");
+      }
+    }
+    in_.clear();
+  }
+
+  std::unique_ptr<VirtualFileWriter> writer_;
+  std::vector<char> in_;
+  std::vector<std::vector<char>> out_;
+  std::vector<ZSTD_CCtx*> cctxs_;
+  bool is_init_ = false;
+};
+#endif  // USE_ZSTD
+
+static bool HasSuffix(const std::string& str, const std::string& suffix) {
+  return str.size() >= suffix.size() && str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
 std::unique_ptr<VirtualFileReader> VirtualFileReader::Make(
     const std::string& filename) {
-  return std::unique_ptr<VirtualFileReader>(new LocalFile(filename, "rb"));
+  return std::unique_ptr<VirtualFileReader>(new DecompressingReader(
+    std::unique_ptr<VirtualFileReader>(new LocalFile(filename, "rb"))));
 }
 
 std::unique_ptr<VirtualFileWriter> VirtualFileWriter::Make(
     const std::string& filename) {
-  return std::unique_ptr<VirtualFileWriter>(new LocalFile(filename, "wb"));
+  std::unique_ptr<VirtualFileWriter> file(new LocalFile(filename, "wb"));
+  if (HasSuffix(filename, ".gz")) {
+#ifdef USE_ZLIB
+    return std::unique_ptr<VirtualFileWriter>(new GzipWriter(std::move(file)));
+#else
+    Log::Warning("LightGBM is built without gzip support (-DUSE_ZLIB=ON), %s will not be compressed", filename.c_str());
+#endif  // USE_ZLIB
+  } else if (HasSuffix(filename, ".zst")) {
+#ifdef USE_ZSTD
+    return std::unique_ptr<VirtualFileWriter>(new ZstdWriter(std::move(file)));
+#else
+    Log::Warning("LightGBM is built without zstd support (-DUSE_ZSTD=ON), %s will not be compressed", filename.c_str());
+#endif  // USE_ZSTD
+  }
+  return file;
 }
 
 bool VirtualFileWriter::Exists(const std::string& filename) {
@@ -67,4 +626,72 @@ bool VirtualFileWriter::Exists(const std::string& filename) {
   return file.Exists();
 }
 
+#ifdef LIGHTGBM_HAS_MMAP
+class PosixMappedFile : public MappedFile {
+ public:
+  PosixMappedFile(int fd, char* data, size_t size) : fd_(fd), data_(data), size_(size) {}
+
+  ~PosixMappedFile() {
+    munmap(data_, size_);
+    close(fd_);
+  }
+
+  const char* data() const override { return data_; }
+
+  size_t size() const override { return size_; }
+
+  void WillNeed(size_t offset, size_t bytes) const override {
+    Advise(offset, bytes, MADV_WILLNEED);
+  }
+
+  void DontNeed(size_t offset, size_t bytes) const override {
+    Advise(offset, bytes, MADV_DONTNEED);
+#if defined(__linux__) && defined(POSIX_FADV_DONTNEED)
+    // also drop the clean pages from the page cache, otherwise they still count against the node memory
+    posix_fadvise(fd_, static_cast<off_t>(offset), static_cast<off_t>(bytes), POSIX_FADV_DONTNEED);
+#endif
+  }
+
+ private:
+  void Advise(size_t offset, size_t bytes, int advice) const {
+    if (offset >= size_) {
+      return;
+    }
+    bytes = std::min(bytes, size_ - offset);
+    // madvise needs a page aligned start
+    static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t begin = offset / page_size * page_size;
+    madvise(data_ + begin, bytes + offset - begin, advice);
+  }
+
+  int fd_;
+  char* data_;
+  size_t size_;
+};
+#endif  // LIGHTGBM_HAS_MMAP
+
+std::unique_ptr<MappedFile> MappedFile::Make(const std::string& filename) {
+#ifdef LIGHTGBM_HAS_MMAP
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return nullptr;
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || file_stat.st_size <= 0) {
+    close(fd);
+    return nullptr;
+  }
+  const size_t size = static_cast<size_t>(file_stat.st_size);
+  void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  if (data == MAP_FAILED) {
+    close(fd);
+    return nullptr;
+  }
+  return std::unique_ptr<MappedFile>(new PosixMappedFile(fd, reinterpret_cast<char*>(data), size));
+#else
+  Log::Warning("Memory mapped files are not supported on this platform, %s cannot be mapped", filename.c_str());
+  return nullptr;
+#endif  // LIGHTGBM_HAS_MMAP
+}
+
 }  // namespace LightGBM
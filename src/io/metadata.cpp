@@ -631,17 +631,18 @@ void Metadata::LoadWeights() {
   // default weight file name
   weight_filename.append(".weight");
   TextReader<size_t> reader(weight_filename.c_str(), false);
-  reader.ReadAllLines();
-  if (reader.Lines().empty()) {
+  std::vector<std::string> lines;
+  reader.ReadAllLines(&lines);
+  if (lines.empty()) {
     return;
   }
   Log::Info("Loading weights...");
-  num_weights_ = static_cast<data_size_t>(reader.Lines().size());
+  num_weights_ = static_cast<data_size_t>(lines.size());
   weights_ = std::vector<label_t>(num_weights_);
   #pragma omp parallel for num_threads(OMP_NUM_THREADS()) schedule(static)
   for (data_size_t i = 0; i < num_weights_; ++i) {
     double tmp_weight = 0.0f;
-    Common::Atof(reader.Lines()[i].c_str(), &tmp_weight);
+    Common::Atof(lines[i].c_str(), &tmp_weight);
     weights_[i] = Common::AvoidInf(static_cast<label_t>(tmp_weight));
   }
   weight_load_from_file_ = true;
@@ -653,17 +654,18 @@ void Metadata::LoadPositions() {
   // default position file name
   position_filename.append(".position");
   TextReader<size_t> reader(position_filename.c_str(), false);
-  reader.ReadAllLines();
-  if (reader.Lines().empty()) {
+  std::vector<std::string> lines;
+  reader.ReadAllLines(&lines);
+  if (lines.empty()) {
     return;
   }
   Log::Info("Loading positions from %s ...", position_filename.c_str());
-  num_positions_ = static_cast<data_size_t>(reader.Lines().size());
+  num_positions_ = static_cast<data_size_t>(lines.size());
   positions_ = std::vector<data_size_t>(num_positions_);
   position_ids_ = std::vector<std::string>();
   std::unordered_map<std::string, data_size_t> map_id2pos;
   for (data_size_t i = 0; i < num_positions_; ++i) {
-    std::string& line = reader.Lines()[i];
+    std::string& line = lines[i];
     if (map_id2pos.count(line) == 0) {
       map_id2pos[line] = static_cast<data_size_t>(position_ids_.size());
       position_ids_.push_back(line);
@@ -680,15 +682,16 @@ void Metadata::LoadInitialScore(const std::string& data_filename) {
   // default init_score file name
   init_score_filename.append(".init");
   TextReader<size_t> reader(init_score_filename.c_str(), false);
-  reader.ReadAllLines();
-  if (reader.Lines().empty()) {
+  std::vector<std::string> lines;
+  reader.ReadAllLines(&lines);
+  if (lines.empty()) {
     return;
   }
   Log::Info("Loading initial scores...");
 
   // use first line to count number class
-  int num_class = static_cast<int>(Common::Split(reader.Lines()[0].c_str(), '\t').size());
-  data_size_t num_line = static_cast<data_size_t>(reader.Lines().size());
+  int num_class = static_cast<int>(Common::Split(lines[0].c_str(), '\t').size());
+  data_size_t num_line = static_cast<data_size_t>(lines.size());
   num_init_score_ = static_cast<int64_t>(num_line) * num_class;
 
   init_score_ = std::vector<double>(num_init_score_);
@@ -696,7 +699,7 @@ void Metadata::LoadInitialScore(const std::string& data_filename) {
     #pragma omp parallel for num_threads(OMP_NUM_THREADS()) schedule(static)
     for (data_size_t i = 0; i < num_line; ++i) {
       double tmp = 0.0f;
-      Common::Atof(reader.Lines()[i].c_str(), &tmp);
+      Common::Atof(lines[i].c_str(), &tmp);
       init_score_[i] = Common::AvoidInf(static_cast<double>(tmp));
     }
   } else {
@@ -704,7 +707,7 @@ void Metadata::LoadInitialScore(const std::string& data_filename) {
     #pragma omp parallel for num_threads(OMP_NUM_THREADS()) schedule(static)
     for (data_size_t i = 0; i < num_line; ++i) {
       double tmp = 0.0f;
-      oneline_init_score = Common::Split(reader.Lines()[i].c_str(), '\t');
+      oneline_init_score = Common::Split(lines[i].c_str(), '\t');
       if (static_cast<int>(oneline_init_score.size()) != num_class) {
         Log::Fatal("Invalid initial score file. Redundant or insufficient columns");
       }
@@ -723,17 +726,18 @@ void Metadata::LoadQueryBoundaries() {
   // default query file name
   query_filename.append(".query");
   TextReader<size_t> reader(query_filename.c_str(), false);
-  reader.ReadAllLines();
-  if (reader.Lines().empty()) {
+  std::vector<std::string> lines;
+  reader.ReadAllLines(&lines);
+  if (lines.empty()) {
     return;
   }
   Log::Info("Calculating query boundaries...");
-  query_boundaries_ = std::vector<data_size_t>(reader.Lines().size() + 1);
-  num_queries_ = static_cast<data_size_t>(reader.Lines().size());
+  query_boundaries_ = std::vector<data_size_t>(lines.size() + 1);
+  num_queries_ = static_cast<data_size_t>(lines.size());
   query_boundaries_[0] = 0;
-  for (size_t i = 0; i < reader.Lines().size(); ++i) {
+  for (size_t i = 0; i < lines.size(); ++i) {
     int tmp_cnt;
-    Common::Atoi(reader.Lines()[i].c_str(), &tmp_cnt);
+    Common::Atoi(lines[i].c_str(), &tmp_cnt);
     query_boundaries_[i + 1] = query_boundaries_[i] + static_cast<data_size_t>(tmp_cnt);
   }
   query_load_from_file_ = true;
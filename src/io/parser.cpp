@@ -299,8 +299,9 @@ Parser* Parser::CreateParser(const char* filename, bool header, int num_features
 
 std::string Parser::GenerateParserConfigStr(const char* filename, const char* parser_config_filename, bool header, int label_idx) {
   TextReader<data_size_t> parser_config_reader(parser_config_filename, false);
-  parser_config_reader.ReadAllLines();
-  std::string parser_config_str = parser_config_reader.JoinedLines();
+  std::vector<std::string> parser_config_lines;
+  parser_config_reader.ReadAllLines(&parser_config_lines);
+  std::string parser_config_str = Common::Join(parser_config_lines, "\n");
   if (!parser_config_str.empty()) {
     // save header to parser config in case needed.
     if (header && Common::GetFromParserConfig(parser_config_str, "header").empty()) {
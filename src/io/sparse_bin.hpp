@@ -23,6 +23,8 @@ template <typename VAL_T>
 class SparseBin;
 
 const size_t kNumFastIndex = 64;
+/*! \brief Average number of stored values per block of the fast index */
+const data_size_t kNumValsPerFastIndex = 16;
 
 template <typename VAL_T>
 class SparseBinIterator : public BinIterator {
@@ -121,15 +123,18 @@ class SparseBin : public Bin {
         if (++i >= end) {
           break;
         }
+        SkipToBlock(data_indices[i], &i_delta, &cur_pos);
       } else {
         const VAL_T bin = vals_[i_delta];
         ACC_GH(out, bin, ordered_gradients[i], ordered_hessians[i]);
         if (++i >= end) {
           break;
         }
-        cur_pos += deltas_[++i_delta];
-        if (i_delta >= num_vals_) {
-          break;
+        if (!SkipToBlock(data_indices[i], &i_delta, &cur_pos)) {
+          cur_pos += deltas_[++i_delta];
+          if (i_delta >= num_vals_) {
+            break;
+          }
         }
       }
     }
@@ -169,6 +174,7 @@ class SparseBin : public Bin {
         if (++i >= end) {
           break;
         }
+        SkipToBlock(data_indices[i], &i_delta, &cur_pos);
       } else {
         const uint32_t ti = static_cast<uint32_t>(vals_[i_delta]) << 1;
         grad[ti] += ordered_gradients[i];
@@ -176,9 +182,11 @@ class SparseBin : public Bin {
         if (++i >= end) {
           break;
         }
-        cur_pos += deltas_[++i_delta];
-        if (i_delta >= num_vals_) {
-          break;
+        if (!SkipToBlock(data_indices[i], &i_delta, &cur_pos)) {
+          cur_pos += deltas_[++i_delta];
+          if (i_delta >= num_vals_) {
+            break;
+          }
         }
       }
     }
@@ -258,6 +266,7 @@ class SparseBin : public Bin {
           if (++i >= end) {
             break;
           }
+          SkipToBlock(data_indices[i], &i_delta, &cur_pos);
         } else {
           const VAL_T bin = vals_[i_delta];
           const int16_t gradient_16 = gradients_and_hessians_ptr[i];
@@ -267,9 +276,11 @@ class SparseBin : public Bin {
           if (++i >= end) {
             break;
           }
-          cur_pos += deltas_[++i_delta];
-          if (i_delta >= num_vals_) {
-            break;
+          if (!SkipToBlock(data_indices[i], &i_delta, &cur_pos)) {
+            cur_pos += deltas_[++i_delta];
+            if (i_delta >= num_vals_) {
+              break;
+            }
           }
         }
       }
@@ -287,6 +298,7 @@ class SparseBin : public Bin {
           if (++i >= end) {
             break;
           }
+          SkipToBlock(data_indices[i], &i_delta, &cur_pos);
         } else {
           const uint32_t ti = static_cast<uint32_t>(vals_[i_delta]) << 1;
           grad[ti] += gradients_and_hessians_ptr[i << 1];
@@ -294,9 +306,11 @@ class SparseBin : public Bin {
           if (++i >= end) {
             break;
           }
-          cur_pos += deltas_[++i_delta];
-          if (i_delta >= num_vals_) {
-            break;
+          if (!SkipToBlock(data_indices[i], &i_delta, &cur_pos)) {
+            cur_pos += deltas_[++i_delta];
+            if (i_delta >= num_vals_) {
+              break;
+            }
           }
         }
       }
@@ -660,8 +674,13 @@ class SparseBin : public Bin {
 
   void GetFastIndex() {
     fast_index_.clear();
-    // get shift cnt
+    // get shift cnt, use blocks of about kNumValsPerFastIndex values,
+    // so gathering rows of a small leaf can skip blocks without any of its rows
     data_size_t mod_size = (num_data_ + kNumFastIndex - 1) / kNumFastIndex;
+    if (num_vals_ > 0) {
+      mod_size = std::min(mod_size, static_cast<data_size_t>(
+        static_cast<int64_t>(num_data_) * kNumValsPerFastIndex / num_vals_));
+    }
     data_size_t pow2_mod_size = 1;
     fast_index_shift_ = 0;
     while (pow2_mod_size < mod_size) {
@@ -804,6 +823,22 @@ class SparseBin : public Bin {
     }
   }
 
+  /*!
+  * \brief Jump to the first value of the block of idx, if at least one whole block lies between cur_pos and idx
+  * \return True if jumped
+  */
+  inline bool SkipToBlock(data_size_t idx, data_size_t* i_delta,
+                          data_size_t* cur_pos) const {
+    const auto block = static_cast<size_t>(idx >> fast_index_shift_);
+    if (block > static_cast<size_t>(*cur_pos >> fast_index_shift_) + 1 && block < fast_index_.size()) {
+      const auto& fast_pair = fast_index_[block];
+      *i_delta = fast_pair.first;
+      *cur_pos = fast_pair.second;
+      return true;
+    }
+    return false;
+  }
+
   const void* GetColWiseData(uint8_t* bit_type, bool* is_sparse, std::vector<BinIterator*>* bin_iterator, const int num_threads) const override;
 
   const void* GetColWiseData(uint8_t* bit_type, bool* is_sparse, BinIterator** bin_iterator) const override;
@@ -816,7 +851,7 @@ class SparseBin : public Bin {
   data_size_t num_vals_;
   std::vector<std::vector<std::pair<data_size_t, VAL_T>>> push_buffers_;
   std::vector<std::pair<data_size_t, data_size_t>> fast_index_;
-  data_size_t fast_index_shift_;
+  data_size_t fast_index_shift_ = 0;
 };
 
 template <typename VAL_T>
@@ -831,6 +866,9 @@ inline uint32_t SparseBinIterator<VAL_T>::RawGet(data_size_t idx) {
 
 template <typename VAL_T>
 inline VAL_T SparseBinIterator<VAL_T>::InnerRawGet(data_size_t idx) {
+  if (cur_pos_ < idx) {
+    bin_data_->SkipToBlock(idx, &i_delta_, &cur_pos_);
+  }
   while (cur_pos_ < idx) {
     bin_data_->NextNonzeroFast(&i_delta_, &cur_pos_);
   }
@@ -508,6 +508,41 @@ void TrainingShareStates::CalcBinOffsets(const std::vector<std::unique_ptr<Featu
   #endif  // USE_CUDA
 }
 
+void TrainingShareStates::SetRowWiseState(TrainingShareStates* row_wise_state,
+  double col_wise_fixed_cost, double col_wise_cost_per_row,
+  double row_wise_fixed_cost, double row_wise_cost_per_row) {
+  row_wise_state_.reset(row_wise_state);
+  col_wise_fixed_cost_ = col_wise_fixed_cost;
+  col_wise_cost_per_row_ = col_wise_cost_per_row;
+  row_wise_fixed_cost_ = row_wise_fixed_cost;
+  row_wise_cost_per_row_ = row_wise_cost_per_row;
+  row_wise_hist_buf_.clear();
+  row_wise_hist_move_src_.clear();
+  row_wise_hist_move_dest_.clear();
+  row_wise_hist_move_size_.clear();
+  const std::vector<uint32_t>& row_wise_offsets = row_wise_state->feature_hist_offsets();
+  if (row_wise_offsets == feature_hist_offsets_) {
+    return;
+  }
+  CHECK_EQ(row_wise_offsets.size(), feature_hist_offsets_.size());
+  // the bins of a feature end before the next feature in both layouts, bins in between belong to no feature
+  for (size_t i = 0; i + 1 < feature_hist_offsets_.size(); ++i) {
+    const uint32_t src = row_wise_offsets[i];
+    const uint32_t dest = feature_hist_offsets_[i];
+    const uint32_t size = std::min(row_wise_offsets[i + 1] - src, feature_hist_offsets_[i + 1] - dest);
+    if (!row_wise_hist_move_src_.empty() &&
+        row_wise_hist_move_src_.back() + row_wise_hist_move_size_.back() == src &&
+        row_wise_hist_move_dest_.back() + row_wise_hist_move_size_.back() == dest) {
+      row_wise_hist_move_size_.back() += size;
+    } else {
+      row_wise_hist_move_src_.push_back(src);
+      row_wise_hist_move_dest_.push_back(dest);
+      row_wise_hist_move_size_.push_back(size);
+    }
+  }
+  row_wise_hist_buf_.resize(static_cast<size_t>(row_wise_state->num_hist_total_bin()) * 2);
+}
+
 void TrainingShareStates::SetMultiValBin(MultiValBin* bin, data_size_t num_data,
   const std::vector<std::unique_ptr<FeatureGroup>>& feature_groups,
   bool dense_only, bool sparse_only, const int num_grad_quant_bins) {
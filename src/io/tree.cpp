@@ -8,9 +8,11 @@
 #include <LightGBM/utils/common.h>
 #include <LightGBM/utils/threading.h>
 
+#include <algorithm>
 #include <functional>
 #include <iomanip>
 #include <sstream>
+#include <vector>
 
 namespace LightGBM {
 
@@ -97,23 +99,6 @@ int Tree::SplitCategorical(int leaf, int feature, int real_feature, const uint32
   return num_leaves_ - 1;
 }
 
-#define PredictionFun(niter, fidx_in_iter, start_pos, decision_fun, iter_idx, \
-                      data_idx)                                               \
-  std::vector<std::unique_ptr<BinIterator>> iter((niter));                    \
-  for (int i = 0; i < (niter); ++i) {                                         \
-    iter[i].reset(data->FeatureIterator((fidx_in_iter)));                     \
-    iter[i]->Reset((start_pos));                                              \
-  }                                                                           \
-  for (data_size_t i = start; i < end; ++i) {                                 \
-    int node = 0;                                                             \
-    while (node >= 0) {                                                       \
-      node = decision_fun(iter[(iter_idx)]->Get((data_idx)), node,            \
-                          default_bins[node], max_bins[node]);                \
-    }                                                                         \
-    score[(data_idx)] += static_cast<double>(leaf_value_[~node]);             \
-  }\
-
-
 #define PredictionFunLinear(niter, fidx_in_iter, start_pos, decision_fun,     \
                             iter_idx, data_idx)                               \
   std::vector<std::unique_ptr<BinIterator>> iter((niter));                    \
@@ -150,6 +135,70 @@ int Tree::SplitCategorical(int leaf, int feature, int real_feature, const uint32
 }\
 
 
+void Tree::AddPredictionToScoreByBlock(const Dataset* data, const data_size_t* used_data_indices,
+                                       data_size_t num_data, double* score) const {
+  const data_size_t kBlockSize = 4096;
+  Threading::For<data_size_t>(0, num_data, kBlockSize, [=](int, data_size_t start, data_size_t end) {
+    std::vector<data_size_t> indices(kBlockSize), left_indices(kBlockSize), right_indices(kBlockSize);
+    // nodes (or ~leaves) with the range of their rows in indices
+    struct NodeRange {
+      int node;
+      data_size_t begin;
+      data_size_t cnt;
+    };
+    std::vector<NodeRange> stack;
+    for (data_size_t block_start = start; block_start < end; block_start += kBlockSize) {
+      const data_size_t block_cnt = std::min(kBlockSize, end - block_start);
+      if (used_data_indices == nullptr) {
+        for (data_size_t i = 0; i < block_cnt; ++i) {
+          indices[i] = block_start + i;
+        }
+      } else {
+        std::copy(used_data_indices + block_start, used_data_indices + block_start + block_cnt, indices.begin());
+        // bins of sparse features are read forward only
+        if (!std::is_sorted(indices.begin(), indices.begin() + block_cnt)) {
+          std::sort(indices.begin(), indices.begin() + block_cnt);
+        }
+      }
+      stack.push_back({0, 0, block_cnt});
+      while (!stack.empty()) {
+        const int node = stack.back().node;
+        const data_size_t begin = stack.back().begin;
+        const data_size_t cnt = stack.back().cnt;
+        stack.pop_back();
+        data_size_t* node_indices = indices.data() + begin;
+        if (node < 0) {
+          const double output = static_cast<double>(leaf_value_[~node]);
+          for (data_size_t i = 0; i < cnt; ++i) {
+            score[node_indices[i]] += output;
+          }
+          continue;
+        }
+        // the same split of binned data as DataPartition::Split in training
+        data_size_t left_cnt = 0;
+        if (GetDecisionType(decision_type_[node], kCategoricalMask)) {
+          const int cat_idx = static_cast<int>(threshold_in_bin_[node]);
+          left_cnt = data->Split(split_feature_inner_[node], cat_threshold_inner_.data() + cat_boundaries_inner_[cat_idx],
+                                 cat_boundaries_inner_[cat_idx + 1] - cat_boundaries_inner_[cat_idx], false,
+                                 node_indices, cnt, left_indices.data(), right_indices.data());
+        } else {
+          left_cnt = data->Split(split_feature_inner_[node], &threshold_in_bin_[node], 1,
+                                 GetDecisionType(decision_type_[node], kDefaultLeftMask),
+                                 node_indices, cnt, left_indices.data(), right_indices.data());
+        }
+        std::copy(left_indices.begin(), left_indices.begin() + left_cnt, node_indices);
+        std::copy(right_indices.begin(), right_indices.begin() + (cnt - left_cnt), node_indices + left_cnt);
+        if (cnt - left_cnt > 0) {
+          stack.push_back({right_child_[node], begin + left_cnt, cnt - left_cnt});
+        }
+        if (left_cnt > 0) {
+          stack.push_back({left_child_[node], begin, left_cnt});
+        }
+      }
+    }
+  });
+}
+
 void Tree::AddPredictionToScore(const Dataset* data, data_size_t num_data, double* score) const {
   if (!is_linear_ && num_leaves_ <= 1) {
     if (leaf_value_[0] != 0.0f) {
@@ -160,15 +209,15 @@ void Tree::AddPredictionToScore(const Dataset* data, data_size_t num_data, doubl
     }
     return;
   }
-  std::vector<uint32_t> default_bins(num_leaves_ - 1);
-  std::vector<uint32_t> max_bins(num_leaves_ - 1);
-  for (int i = 0; i < num_leaves_ - 1; ++i) {
-    const int fidx = split_feature_inner_[i];
-    auto bin_mapper = data->FeatureBinMapper(fidx);
-    default_bins[i] = bin_mapper->GetDefaultBin();
-    max_bins[i] = bin_mapper->num_bin() - 1;
-  }
   if (is_linear_) {
+    std::vector<uint32_t> default_bins(num_leaves_ - 1);
+    std::vector<uint32_t> max_bins(num_leaves_ - 1);
+    for (int i = 0; i < num_leaves_ - 1; ++i) {
+      const int fidx = split_feature_inner_[i];
+      auto bin_mapper = data->FeatureBinMapper(fidx);
+      default_bins[i] = bin_mapper->GetDefaultBin();
+      max_bins[i] = bin_mapper->num_bin() - 1;
+    }
     std::vector<std::vector<const float*>> feat_ptr(num_leaves_);
     for (int leaf_num = 0; leaf_num < num_leaves_; ++leaf_num) {
       for (int feat : leaf_features_inner_[leaf_num]) {
@@ -201,31 +250,7 @@ void Tree::AddPredictionToScore(const Dataset* data, data_size_t num_data, doubl
       }
     }
   } else {
-    if (num_cat_ > 0) {
-      if (data->num_features() > num_leaves_ - 1) {
-        Threading::For<data_size_t>(0, num_data, 512, [this, &data, score, &default_bins, &max_bins]
-        (int, data_size_t start, data_size_t end) {
-          PredictionFun(num_leaves_ - 1, split_feature_inner_[i], start, DecisionInner, node, i);
-        });
-      } else {
-        Threading::For<data_size_t>(0, num_data, 512, [this, &data, score, &default_bins, &max_bins]
-        (int, data_size_t start, data_size_t end) {
-          PredictionFun(data->num_features(), i, start, DecisionInner, split_feature_inner_[node], i);
-        });
-      }
-    } else {
-      if (data->num_features() > num_leaves_ - 1) {
-        Threading::For<data_size_t>(0, num_data, 512, [this, &data, score, &default_bins, &max_bins]
-        (int, data_size_t start, data_size_t end) {
-          PredictionFun(num_leaves_ - 1, split_feature_inner_[i], start, NumericalDecisionInner, node, i);
-        });
-      } else {
-        Threading::For<data_size_t>(0, num_data, 512, [this, &data, score, &default_bins, &max_bins]
-        (int, data_size_t start, data_size_t end) {
-          PredictionFun(data->num_features(), i, start, NumericalDecisionInner, split_feature_inner_[node], i);
-        });
-      }
-    }
+    AddPredictionToScoreByBlock(data, nullptr, num_data, score);
   }
 }
 
@@ -241,15 +266,15 @@ void Tree::AddPredictionToScore(const Dataset* data,
     }
     return;
   }
-  std::vector<uint32_t> default_bins(num_leaves_ - 1);
-  std::vector<uint32_t> max_bins(num_leaves_ - 1);
-  for (int i = 0; i < num_leaves_ - 1; ++i) {
-    const int fidx = split_feature_inner_[i];
-    auto bin_mapper = data->FeatureBinMapper(fidx);
-    default_bins[i] = bin_mapper->GetDefaultBin();
-    max_bins[i] = bin_mapper->num_bin() - 1;
-  }
   if (is_linear_) {
+    std::vector<uint32_t> default_bins(num_leaves_ - 1);
+    std::vector<uint32_t> max_bins(num_leaves_ - 1);
+    for (int i = 0; i < num_leaves_ - 1; ++i) {
+      const int fidx = split_feature_inner_[i];
+      auto bin_mapper = data->FeatureBinMapper(fidx);
+      default_bins[i] = bin_mapper->GetDefaultBin();
+      max_bins[i] = bin_mapper->num_bin() - 1;
+    }
     std::vector<std::vector<const float*>> feat_ptr(num_leaves_);
     for (int leaf_num = 0; leaf_num < num_leaves_; ++leaf_num) {
       for (int feat : leaf_features_inner_[leaf_num]) {
@@ -285,35 +310,10 @@ void Tree::AddPredictionToScore(const Dataset* data,
       }
     }
   } else {
-    if (num_cat_ > 0) {
-      if (data->num_features() > num_leaves_ - 1) {
-        Threading::For<data_size_t>(0, num_data, 512, [this, &data, score, used_data_indices, &default_bins, &max_bins]
-        (int, data_size_t start, data_size_t end) {
-          PredictionFun(num_leaves_ - 1, split_feature_inner_[i], used_data_indices[start], DecisionInner, node, used_data_indices[i]);
-        });
-      } else {
-        Threading::For<data_size_t>(0, num_data, 512, [this, &data, score, used_data_indices, &default_bins, &max_bins]
-        (int, data_size_t start, data_size_t end) {
-          PredictionFun(data->num_features(), i, used_data_indices[start], DecisionInner, split_feature_inner_[node], used_data_indices[i]);
-        });
-      }
-    } else {
-      if (data->num_features() > num_leaves_ - 1) {
-        Threading::For<data_size_t>(0, num_data, 512, [this, &data, score, used_data_indices, &default_bins, &max_bins]
-        (int, data_size_t start, data_size_t end) {
-          PredictionFun(num_leaves_ - 1, split_feature_inner_[i], used_data_indices[start], NumericalDecisionInner, node, used_data_indices[i]);
-        });
-      } else {
-        Threading::For<data_size_t>(0, num_data, 512, [this, &data, score, used_data_indices, &default_bins, &max_bins]
-        (int, data_size_t start, data_size_t end) {
-          PredictionFun(data->num_features(), i, used_data_indices[start], NumericalDecisionInner, split_feature_inner_[node], used_data_indices[i]);
-        });
-      }
-    }
+    AddPredictionToScoreByBlock(data, used_data_indices, num_data, score);
   }
 }
 
-#undef PredictionFun
 #undef PredictionFunLinear
 
 double Tree::GetUpperBoundValue() const {
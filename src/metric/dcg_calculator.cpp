@@ -106,15 +106,37 @@ void DCGCalculator::CalMaxDCG(const std::vector<data_size_t>& ks,
   }
 }
 
-void DCGCalculator::CalDCG(const std::vector<data_size_t>& ks, const label_t* label,
-                           const double * score, data_size_t num_data, std::vector<double>* out) {
-  // get sorted indices by score
-  std::vector<data_size_t> sorted_idx(num_data);
+void DCGCalculator::SortTopK(data_size_t k, const double* score, data_size_t num_data,
+                             std::vector<data_size_t>* sorted_idx) {
+  auto& ref_sorted_idx = *sorted_idx;
+  ref_sorted_idx.resize(num_data);
   for (data_size_t i = 0; i < num_data; ++i) {
-    sorted_idx[i] = i;
+    ref_sorted_idx[i] = i;
+  }
+  // same order as a stable sort by descending score, with NaN scores last
+  auto cmp = [score](data_size_t a, data_size_t b) {
+    return IsRankedBefore(score[a], a, score[b], b);
+  };
+  if (k < num_data) {
+    std::nth_element(ref_sorted_idx.begin(), ref_sorted_idx.begin() + k, ref_sorted_idx.end(), cmp);
+    std::sort(ref_sorted_idx.begin(), ref_sorted_idx.begin() + k, cmp);
+  } else {
+    std::sort(ref_sorted_idx.begin(), ref_sorted_idx.end(), cmp);
   }
-  std::stable_sort(sorted_idx.begin(), sorted_idx.end(),
-                   [score](data_size_t a, data_size_t b) {return score[a] > score[b]; });
+}
+
+void DCGCalculator::CalDCG(const std::vector<data_size_t>& ks, const label_t* label,
+                           const double * score, data_size_t num_data, std::vector<double>* out) {
+  std::vector<data_size_t> sorted_idx;
+  CalDCG(ks, label, score, num_data, out, &sorted_idx);
+}
+
+void DCGCalculator::CalDCG(const std::vector<data_size_t>& ks, const label_t* label,
+                           const double * score, data_size_t num_data, std::vector<double>* out,
+                           std::vector<data_size_t>* sorted_idx) {
+  // only the top positions are needed
+  SortTopK(*std::max_element(ks.begin(), ks.end()), score, num_data, sorted_idx);
+  const data_size_t* top_idx = sorted_idx->data();
 
   double cur_result = 0.0f;
   data_size_t cur_left = 0;
@@ -123,7 +145,7 @@ void DCGCalculator::CalDCG(const std::vector<data_size_t>& ks, const label_t* la
     data_size_t cur_k = ks[i];
     if (cur_k > num_data) { cur_k = num_data; }
     for (data_size_t j = cur_left; j < cur_k; ++j) {
-      data_size_t idx = sorted_idx[j];
+      data_size_t idx = top_idx[j];
       cur_result += label_gain_[static_cast<int>(label[idx])] * discount_[j];
     }
     (*out)[i] = cur_result;
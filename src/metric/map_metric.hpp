@@ -71,15 +71,12 @@ class MapMetric:public Metric {
     return 1.0f;
   }
 
-  void CalMapAtK(std::vector<int> ks, data_size_t npos, const label_t* label,
-                 const double* score, data_size_t num_data, std::vector<double>* out) const {
-    // get sorted indices by score
-    std::vector<data_size_t> sorted_idx;
-    for (data_size_t i = 0; i < num_data; ++i) {
-      sorted_idx.emplace_back(i);
-    }
-    std::stable_sort(sorted_idx.begin(), sorted_idx.end(),
-                     [score](data_size_t a, data_size_t b) {return score[a] > score[b]; });
+  void CalMapAtK(const std::vector<int>& ks, data_size_t npos, const label_t* label,
+                 const double* score, data_size_t num_data, std::vector<double>* out,
+                 std::vector<data_size_t>* sorted_idx_buffer) const {
+    // get sorted indices by score, only the top positions are needed
+    DCGCalculator::SortTopK(*std::max_element(ks.begin(), ks.end()), score, num_data, sorted_idx_buffer);
+    const data_size_t* sorted_idx = sorted_idx_buffer->data();
 
     int num_hit = 0;
     double sum_ap = 0.0f;
@@ -103,39 +100,38 @@ class MapMetric:public Metric {
     }
   }
   std::vector<double> Eval(const double* score, const ObjectiveFunction*) const override {
-    // some buffers for multi-threading sum up
-    int num_threads = OMP_NUM_THREADS();
-    std::vector<std::vector<double>> result_buffer_;
-    for (int i = 0; i < num_threads; ++i) {
-      result_buffer_.emplace_back(eval_at_.size(), 0.0f);
-    }
-    std::vector<double> tmp_map(eval_at_.size(), 0.0f);
-    if (query_weights_ == nullptr) {
-      #pragma omp parallel for num_threads(OMP_NUM_THREADS()) schedule(guided) firstprivate(tmp_map)
-      for (data_size_t i = 0; i < num_queries_; ++i) {
-        const int tid = omp_get_thread_num();
-        CalMapAtK(eval_at_, npos_per_query_[i], label_ + query_boundaries_[i],
-                  score + query_boundaries_[i], query_boundaries_[i + 1] - query_boundaries_[i], &tmp_map);
-        for (size_t j = 0; j < eval_at_.size(); ++j) {
-          result_buffer_[tid][j] += tmp_map[j];
-        }
-      }
-    } else {
-      #pragma omp parallel for num_threads(OMP_NUM_THREADS()) schedule(guided) firstprivate(tmp_map)
-      for (data_size_t i = 0; i < num_queries_; ++i) {
-        const int tid = omp_get_thread_num();
+    // queries are evaluated in blocks scheduled dynamically, since their sizes differ.
+    // The blocks are summed up in order, so the result does not depend on the threads
+    const data_size_t block_size = 16;
+    const data_size_t num_blocks = (num_queries_ + block_size - 1) / block_size;
+    const size_t num_eval = eval_at_.size();
+    std::vector<double> block_results(static_cast<size_t>(num_blocks) * num_eval, 0.0f);
+    std::vector<double> tmp_map(num_eval, 0.0f);
+    std::vector<data_size_t> sorted_idx;
+    #pragma omp parallel for num_threads(OMP_NUM_THREADS()) schedule(dynamic) firstprivate(tmp_map) private(sorted_idx)
+    for (data_size_t block = 0; block < num_blocks; ++block) {
+      double* block_result = block_results.data() + static_cast<size_t>(block) * num_eval;
+      const data_size_t end = std::min(num_queries_, (block + 1) * block_size);
+      for (data_size_t i = block * block_size; i < end; ++i) {
         CalMapAtK(eval_at_, npos_per_query_[i], label_ + query_boundaries_[i],
-                  score + query_boundaries_[i], query_boundaries_[i + 1] - query_boundaries_[i], &tmp_map);
-        for (size_t j = 0; j < eval_at_.size(); ++j) {
-          result_buffer_[tid][j] += tmp_map[j] * query_weights_[i];
+                  score + query_boundaries_[i], query_boundaries_[i + 1] - query_boundaries_[i], &tmp_map,
+                  &sorted_idx);
+        if (query_weights_ == nullptr) {
+          for (size_t j = 0; j < num_eval; ++j) {
+            block_result[j] += tmp_map[j];
+          }
+        } else {
+          for (size_t j = 0; j < num_eval; ++j) {
+            block_result[j] += tmp_map[j] * query_weights_[i];
+          }
         }
       }
     }
     // Get final average MAP
-    std::vector<double> result(eval_at_.size(), 0.0f);
-    for (size_t j = 0; j < result.size(); ++j) {
-      for (int i = 0; i < num_threads; ++i) {
-        result[j] += result_buffer_[i][j];
+    std::vector<double> result(num_eval, 0.0f);
+    for (size_t j = 0; j < num_eval; ++j) {
+      for (data_size_t block = 0; block < num_blocks; ++block) {
+        result[j] += block_results[static_cast<size_t>(block) * num_eval + j];
       }
       result[j] /= sum_query_weights_;
     }
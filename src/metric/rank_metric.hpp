@@ -10,6 +10,7 @@
 #include <LightGBM/utils/log.h>
 #include <LightGBM/utils/openmp_wrapper.h>
 
+#include <algorithm>
 #include <string>
 #include <sstream>
 #include <vector>
@@ -84,59 +85,47 @@ class NDCGMetric:public Metric {
   }
 
   std::vector<double> Eval(const double* score, const ObjectiveFunction*) const override {
-    int num_threads = OMP_NUM_THREADS();
-    // some buffers for multi-threading sum up
-    std::vector<std::vector<double>> result_buffer_;
-    for (int i = 0; i < num_threads; ++i) {
-      result_buffer_.emplace_back(eval_at_.size(), 0.0f);
-    }
-    std::vector<double> tmp_dcg(eval_at_.size(), 0.0f);
-    if (query_weights_ == nullptr) {
-      #pragma omp parallel for num_threads(OMP_NUM_THREADS()) schedule(static) firstprivate(tmp_dcg)
-      for (data_size_t i = 0; i < num_queries_; ++i) {
-        const int tid = omp_get_thread_num();
-        // if all doc in this query are all negative, let its NDCG=1
-        if (inverse_max_dcgs_[i][0] <= 0.0f) {
-          for (size_t j = 0; j < eval_at_.size(); ++j) {
-            result_buffer_[tid][j] += 1.0f;
-          }
-        } else {
-          // calculate DCG
-          DCGCalculator::CalDCG(eval_at_, label_ + query_boundaries_[i],
-                                score + query_boundaries_[i],
-                                query_boundaries_[i + 1] - query_boundaries_[i], &tmp_dcg);
-          // calculate NDCG
-          for (size_t j = 0; j < eval_at_.size(); ++j) {
-            result_buffer_[tid][j] += tmp_dcg[j] * inverse_max_dcgs_[i][j];
-          }
-        }
-      }
-    } else {
-      #pragma omp parallel for num_threads(OMP_NUM_THREADS()) schedule(static) firstprivate(tmp_dcg)
-      for (data_size_t i = 0; i < num_queries_; ++i) {
-        const int tid = omp_get_thread_num();
+    // queries are evaluated in blocks scheduled dynamically, since their sizes differ.
+    // The blocks are summed up in order, so the result does not depend on the threads
+    const data_size_t block_size = 16;
+    const data_size_t num_blocks = (num_queries_ + block_size - 1) / block_size;
+    const size_t num_eval = eval_at_.size();
+    std::vector<double> block_results(static_cast<size_t>(num_blocks) * num_eval, 0.0f);
+    std::vector<double> tmp_dcg(num_eval, 0.0f);
+    std::vector<data_size_t> sorted_idx;
+    #pragma omp parallel for num_threads(OMP_NUM_THREADS()) schedule(dynamic) firstprivate(tmp_dcg) private(sorted_idx)
+    for (data_size_t block = 0; block < num_blocks; ++block) {
+      double* block_result = block_results.data() + static_cast<size_t>(block) * num_eval;
+      const data_size_t end = std::min(num_queries_, (block + 1) * block_size);
+      for (data_size_t i = block * block_size; i < end; ++i) {
         // if all doc in this query are all negative, let its NDCG=1
         if (inverse_max_dcgs_[i][0] <= 0.0f) {
-          for (size_t j = 0; j < eval_at_.size(); ++j) {
-            result_buffer_[tid][j] += 1.0f;
+          for (size_t j = 0; j < num_eval; ++j) {
+            block_result[j] += 1.0f;
           }
         } else {
           // calculate DCG
           DCGCalculator::CalDCG(eval_at_, label_ + query_boundaries_[i],
                                 score + query_boundaries_[i],
-                                query_boundaries_[i + 1] - query_boundaries_[i], &tmp_dcg);
+                                query_boundaries_[i + 1] - query_boundaries_[i], &tmp_dcg, &sorted_idx);
           // calculate NDCG
-          for (size_t j = 0; j < eval_at_.size(); ++j) {
-            result_buffer_[tid][j] += tmp_dcg[j] * inverse_max_dcgs_[i][j] * query_weights_[i];
+          if (query_weights_ == nullptr) {
+            for (size_t j = 0; j < num_eval; ++j) {
+              block_result[j] += tmp_dcg[j] * inverse_max_dcgs_[i][j];
+            }
+          } else {
+            for (size_t j = 0; j < num_eval; ++j) {
+              block_result[j] += tmp_dcg[j] * inverse_max_dcgs_[i][j] * query_weights_[i];
+            }
           }
         }
       }
     }
     // Get final average NDCG
-    std::vector<double> result(eval_at_.size(), 0.0f);
-    for (size_t j = 0; j < result.size(); ++j) {
-      for (int i = 0; i < num_threads; ++i) {
-        result[j] += result_buffer_[i][j];
+    std::vector<double> result(num_eval, 0.0f);
+    for (size_t j = 0; j < num_eval; ++j) {
+      for (data_size_t block = 0; block < num_blocks; ++block) {
+        result[j] += block_results[static_cast<size_t>(block) * num_eval + j];
       }
       result[j] /= sum_query_weights_;
     }
@@ -82,11 +82,10 @@ void Linkers::ParseMachineList(const std::string& machines, const std::string& f
   std::vector<std::string> lines;
   if (machines.empty()) {
     TextReader<size_t> machine_list_reader(filename.c_str(), false);
-    machine_list_reader.ReadAllLines();
-    if (machine_list_reader.Lines().empty()) {
+    machine_list_reader.ReadAllLines(&lines);
+    if (lines.empty()) {
       Log::Fatal("Machine list file %s doesn't exist", filename.c_str());
     }
-    lines = machine_list_reader.Lines();
   } else {
     lines = Common::Split(machines.c_str(), ',');
   }
@@ -62,10 +62,12 @@ class BinaryLogloss: public ObjectiveFunction {
     weights_ = metadata.weights();
     data_size_t cnt_positive = 0;
     data_size_t cnt_negative = 0;
+    label_is_pos_.resize(num_data_);
     // count for positive and negative samples
     #pragma omp parallel for num_threads(OMP_NUM_THREADS()) schedule(static) reduction(+:cnt_positive, cnt_negative)
     for (data_size_t i = 0; i < num_data_; ++i) {
-      if (is_pos_(label_[i])) {
+      label_is_pos_[i] = is_pos_(label_[i]);
+      if (label_is_pos_[i]) {
         ++cnt_positive;
       } else {
         ++cnt_negative;
@@ -110,7 +112,7 @@ class BinaryLogloss: public ObjectiveFunction {
       #pragma omp parallel for num_threads(OMP_NUM_THREADS()) schedule(static)
       for (data_size_t i = 0; i < num_data_; ++i) {
         // get label and label weights
-        const int is_pos = is_pos_(label_[i]);
+        const int is_pos = label_is_pos_[i];
         const int label = label_val_[is_pos];
         const double label_weight = label_weights_[is_pos];
         // calculate gradients and hessians
@@ -123,7 +125,7 @@ class BinaryLogloss: public ObjectiveFunction {
       #pragma omp parallel for num_threads(OMP_NUM_THREADS()) schedule(static)
       for (data_size_t i = 0; i < num_data_; ++i) {
         // get label and label weights
-        const int is_pos = is_pos_(label_[i]);
+        const int is_pos = label_is_pos_[i];
         const int label = label_val_[is_pos];
         const double label_weight = label_weights_[is_pos];
         // calculate gradients and hessians
@@ -142,14 +144,14 @@ class BinaryLogloss: public ObjectiveFunction {
     if (weights_ != nullptr) {
       #pragma omp parallel for num_threads(OMP_NUM_THREADS()) schedule(static) reduction(+:suml, sumw) if (!deterministic_)
       for (data_size_t i = 0; i < num_data_; ++i) {
-        suml += is_pos_(label_[i]) * weights_[i];
+        suml += label_is_pos_[i] * weights_[i];
         sumw += weights_[i];
       }
     } else {
       sumw = static_cast<double>(num_data_);
       #pragma omp parallel for num_threads(OMP_NUM_THREADS()) schedule(static) reduction(+:suml) if (!deterministic_)
       for (data_size_t i = 0; i < num_data_; ++i) {
-        suml += is_pos_(label_[i]);
+        suml += label_is_pos_[i];
       }
     }
     if (Network::num_machines() > 1) {
@@ -208,6 +210,8 @@ class BinaryLogloss: public ObjectiveFunction {
   const label_t* weights_;
   double scale_pos_weight_;
   std::function<bool(label_t)> is_pos_;
+  /*! \brief is_pos_ of each label, to avoid calling it for every gradient */
+  std::vector<int8_t> label_is_pos_;
   bool need_train_;
   const bool deterministic_;
 };
@@ -85,47 +85,9 @@ class MulticlassSoftmax: public ObjectiveFunction {
 
   void GetGradients(const double* score, score_t* gradients, score_t* hessians) const override {
     if (weights_ == nullptr) {
-      std::vector<double> rec;
-      #pragma omp parallel for num_threads(OMP_NUM_THREADS()) schedule(static) private(rec)
-      for (data_size_t i = 0; i < num_data_; ++i) {
-        rec.resize(num_class_);
-        for (int k = 0; k < num_class_; ++k) {
-          size_t idx = static_cast<size_t>(num_data_) * k + i;
-          rec[k] = static_cast<double>(score[idx]);
-        }
-        Common::Softmax(&rec);
-        for (int k = 0; k < num_class_; ++k) {
-          auto p = rec[k];
-          size_t idx = static_cast<size_t>(num_data_) * k + i;
-          if (label_int_[i] == k) {
-            gradients[idx] = static_cast<score_t>(p - 1.0f);
-          } else {
-            gradients[idx] = static_cast<score_t>(p);
-          }
-          hessians[idx] = static_cast<score_t>(factor_ * p * (1.0f - p));
-        }
-      }
+      GetGradientsInner<false>(score, gradients, hessians);
     } else {
-      std::vector<double> rec;
-      #pragma omp parallel for num_threads(OMP_NUM_THREADS()) schedule(static) private(rec)
-      for (data_size_t i = 0; i < num_data_; ++i) {
-        rec.resize(num_class_);
-        for (int k = 0; k < num_class_; ++k) {
-          size_t idx = static_cast<size_t>(num_data_) * k + i;
-          rec[k] = static_cast<double>(score[idx]);
-        }
-        Common::Softmax(&rec);
-        for (int k = 0; k < num_class_; ++k) {
-          auto p = rec[k];
-          size_t idx = static_cast<size_t>(num_data_) * k + i;
-          if (label_int_[i] == k) {
-            gradients[idx] = static_cast<score_t>((p - 1.0f) * weights_[i]);
-          } else {
-            gradients[idx] = static_cast<score_t>(p * weights_[i]);
-          }
-          hessians[idx] = static_cast<score_t>((factor_ * p * (1.0f - p))* weights_[i]);
-        }
-      }
+      GetGradientsInner<true>(score, gradients, hessians);
     }
   }
 
@@ -166,6 +128,66 @@ class MulticlassSoftmax: public ObjectiveFunction {
   }
 
  protected:
+  /*!
+  * \brief Gradients of blocks of rows, the scores and gradients of each class are accessed sequentially in a block.
+  *        The softmax of each row is computed in the same order as Common::Softmax
+  */
+  template <bool USE_WEIGHTS>
+  void GetGradientsInner(const double* score, score_t* gradients, score_t* hessians) const {
+    const data_size_t block_size = 512;
+    const data_size_t num_block = (num_data_ + block_size - 1) / block_size;
+    std::vector<double> prob, wmax, wsum;
+    #pragma omp parallel for num_threads(OMP_NUM_THREADS()) schedule(static) private(prob, wmax, wsum)
+    for (data_size_t block = 0; block < num_block; ++block) {
+      prob.resize(static_cast<size_t>(block_size) * num_class_);
+      wmax.resize(block_size);
+      wsum.resize(block_size);
+      const data_size_t start = block * block_size;
+      const data_size_t cnt = std::min(block_size, num_data_ - start);
+      std::copy(score + start, score + start + cnt, wmax.begin());
+      for (int k = 1; k < num_class_; ++k) {
+        const double* class_score = score + static_cast<size_t>(num_data_) * k + start;
+        for (data_size_t j = 0; j < cnt; ++j) {
+          wmax[j] = std::max(class_score[j], wmax[j]);
+        }
+      }
+      std::fill(wsum.begin(), wsum.begin() + cnt, 0.0f);
+      for (int k = 0; k < num_class_; ++k) {
+        const double* class_score = score + static_cast<size_t>(num_data_) * k + start;
+        double* class_prob = prob.data() + static_cast<size_t>(block_size) * k;
+        for (data_size_t j = 0; j < cnt; ++j) {
+          class_prob[j] = std::exp(class_score[j] - wmax[j]);
+          wsum[j] += class_prob[j];
+        }
+      }
+      for (int k = 0; k < num_class_; ++k) {
+        double* class_prob = prob.data() + static_cast<size_t>(block_size) * k;
+        const size_t offset = static_cast<size_t>(num_data_) * k + start;
+        for (data_size_t j = 0; j < cnt; ++j) {
+          const double p = class_prob[j] / wsum[j];
+          class_prob[j] = p;
+          if (USE_WEIGHTS) {
+            gradients[offset + j] = static_cast<score_t>(p * weights_[start + j]);
+            hessians[offset + j] = static_cast<score_t>((factor_ * p * (1.0f - p)) * weights_[start + j]);
+          } else {
+            gradients[offset + j] = static_cast<score_t>(p);
+            hessians[offset + j] = static_cast<score_t>(factor_ * p * (1.0f - p));
+          }
+        }
+      }
+      for (data_size_t j = 0; j < cnt; ++j) {
+        const int k = label_int_[start + j];
+        const double p = prob[static_cast<size_t>(block_size) * k + j];
+        const size_t idx = static_cast<size_t>(num_data_) * k + start + j;
+        if (USE_WEIGHTS) {
+          gradients[idx] = static_cast<score_t>((p - 1.0f) * weights_[start + j]);
+        } else {
+          gradients[idx] = static_cast<score_t>(p - 1.0f);
+        }
+      }
+    }
+  }
+
   double factor_;
   /*! \brief Number of data */
   data_size_t num_data_;
@@ -15,6 +15,7 @@
 #include <cstring>
 #include <limits>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace LightGBM {
@@ -58,14 +59,15 @@ class RankingObjective : public ObjectiveFunction {
 
   void GetGradients(const double* score, score_t* gradients,
                     score_t* hessians) const override {
-#pragma omp parallel for num_threads(OMP_NUM_THREADS()) schedule(guided)
+    std::vector<double> score_adjusted;
+#pragma omp parallel for num_threads(OMP_NUM_THREADS()) schedule(guided) private(score_adjusted)
     for (data_size_t i = 0; i < num_queries_; ++i) {
       const data_size_t start = query_boundaries_[i];
       const data_size_t cnt = query_boundaries_[i + 1] - query_boundaries_[i];
-      std::vector<double> score_adjusted;
       if (num_position_ids_ > 0) {
+        score_adjusted.resize(cnt);
         for (data_size_t j = 0; j < cnt; ++j) {
-          score_adjusted.push_back(score[start + j] + pos_biases_[positions_[start + j]]);
+          score_adjusted[j] = score[start + j] + pos_biases_[positions_[start + j]];
         }
       }
       GetGradientsForOneQuery(i, cnt, label_ + start, num_position_ids_ > 0 ? score_adjusted.data() : score + start,
@@ -171,56 +173,72 @@ class LambdarankNDCG : public RankingObjective {
     ConstructSigmoidTable();
   }
 
+  void GetGradients(const double* score, score_t* gradients,
+                    score_t* hessians) const override {
+    query_buffers_.resize(OMP_NUM_THREADS());
+    RankingObjective::GetGradients(score, gradients, hessians);
+  }
+
   inline void GetGradientsForOneQuery(data_size_t query_id, data_size_t cnt,
                                       const label_t* label, const double* score,
                                       score_t* lambdas,
                                       score_t* hessians) const override {
     // get max DCG on current query
     const double inverse_max_dcg = inverse_max_dcgs_[query_id];
-    // initialize with zero
+    QueryBuffer& buffer = query_buffers_[omp_get_thread_num()];
+    // get sorted scores, ties are kept in their order like a stable sort and NaN scores are last.
+    // Every document is paired with one above the truncation level, so all of them are sorted
+    auto& sorted = buffer.sorted_score_idx;
+    sorted.resize(cnt);
     for (data_size_t i = 0; i < cnt; ++i) {
-      lambdas[i] = 0.0f;
-      hessians[i] = 0.0f;
+      sorted[i] = std::make_pair(score[i], i);
     }
-    // get sorted indices for scores
-    std::vector<data_size_t> sorted_idx(cnt);
+    std::sort(sorted.begin(), sorted.end(),
+              [](const std::pair<double, data_size_t>& a, const std::pair<double, data_size_t>& b) {
+                return DCGCalculator::IsRankedBefore(a.first, a.second, b.first, b.second);
+              });
+    // labels and lambdas in sorted order, so that the pairs are read sequentially
+    buffer.sorted_score.resize(cnt);
+    buffer.sorted_label.resize(cnt);
+    buffer.sorted_lambdas.assign(cnt, 0.0f);
+    buffer.sorted_hessians.assign(cnt, 0.0f);
+    double* sorted_score = buffer.sorted_score.data();
+    label_t* sorted_label = buffer.sorted_label.data();
+    score_t* sorted_lambdas = buffer.sorted_lambdas.data();
+    score_t* sorted_hessians = buffer.sorted_hessians.data();
     for (data_size_t i = 0; i < cnt; ++i) {
-      sorted_idx[i] = i;
+      sorted_score[i] = sorted[i].first;
+      sorted_label[i] = label[sorted[i].second];
     }
-    std::stable_sort(
-        sorted_idx.begin(), sorted_idx.end(),
-        [score](data_size_t a, data_size_t b) { return score[a] > score[b]; });
     // get best and worst score
-    const double best_score = score[sorted_idx[0]];
+    const double best_score = sorted_score[0];
     data_size_t worst_idx = cnt - 1;
-    if (worst_idx > 0 && score[sorted_idx[worst_idx]] == kMinScore) {
+    if (worst_idx > 0 && sorted_score[worst_idx] == kMinScore) {
       worst_idx -= 1;
     }
-    const double worst_score = score[sorted_idx[worst_idx]];
+    const double worst_score = sorted_score[worst_idx];
     double sum_lambdas = 0.0;
     // start accmulate lambdas by pairs that contain at least one document above truncation level
     for (data_size_t i = 0; i < cnt - 1 && i < truncation_level_; ++i) {
-      if (score[sorted_idx[i]] == kMinScore) { continue; }
+      if (sorted_score[i] == kMinScore) { continue; }
       for (data_size_t j = i + 1; j < cnt; ++j) {
-        if (score[sorted_idx[j]] == kMinScore) { continue; }
+        if (sorted_score[j] == kMinScore) { continue; }
         // skip pairs with the same labels
-        if (label[sorted_idx[i]] == label[sorted_idx[j]]) { continue; }
+        if (sorted_label[i] == sorted_label[j]) { continue; }
         data_size_t high_rank, low_rank;
-        if (label[sorted_idx[i]] > label[sorted_idx[j]]) {
+        if (sorted_label[i] > sorted_label[j]) {
           high_rank = i;
           low_rank = j;
         } else {
           high_rank = j;
           low_rank = i;
         }
-        const data_size_t high = sorted_idx[high_rank];
-        const int high_label = static_cast<int>(label[high]);
-        const double high_score = score[high];
+        const int high_label = static_cast<int>(sorted_label[high_rank]);
+        const double high_score = sorted_score[high_rank];
         const double high_label_gain = label_gain_[high_label];
         const double high_discount = DCGCalculator::GetDiscount(high_rank);
-        const data_size_t low = sorted_idx[low_rank];
-        const int low_label = static_cast<int>(label[low]);
-        const double low_score = score[low];
+        const int low_label = static_cast<int>(sorted_label[low_rank]);
+        const double low_score = sorted_score[low_rank];
         const double low_label_gain = label_gain_[low_label];
         const double low_discount = DCGCalculator::GetDiscount(low_rank);
 
@@ -242,10 +260,10 @@ class LambdarankNDCG : public RankingObjective {
         // update
         p_lambda *= -sigmoid_ * delta_pair_NDCG;
         p_hessian *= sigmoid_ * sigmoid_ * delta_pair_NDCG;
-        lambdas[low] -= static_cast<score_t>(p_lambda);
-        hessians[low] += static_cast<score_t>(p_hessian);
-        lambdas[high] += static_cast<score_t>(p_lambda);
-        hessians[high] += static_cast<score_t>(p_hessian);
+        sorted_lambdas[low_rank] -= static_cast<score_t>(p_lambda);
+        sorted_hessians[low_rank] += static_cast<score_t>(p_hessian);
+        sorted_lambdas[high_rank] += static_cast<score_t>(p_lambda);
+        sorted_hessians[high_rank] += static_cast<score_t>(p_hessian);
         // lambda is negative, so use minus to accumulate
         sum_lambdas -= 2 * p_lambda;
       }
@@ -253,8 +271,13 @@ class LambdarankNDCG : public RankingObjective {
     if (norm_ && sum_lambdas > 0) {
       double norm_factor = std::log2(1 + sum_lambdas) / sum_lambdas;
       for (data_size_t i = 0; i < cnt; ++i) {
-        lambdas[i] = static_cast<score_t>(lambdas[i] * norm_factor);
-        hessians[i] = static_cast<score_t>(hessians[i] * norm_factor);
+        lambdas[sorted[i].second] = static_cast<score_t>(sorted_lambdas[i] * norm_factor);
+        hessians[sorted[i].second] = static_cast<score_t>(sorted_hessians[i] * norm_factor);
+      }
+    } else {
+      for (data_size_t i = 0; i < cnt; ++i) {
+        lambdas[sorted[i].second] = sorted_lambdas[i];
+        hessians[sorted[i].second] = sorted_hessians[i];
       }
     }
   }
@@ -343,6 +366,15 @@ class LambdarankNDCG : public RankingObjective {
       message_stream.str("");
     }
   }
+  /*! \brief Scratch buffers of a thread, reused by its queries */
+  struct QueryBuffer {
+    std::vector<std::pair<double, data_size_t>> sorted_score_idx;
+    std::vector<double> sorted_score;
+    std::vector<label_t> sorted_label;
+    std::vector<score_t> sorted_lambdas;
+    std::vector<score_t> sorted_hessians;
+  };
+  mutable std::vector<QueryBuffer> query_buffers_;
   /*! \brief Sigmoid param */
   double sigmoid_;
   /*! \brief Normalize the lambdas or not */
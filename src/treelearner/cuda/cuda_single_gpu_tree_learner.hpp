@@ -40,6 +40,14 @@ class CUDASingleGPUTreeLearner: public SerialTreeLearner {
 
   void AddPredictionToScore(const Tree* tree, double* out_score) const override;
 
+  // validation scores are updated by the CUDA trees
+  void AddValidData(const Dataset* /*valid_data*/) override {}
+
+  bool AddPredictionToValidScore(int /*valid_idx*/, const Tree* /*tree*/, data_size_t /*num_data*/,
+                                 double* /*out_score*/) const override {
+    return false;
+  }
+
   void RenewTreeOutput(Tree* tree, const ObjectiveFunction* obj, std::function<double(const label_t*, int)> residual_getter,
                        data_size_t total_num_data, const data_size_t* bag_indices, data_size_t bag_cnt, const double* train_score) const override;
 
@@ -330,9 +330,10 @@ void DataParallelTreeLearner<TREELEARNER_T>::FindBestSplitsFromHistograms(const
   }
 
   OMP_INIT_EX();
-  #pragma omp parallel for num_threads(OMP_NUM_THREADS()) schedule(static)
-  for (int feature_index = 0; feature_index < this->num_features_; ++feature_index) {
+  #pragma omp parallel for num_threads(OMP_NUM_THREADS()) schedule(dynamic)
+  for (int i = 0; i < this->num_features_; ++i) {
     OMP_LOOP_EX_BEGIN();
+    const int feature_index = this->features_by_cost_[i];
     if (!is_feature_aggregated_[feature_index]) continue;
     const int tid = omp_get_thread_num();
     const int real_feature_index = this->train_data_->RealFeatureIndex(feature_index);
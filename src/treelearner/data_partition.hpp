@@ -12,6 +12,7 @@
 
 #include <algorithm>
 #include <cstring>
+#include <functional>
 #include <vector>
 
 namespace LightGBM {
@@ -97,23 +98,38 @@ class DataPartition {
   * \param feature_bins feature bin data
   * \param threshold threshold that want to split
   * \param right_leaf index of right leaf
+  * \param placed_fun If not nullptr, called with the ranges of indices of the smaller leaf
+  *        (the right one on ties), and their positions in all indices, as soon as they are placed
+  * \param is_placed_smaller_only If false, placed_fun is called for the indices of both leaves
   */
   void Split(int leaf, const Dataset* dataset, int feature,
              const uint32_t* threshold, int num_threshold, bool default_left,
-             int right_leaf) {
+             int right_leaf,
+             const std::function<void(const data_size_t*, data_size_t, data_size_t)>& placed_fun = nullptr,
+             bool is_placed_smaller_only = true) {
     Common::FunctionTimer fun_timer("DataPartition::Split", global_timer);
     // get leaf boundary
     const data_size_t begin = leaf_begin_[leaf];
     const data_size_t cnt = leaf_count_[leaf];
     auto left_start = indices_.data() + begin;
-    const auto left_cnt = runner_.Run<false>(
+    std::function<void(data_size_t, data_size_t, data_size_t)> runner_placed_fun = nullptr;
+    if (placed_fun != nullptr) {
+      runner_placed_fun = [=, &placed_fun](data_size_t start, data_size_t cur_cnt, data_size_t left_cnt) {
+        const bool is_left_smaller = left_cnt < cnt - left_cnt;
+        if (cur_cnt > 0 && (!is_placed_smaller_only || (start < left_cnt) == is_left_smaller)) {
+          placed_fun(left_start + start, cur_cnt, begin + start);
+        }
+      };
+    }
+    // Dataset::Split reads the indices of the leaf in order from left_start, so they can be partitioned in place
+    const auto left_cnt = runner_.Run<false, true>(
         cnt,
         [=](int, data_size_t cur_start, data_size_t cur_cnt, data_size_t* left,
             data_size_t* right) {
           return dataset->Split(feature, threshold, num_threshold, default_left,
                                 left_start + cur_start, cur_cnt, left, right);
         },
-        left_start);
+        left_start, runner_placed_fun);
     leaf_count_[leaf] = left_cnt;
     leaf_begin_[right_leaf] = left_cnt + begin;
     leaf_count_[right_leaf] = cnt - left_cnt;
@@ -145,6 +161,9 @@ class DataPartition {
 
   const data_size_t* indices() const { return indices_.data(); }
 
+  /*! \brief Get number of data */
+  data_size_t num_data() const { return num_data_; }
+
   /*! \brief Get number of leaves */
   int num_leaves() const { return num_leaves_; }
 
@@ -1397,6 +1397,7 @@ class HistogramPool {
       mapper_.resize(total_size_);
       inverse_mapper_.resize(cache_size_);
       last_used_time_.resize(cache_size_);
+      slot_num_data_.resize(cache_size_);
       ResetMap();
     }
   }
@@ -1410,6 +1411,7 @@ class HistogramPool {
       std::fill(mapper_.begin(), mapper_.end(), -1);
       std::fill(inverse_mapper_.begin(), inverse_mapper_.end(), -1);
       std::fill(last_used_time_.begin(), last_used_time_.end(), 0);
+      std::fill(slot_num_data_.begin(), slot_num_data_.end(), 0);
     }
   }
   template <bool USE_DATA, bool USE_CONFIG>
@@ -1526,10 +1528,11 @@ class HistogramPool {
    * \brief Get data for the specific index
    * \param idx which index want to get
    * \param out output data will store into this
+   * \param num_data Number of data in the leaf of this index, histograms of larger leaves are kept longer
    * \return True if this index is in the pool, False if this index is not in
    * the pool
    */
-  bool Get(int idx, FeatureHistogram** out) {
+  bool Get(int idx, FeatureHistogram** out, data_size_t num_data = 0) {
     if (is_enough_) {
       *out = pool_[idx].get();
       return true;
@@ -1537,12 +1540,29 @@ class HistogramPool {
       int slot = mapper_[idx];
       *out = pool_[slot].get();
       last_used_time_[slot] = ++cur_time_;
+      slot_num_data_[slot] = num_data;
       return true;
     } else {
-      // choose the least used slot
-      int slot = static_cast<int>(ArrayArgs<int>::ArgMin(last_used_time_));
+      // choose an unused slot, or the slot of the smallest leaf since it is the cheapest to construct again,
+      // and the least used one among them. The two latest used slots are kept for the current split
+      int slot = -1;
+      data_size_t slot_cnt = 0;
+      for (int i = 0; i < cache_size_; ++i) {
+        if (last_used_time_[i] > 0 && last_used_time_[i] >= cur_time_ - 1) {
+          continue;
+        }
+        const data_size_t cnt = inverse_mapper_[i] < 0 ? -1 : slot_num_data_[i];
+        if (slot < 0 || cnt < slot_cnt || (cnt == slot_cnt && last_used_time_[i] < last_used_time_[slot])) {
+          slot = i;
+          slot_cnt = cnt;
+        }
+      }
+      if (slot < 0) {
+        slot = static_cast<int>(ArrayArgs<int>::ArgMin(last_used_time_));
+      }
       *out = pool_[slot].get();
       last_used_time_[slot] = ++cur_time_;
+      slot_num_data_[slot] = num_data;
 
       // reset previous mapper
       if (inverse_mapper_[slot] >= 0) mapper_[inverse_mapper_[slot]] = -1;
@@ -1554,12 +1574,22 @@ class HistogramPool {
     }
   }
 
+  /*!
+   * \brief Check whether the histograms of an index are in the pool, without updating it
+   * \param idx
+   * \return True if this index is in the pool
+   */
+  bool Contains(int idx) const {
+    return is_enough_ || mapper_[idx] >= 0;
+  }
+
   /*!
    * \brief Move data from one index to another index
    * \param src_idx
    * \param dst_idx
+   * \param num_data Number of data in the leaf of dst_idx
    */
-  void Move(int src_idx, int dst_idx) {
+  void Move(int src_idx, int dst_idx, data_size_t num_data = 0) {
     if (is_enough_) {
       std::swap(pool_[src_idx], pool_[dst_idx]);
       return;
@@ -1575,6 +1605,7 @@ class HistogramPool {
     // move to dst idx
     mapper_[dst_idx] = slot;
     last_used_time_[slot] = ++cur_time_;
+    slot_num_data_[slot] = num_data;
     inverse_mapper_[slot] = dst_idx;
   }
 
@@ -1590,6 +1621,7 @@ class HistogramPool {
   std::vector<int> mapper_;
   std::vector<int> inverse_mapper_;
   std::vector<int> last_used_time_;
+  std::vector<data_size_t> slot_num_data_;
   int cur_time_ = 0;
 };
 
@@ -377,20 +377,20 @@ void GPUTreeLearner::AllocateGPUMemory() {
       BinIterator* bin_iters[8];
       for (int s_idx = 0; s_idx < 8; ++s_idx) {
         bin_iters[s_idx] = train_data_->FeatureGroupIterator(dense_ind[s_idx]);
-        if (dynamic_cast<DenseBinIterator<uint8_t, true>*>(bin_iters[s_idx]) == 0) {
+        if (dynamic_cast<DenseBinIterator<uint8_t, 4>*>(bin_iters[s_idx]) == 0) {
           Log::Fatal("GPU tree learner assumes that all bins are Dense4bitsBin when num_bin <= 16, but feature %d is not", dense_ind[s_idx]);
         }
       }
       // this guarantees that the RawGet() function is inlined, rather than using virtual function dispatching
-      DenseBinIterator<uint8_t, true> iters[8] = {
-        *static_cast<DenseBinIterator<uint8_t, true>*>(bin_iters[0]),
-        *static_cast<DenseBinIterator<uint8_t, true>*>(bin_iters[1]),
-        *static_cast<DenseBinIterator<uint8_t, true>*>(bin_iters[2]),
-        *static_cast<DenseBinIterator<uint8_t, true>*>(bin_iters[3]),
-        *static_cast<DenseBinIterator<uint8_t, true>*>(bin_iters[4]),
-        *static_cast<DenseBinIterator<uint8_t, true>*>(bin_iters[5]),
-        *static_cast<DenseBinIterator<uint8_t, true>*>(bin_iters[6]),
-        *static_cast<DenseBinIterator<uint8_t, true>*>(bin_iters[7])};
+      DenseBinIterator<uint8_t, 4> iters[8] = {
+        *static_cast<DenseBinIterator<uint8_t, 4>*>(bin_iters[0]),
+        *static_cast<DenseBinIterator<uint8_t, 4>*>(bin_iters[1]),
+        *static_cast<DenseBinIterator<uint8_t, 4>*>(bin_iters[2]),
+        *static_cast<DenseBinIterator<uint8_t, 4>*>(bin_iters[3]),
+        *static_cast<DenseBinIterator<uint8_t, 4>*>(bin_iters[4]),
+        *static_cast<DenseBinIterator<uint8_t, 4>*>(bin_iters[5]),
+        *static_cast<DenseBinIterator<uint8_t, 4>*>(bin_iters[6]),
+        *static_cast<DenseBinIterator<uint8_t, 4>*>(bin_iters[7])};
       for (int j = 0; j < num_data_; ++j) {
         host4[j].s[0] = (uint8_t)((iters[0].RawGet(j) * dev_bin_mult[0] + ((j+0) & (dev_bin_mult[0] - 1)))
                       |((iters[1].RawGet(j) * dev_bin_mult[1] + ((j+1) & (dev_bin_mult[1] - 1))) << 4));
@@ -406,15 +406,15 @@ void GPUTreeLearner::AllocateGPUMemory() {
       for (int s_idx = 0; s_idx < 4; ++s_idx) {
         BinIterator* bin_iter = train_data_->FeatureGroupIterator(dense_ind[s_idx]);
         // this guarantees that the RawGet() function is inlined, rather than using virtual function dispatching
-        if (dynamic_cast<DenseBinIterator<uint8_t, false>*>(bin_iter) != 0) {
+        if (dynamic_cast<DenseBinIterator<uint8_t, 0>*>(bin_iter) != 0) {
           // Dense bin
-          DenseBinIterator<uint8_t, false> iter = *static_cast<DenseBinIterator<uint8_t, false>*>(bin_iter);
+          DenseBinIterator<uint8_t, 0> iter = *static_cast<DenseBinIterator<uint8_t, 0>*>(bin_iter);
           for (int j = 0; j < num_data_; ++j) {
             host4[j].s[s_idx] = (uint8_t)(iter.RawGet(j) * dev_bin_mult[s_idx] + ((j+s_idx) & (dev_bin_mult[s_idx] - 1)));
           }
-        } else if (dynamic_cast<DenseBinIterator<uint8_t, true>*>(bin_iter) != 0) {
+        } else if (dynamic_cast<DenseBinIterator<uint8_t, 4>*>(bin_iter) != 0) {
           // Dense 4-bit bin
-          DenseBinIterator<uint8_t, true> iter = *static_cast<DenseBinIterator<uint8_t, true>*>(bin_iter);
+          DenseBinIterator<uint8_t, 4> iter = *static_cast<DenseBinIterator<uint8_t, 4>*>(bin_iter);
           for (int j = 0; j < num_data_; ++j) {
             host4[j].s[s_idx] = (uint8_t)(iter.RawGet(j) * dev_bin_mult[s_idx] + ((j+s_idx) & (dev_bin_mult[s_idx] - 1)));
           }
@@ -449,8 +449,8 @@ void GPUTreeLearner::AllocateGPUMemory() {
     for (int i = 0; i < k; ++i) {
       if (dword_features_ == 8) {
         BinIterator* bin_iter = train_data_->FeatureGroupIterator(dense_dword_ind[i]);
-        if (dynamic_cast<DenseBinIterator<uint8_t, true>*>(bin_iter) != 0) {
-          DenseBinIterator<uint8_t, true> iter = *static_cast<DenseBinIterator<uint8_t, true>*>(bin_iter);
+        if (dynamic_cast<DenseBinIterator<uint8_t, 4>*>(bin_iter) != 0) {
+          DenseBinIterator<uint8_t, 4> iter = *static_cast<DenseBinIterator<uint8_t, 4>*>(bin_iter);
           #pragma omp parallel for num_threads(OMP_NUM_THREADS()) schedule(static)
           for (int j = 0; j < num_data_; ++j) {
             host4[j].s[i >> 1] |= (uint8_t)((iter.RawGet(j) * device_bin_mults_[copied_feature4 * dword_features_ + i]
@@ -462,15 +462,15 @@ void GPUTreeLearner::AllocateGPUMemory() {
         }
       } else if (dword_features_ == 4) {
         BinIterator* bin_iter = train_data_->FeatureGroupIterator(dense_dword_ind[i]);
-        if (dynamic_cast<DenseBinIterator<uint8_t, false>*>(bin_iter) != 0) {
-          DenseBinIterator<uint8_t, false> iter = *static_cast<DenseBinIterator<uint8_t, false>*>(bin_iter);
+        if (dynamic_cast<DenseBinIterator<uint8_t, 0>*>(bin_iter) != 0) {
+          DenseBinIterator<uint8_t, 0> iter = *static_cast<DenseBinIterator<uint8_t, 0>*>(bin_iter);
           #pragma omp parallel for num_threads(OMP_NUM_THREADS()) schedule(static)
           for (int j = 0; j < num_data_; ++j) {
             host4[j].s[i] = (uint8_t)(iter.RawGet(j) * device_bin_mults_[copied_feature4 * dword_features_ + i]
                           + ((j+i) & (device_bin_mults_[copied_feature4 * dword_features_ + i] - 1)));
           }
-        } else if (dynamic_cast<DenseBinIterator<uint8_t, true>*>(bin_iter) != 0) {
-          DenseBinIterator<uint8_t, true> iter = *static_cast<DenseBinIterator<uint8_t, true>*>(bin_iter);
+        } else if (dynamic_cast<DenseBinIterator<uint8_t, 4>*>(bin_iter) != 0) {
+          DenseBinIterator<uint8_t, 4> iter = *static_cast<DenseBinIterator<uint8_t, 4>*>(bin_iter);
           #pragma omp parallel for num_threads(OMP_NUM_THREADS()) schedule(static)
           for (int j = 0; j < num_data_; ++j) {
             host4[j].s[i] = (uint8_t)(iter.RawGet(j) * device_bin_mults_[copied_feature4 * dword_features_ + i]
@@ -971,6 +971,8 @@ bool GPUTreeLearner::ConstructGPUHistogramsAsync(
 }
 
 void GPUTreeLearner::ConstructHistograms(const std::vector<int8_t>& is_feature_used, bool use_subtract) {
+  // the ordered buffers are also used to copy gradients to the GPU, from offset 0
+  share_state_->ordered_indices = nullptr;
   std::vector<int8_t> is_sparse_feature_used(num_features_, 0);
   std::vector<int8_t> is_dense_feature_used(num_features_, 0);
   #pragma omp parallel for num_threads(OMP_NUM_THREADS()) schedule(static)
@@ -36,6 +36,14 @@ class LinearTreeLearner: public SerialTreeLearner {
   Tree* FitByExistingTree(const Tree* old_tree, const std::vector<int>& leaf_pred,
                           const score_t* gradients, const score_t* hessians) const override;
 
+  // linear trees are scored on validation data from the raw feature values, no partition is kept for them
+  void AddValidData(const Dataset* /*valid_data*/) override {}
+
+  bool AddPredictionToValidScore(int /*valid_idx*/, const Tree* /*tree*/, data_size_t /*num_data*/,
+                                 double* /*out_score*/) const override {
+    return false;
+  }
+
   void AddPredictionToScore(const Tree* tree,
                             double* out_score) const override {
     CHECK_LE(tree->num_leaves(), data_partition_->num_leaves());
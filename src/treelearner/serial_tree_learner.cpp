@@ -10,6 +10,8 @@
 #include <LightGBM/utils/common.h>
 
 #include <algorithm>
+#include <cmath>
+#include <functional>
 #include <queue>
 #include <set>
 #include <unordered_map>
@@ -36,9 +38,11 @@ void SerialTreeLearner::Init(const Dataset* train_data, bool is_constant_hessian
   if (config_->histogram_pool_size <= 0) {
     max_cache_size = config_->num_leaves;
   } else {
+    // quantized histograms are cached as packed integers, half the size of float histograms
+    const size_t hist_entry_size = config_->use_quantized_grad ? kInt32HistEntrySize : kHistEntrySize;
     size_t total_histogram_size = 0;
     for (int i = 0; i < train_data_->num_features(); ++i) {
-      total_histogram_size += kHistEntrySize * train_data_->FeatureNumBin(i);
+      total_histogram_size += hist_entry_size * train_data_->FeatureNumBin(i);
     }
     max_cache_size = static_cast<int>(config_->histogram_pool_size * 1024 * 1024 / total_histogram_size);
   }
@@ -57,6 +61,7 @@ void SerialTreeLearner::Init(const Dataset* train_data, bool is_constant_hessian
   // initialize data partition
   data_partition_.reset(new DataPartition(num_data_, config_->num_leaves));
   col_sampler_.SetTrainingData(train_data_);
+  SortFeaturesByCost();
   // initialize ordered gradients and hessians
   ordered_gradients_.resize(num_data_);
   ordered_hessians_.resize(num_data_);
@@ -86,31 +91,52 @@ void SerialTreeLearner::GetShareStates(const Dataset* dataset,
       share_state_.reset(dataset->GetShareStates<true, 32>(
         reinterpret_cast<score_t*>(gradient_discretizer_->ordered_int_gradients_and_hessians()), nullptr,
         col_sampler_.is_feature_used_bytree(), is_constant_hessian,
-        config_->force_col_wise, config_->force_row_wise, config_->num_grad_quant_bins));
+        config_->force_col_wise, config_->force_row_wise, config_->num_grad_quant_bins,
+        config_->row_wise_cache_size));
     } else {
       share_state_.reset(dataset->GetShareStates<false, 0>(
           ordered_gradients_.data(), ordered_hessians_.data(),
           col_sampler_.is_feature_used_bytree(), is_constant_hessian,
-          config_->force_col_wise, config_->force_row_wise, config_->num_grad_quant_bins));
+          config_->force_col_wise, config_->force_row_wise, config_->num_grad_quant_bins,
+          config_->row_wise_cache_size));
     }
   } else {
     CHECK_NOTNULL(share_state_);
-    // cannot change is_hist_col_wise during training
+    // cannot change is_hist_col_wise during training, unless both row-wise and col-wise are kept
+    const bool force_col_wise = share_state_->is_col_wise && share_state_->row_wise_state() == nullptr;
+    const bool force_row_wise = !share_state_->is_col_wise;
     if (config_->use_quantized_grad) {
       share_state_.reset(dataset->GetShareStates<true, 32>(
           reinterpret_cast<score_t*>(gradient_discretizer_->ordered_int_gradients_and_hessians()), nullptr,
           col_sampler_.is_feature_used_bytree(), is_constant_hessian,
-          share_state_->is_col_wise, !share_state_->is_col_wise, config_->num_grad_quant_bins));
+          force_col_wise, force_row_wise, config_->num_grad_quant_bins, config_->row_wise_cache_size));
     } else {
       share_state_.reset(dataset->GetShareStates<false, 0>(
           ordered_gradients_.data(), ordered_hessians_.data(), col_sampler_.is_feature_used_bytree(),
-          is_constant_hessian, share_state_->is_col_wise,
-          !share_state_->is_col_wise, config_->num_grad_quant_bins));
+          is_constant_hessian, force_col_wise, force_row_wise, config_->num_grad_quant_bins,
+          config_->row_wise_cache_size));
     }
   }
   CHECK_NOTNULL(share_state_);
 }
 
+void SerialTreeLearner::SortFeaturesByCost() {
+  // the time of fixing, subtracting and scanning a histogram grows with its number of bins,
+  // categorical features also sort their bins, so the costly features are started first
+  std::vector<double> costs(num_features_);
+  features_by_cost_.resize(num_features_);
+  for (int i = 0; i < num_features_; ++i) {
+    const BinMapper* bin_mapper = train_data_->FeatureBinMapper(i);
+    costs[i] = bin_mapper->num_bin();
+    if (bin_mapper->bin_type() == BinType::CategoricalBin) {
+      costs[i] *= std::log2(bin_mapper->num_bin() + 1.0) + 1.0;
+    }
+    features_by_cost_[i] = i;
+  }
+  std::stable_sort(features_by_cost_.begin(), features_by_cost_.end(),
+                   [&costs](int a, int b) { return costs[a] > costs[b]; });
+}
+
 void SerialTreeLearner::ResetTrainingDataInner(const Dataset* train_data,
                                                bool is_constant_hessian,
                                                bool reset_multi_val_bin) {
@@ -145,9 +171,10 @@ void SerialTreeLearner::ResetConfig(const Config* config) {
     if (config->histogram_pool_size <= 0) {
       max_cache_size = config_->num_leaves;
     } else {
+      const size_t hist_entry_size = config_->use_quantized_grad ? kInt32HistEntrySize : kHistEntrySize;
       size_t total_histogram_size = 0;
       for (int i = 0; i < train_data_->num_features(); ++i) {
-        total_histogram_size += kHistEntrySize * train_data_->FeatureNumBin(i);
+        total_histogram_size += hist_entry_size * train_data_->FeatureNumBin(i);
       }
       max_cache_size = static_cast<int>(config_->histogram_pool_size * 1024 * 1024 / total_histogram_size);
     }
@@ -162,6 +189,9 @@ void SerialTreeLearner::ResetConfig(const Config* config) {
     // push split information for all leaves
     best_split_per_leaf_.resize(config_->num_leaves);
     data_partition_->ResetLeaves(config_->num_leaves);
+    for (auto& partition : valid_partitions_) {
+      partition->ResetLeaves(config_->num_leaves);
+    }
   } else {
     config_ = config;
   }
@@ -283,11 +313,15 @@ void SerialTreeLearner::BeforeTrain() {
   Common::FunctionTimer fun_timer("SerialTreeLearner::BeforeTrain", global_timer);
   // reset histogram pool
   histogram_pool_.ResetMap();
+  share_state_->ordered_indices = nullptr;
 
   col_sampler_.ResetByTree();
   train_data_->InitTrain(col_sampler_.is_feature_used_bytree(), share_state_.get());
   // initialize data partition
   data_partition_->Init();
+  for (auto& partition : valid_partitions_) {
+    partition->Init();
+  }
 
   constraints_->Reset();
 
@@ -358,17 +392,21 @@ bool SerialTreeLearner::BeforeFindBestSplit(const Tree* tree, int left_leaf, int
   parent_leaf_histogram_array_ = nullptr;
   // only have root
   if (right_leaf < 0) {
-    histogram_pool_.Get(left_leaf, &smaller_leaf_histogram_array_);
+    histogram_pool_.Get(left_leaf, &smaller_leaf_histogram_array_, num_data_in_left_child);
     larger_leaf_histogram_array_ = nullptr;
   } else if (num_data_in_left_child < num_data_in_right_child) {
     // put parent(left) leaf's histograms into larger leaf's histograms
-    if (histogram_pool_.Get(left_leaf, &larger_leaf_histogram_array_)) { parent_leaf_histogram_array_ = larger_leaf_histogram_array_; }
-    histogram_pool_.Move(left_leaf, right_leaf);
-    histogram_pool_.Get(left_leaf, &smaller_leaf_histogram_array_);
+    if (histogram_pool_.Get(left_leaf, &larger_leaf_histogram_array_, num_data_in_right_child)) {
+      parent_leaf_histogram_array_ = larger_leaf_histogram_array_;
+    }
+    histogram_pool_.Move(left_leaf, right_leaf, num_data_in_right_child);
+    histogram_pool_.Get(left_leaf, &smaller_leaf_histogram_array_, num_data_in_left_child);
   } else {
     // put parent(left) leaf's histograms to larger leaf's histograms
-    if (histogram_pool_.Get(left_leaf, &larger_leaf_histogram_array_)) { parent_leaf_histogram_array_ = larger_leaf_histogram_array_; }
-    histogram_pool_.Get(right_leaf, &smaller_leaf_histogram_array_);
+    if (histogram_pool_.Get(left_leaf, &larger_leaf_histogram_array_, num_data_in_left_child)) {
+      parent_leaf_histogram_array_ = larger_leaf_histogram_array_;
+    }
+    histogram_pool_.Get(right_leaf, &smaller_leaf_histogram_array_, num_data_in_right_child);
   }
   return true;
 }
@@ -399,6 +437,15 @@ void SerialTreeLearner::ConstructHistograms(
     const std::vector<int8_t>& is_feature_used, bool use_subtract) {
   Common::FunctionTimer fun_timer("SerialTreeLearner::ConstructHistograms",
                                   global_timer);
+  // out-of-core datasets read the groups of the used features ahead, while histograms of earlier groups are built
+  train_data_->PrefetchFeatureGroups(is_feature_used);
+  // the ordered gradients of a leaf are at the positions of its indices, see SplitInner
+  auto ordered_offset = [this](const LeafSplits* leaf_splits) {
+    return leaf_splits->data_indices() == nullptr ? 0 :
+           static_cast<data_size_t>(leaf_splits->data_indices() - data_partition_->indices());
+  };
+  const data_size_t smaller_leaf_offset = ordered_offset(smaller_leaf_splits_.get());
+  const data_size_t larger_leaf_offset = ordered_offset(larger_leaf_splits_.get());
   // construct smaller leaf
   if (config_->use_quantized_grad) {
     const uint8_t smaller_leaf_num_bits = gradient_discretizer_->GetHistBitsInLeaf<false>(smaller_leaf_splits_->leaf_index());
@@ -411,7 +458,8 @@ void SerialTreeLearner::ConstructHistograms(
       smaller_leaf_splits_->num_data_in_leaf(), \
       reinterpret_cast<const score_t*>(gradient_discretizer_->discretized_gradients_and_hessians()), \
       nullptr, \
-      reinterpret_cast<score_t*>(gradient_discretizer_->ordered_int_gradients_and_hessians()), \
+      reinterpret_cast<score_t*>(reinterpret_cast<int16_t*>( \
+          gradient_discretizer_->ordered_int_gradients_and_hessians()) + smaller_leaf_offset), \
       nullptr, \
       share_state_.get(), \
       reinterpret_cast<hist_t*>(ptr_smaller_leaf_hist_data)
@@ -432,7 +480,8 @@ void SerialTreeLearner::ConstructHistograms(
         larger_leaf_splits_->num_data_in_leaf(), \
         reinterpret_cast<const score_t*>(gradient_discretizer_->discretized_gradients_and_hessians()), \
         nullptr, \
-        reinterpret_cast<score_t*>(gradient_discretizer_->ordered_int_gradients_and_hessians()), \
+        reinterpret_cast<score_t*>(reinterpret_cast<int16_t*>( \
+            gradient_discretizer_->ordered_int_gradients_and_hessians()) + larger_leaf_offset), \
         nullptr, \
         share_state_.get(), \
         reinterpret_cast<hist_t*>(ptr_larger_leaf_hist_data)
@@ -449,7 +498,8 @@ void SerialTreeLearner::ConstructHistograms(
     train_data_->ConstructHistograms<false, 0>(
         is_feature_used, smaller_leaf_splits_->data_indices(),
         smaller_leaf_splits_->num_data_in_leaf(), gradients_, hessians_,
-        ordered_gradients_.data(), ordered_hessians_.data(), share_state_.get(),
+        ordered_gradients_.data() + smaller_leaf_offset, ordered_hessians_.data() + smaller_leaf_offset,
+        share_state_.get(),
         ptr_smaller_leaf_hist_data);
     if (larger_leaf_histogram_array_ != nullptr && !use_subtract) {
       // construct larger leaf
@@ -458,10 +508,12 @@ void SerialTreeLearner::ConstructHistograms(
       train_data_->ConstructHistograms<false, 0>(
           is_feature_used, larger_leaf_splits_->data_indices(),
           larger_leaf_splits_->num_data_in_leaf(), gradients_, hessians_,
-          ordered_gradients_.data(), ordered_hessians_.data(), share_state_.get(),
+          ordered_gradients_.data() + larger_leaf_offset, ordered_hessians_.data() + larger_leaf_offset,
+          share_state_.get(),
           ptr_larger_leaf_hist_data);
     }
   }
+  share_state_->ordered_indices = nullptr;
 }
 
 void SerialTreeLearner::FindBestSplitsFromHistograms(
@@ -502,9 +554,10 @@ void SerialTreeLearner::FindBestSplitsFromHistograms(
 
   OMP_INIT_EX();
 // find splits
-#pragma omp parallel for schedule(static) num_threads(share_state_->num_threads)
-  for (int feature_index = 0; feature_index < num_features_; ++feature_index) {
+#pragma omp parallel for schedule(dynamic) num_threads(share_state_->num_threads)
+  for (int i = 0; i < num_features_; ++i) {
     OMP_LOOP_EX_BEGIN();
+    const int feature_index = features_by_cost_[i];
     if (!is_feature_used[feature_index]) {
       continue;
     }
@@ -770,6 +823,43 @@ void SerialTreeLearner::SplitInner(Tree* tree, int best_leaf, int* left_leaf,
   constraints_->BeforeSplit(best_leaf, next_leaf_id,
                             best_split_info.monotone_type);
 
+  // gather the gradients of the smaller leaf for its col-wise histograms, while its indices are placed,
+  // and of the larger leaf too when it cannot subtract from the parent histograms.
+  // They are gathered at the positions of the indices, so that both leaves fit
+  std::function<void(const data_size_t*, data_size_t, data_size_t)> gather_fun = nullptr;
+  const bool is_last_split = tree->num_leaves() + 1 >= config_->num_leaves;
+  const bool is_max_depth = config_->max_depth > 0 && tree->leaf_depth(best_leaf) + 1 >= config_->max_depth;
+  const bool is_gather_larger = !histogram_pool_.Contains(best_leaf);
+  if (share_state_->is_col_wise && share_state_->row_wise_state() == nullptr && !is_last_split && !is_max_depth) {
+    if (config_->use_quantized_grad) {
+      const int16_t* gradients_and_hessians =
+          reinterpret_cast<const int16_t*>(gradient_discretizer_->discretized_gradients_and_hessians());
+      int16_t* ordered_gradients_and_hessians =
+          reinterpret_cast<int16_t*>(gradient_discretizer_->ordered_int_gradients_and_hessians());
+      gather_fun = [=](const data_size_t* indices, data_size_t cnt, data_size_t pos) {
+        for (data_size_t i = 0; i < cnt; ++i) {
+          ordered_gradients_and_hessians[pos + i] = gradients_and_hessians[indices[i]];
+        }
+      };
+    } else {
+      const bool use_hessian = !share_state_->is_constant_hessian;
+      gather_fun = [=](const data_size_t* indices, data_size_t cnt, data_size_t pos) {
+        score_t* ordered_gradients = ordered_gradients_.data() + pos;
+        score_t* ordered_hessians = ordered_hessians_.data() + pos;
+        if (use_hessian) {
+          for (data_size_t i = 0; i < cnt; ++i) {
+            ordered_gradients[i] = gradients_[indices[i]];
+            ordered_hessians[i] = hessians_[indices[i]];
+          }
+        } else {
+          for (data_size_t i = 0; i < cnt; ++i) {
+            ordered_gradients[i] = gradients_[indices[i]];
+          }
+        }
+      };
+    }
+  }
+
   bool is_numerical_split =
       train_data_->FeatureBinMapper(inner_feature_index)->bin_type() ==
       BinType::NumericalBin;
@@ -778,7 +868,13 @@ void SerialTreeLearner::SplitInner(Tree* tree, int best_leaf, int* left_leaf,
         inner_feature_index, best_split_info.threshold);
     data_partition_->Split(best_leaf, train_data_, inner_feature_index,
                            &best_split_info.threshold, 1,
-                           best_split_info.default_left, next_leaf_id);
+                           best_split_info.default_left, next_leaf_id, gather_fun,
+                           !is_gather_larger);
+    for (size_t i = 0; i < valid_partitions_.size(); ++i) {
+      valid_partitions_[i]->Split(best_leaf, valid_data_[i], inner_feature_index,
+                                  &best_split_info.threshold, 1,
+                                  best_split_info.default_left, next_leaf_id);
+    }
     if (update_cnt) {
       // don't need to update this in data-based parallel model
       best_split_info.left_count = data_partition_->leaf_count(*left_leaf);
@@ -813,7 +909,14 @@ void SerialTreeLearner::SplitInner(Tree* tree, int best_leaf, int* left_leaf,
     data_partition_->Split(best_leaf, train_data_, inner_feature_index,
                            cat_bitset_inner.data(),
                            static_cast<int>(cat_bitset_inner.size()),
-                           best_split_info.default_left, next_leaf_id);
+                           best_split_info.default_left, next_leaf_id, gather_fun,
+                           !is_gather_larger);
+    for (size_t i = 0; i < valid_partitions_.size(); ++i) {
+      valid_partitions_[i]->Split(best_leaf, valid_data_[i], inner_feature_index,
+                                  cat_bitset_inner.data(),
+                                  static_cast<int>(cat_bitset_inner.size()),
+                                  best_split_info.default_left, next_leaf_id);
+    }
 
     if (update_cnt) {
       // don't need to update this in data-based parallel model
@@ -840,6 +943,21 @@ void SerialTreeLearner::SplitInner(Tree* tree, int best_leaf, int* left_leaf,
   CHECK(*right_leaf == next_leaf_id);
 #endif
 
+  if (gather_fun != nullptr) {
+    const data_size_t left_cnt = data_partition_->leaf_count(*left_leaf);
+    const data_size_t right_cnt = data_partition_->leaf_count(*right_leaf);
+    if (is_gather_larger) {
+      share_state_->ordered_indices = data_partition_->GetIndexOnLeaf(*left_leaf, &share_state_->ordered_indices_cnt);
+      share_state_->ordered_indices_cnt += right_cnt;
+    } else {
+      const int gathered_leaf = left_cnt < right_cnt ? *left_leaf : *right_leaf;
+      share_state_->ordered_indices = data_partition_->GetIndexOnLeaf(gathered_leaf, &share_state_->ordered_indices_cnt);
+    }
+  } else {
+    // the gradients gathered for an earlier split are at positions that this split may have moved
+    share_state_->ordered_indices = nullptr;
+  }
+
   // init the leaves that used on next iteration
   if (!config_->use_quantized_grad) {
     if (best_split_info.left_count < best_split_info.right_count) {
@@ -1012,7 +1130,7 @@ double SerialTreeLearner::GetParentOutput(const Tree* tree, const LeafSplits* le
 
 void SerialTreeLearner::RecomputeBestSplitForLeaf(Tree* tree, int leaf, SplitInfo* split) {
   FeatureHistogram* histogram_array_;
-  if (!histogram_pool_.Get(leaf, &histogram_array_)) {
+  if (!histogram_pool_.Get(leaf, &histogram_array_, data_partition_->leaf_count(leaf))) {
     Log::Warning(
         "Get historical Histogram for leaf %d failed, will skip the "
         "``RecomputeBestSplitForLeaf``",
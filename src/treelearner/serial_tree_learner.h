@@ -99,19 +99,28 @@ class SerialTreeLearner: public TreeLearner {
 
   void AddPredictionToScore(const Tree* tree,
                             double* out_score) const override {
-    CHECK_LE(tree->num_leaves(), data_partition_->num_leaves());
     if (tree->num_leaves() <= 1) {
       return;
     }
-#pragma omp parallel for num_threads(OMP_NUM_THREADS()) schedule(static, 1)
-    for (int i = 0; i < tree->num_leaves(); ++i) {
-      double output = static_cast<double>(tree->LeafOutput(i));
-      data_size_t cnt_leaf_data = 0;
-      auto tmp_idx = data_partition_->GetIndexOnLeaf(i, &cnt_leaf_data);
-      for (data_size_t j = 0; j < cnt_leaf_data; ++j) {
-        out_score[tmp_idx[j]] += output;
-      }
+    AddLeafOutputToScore(tree, data_partition_.get(), out_score);
+  }
+
+  void AddValidData(const Dataset* valid_data) override {
+    valid_data_.push_back(valid_data);
+    valid_partitions_.emplace_back(new DataPartition(valid_data->num_data(), config_->num_leaves));
+  }
+
+  bool AddPredictionToValidScore(int valid_idx, const Tree* tree, data_size_t num_data,
+                                 double* out_score) const override {
+    // linear trees need the raw feature values
+    if (tree->num_leaves() <= 1 || tree->is_linear()) {
+      return false;
     }
+    CHECK_GE(valid_idx, 0);
+    CHECK_LT(static_cast<size_t>(valid_idx), valid_partitions_.size());
+    CHECK_EQ(valid_partitions_[valid_idx]->num_data(), num_data);
+    AddLeafOutputToScore(tree, valid_partitions_[valid_idx].get(), out_score);
+    return true;
   }
 
   void RenewTreeOutput(Tree* tree, const ObjectiveFunction* obj, std::function<double(const label_t*, int)> residual_getter,
@@ -130,8 +139,25 @@ class SerialTreeLearner: public TreeLearner {
 
   void GetShareStates(const Dataset* dataset, bool is_constant_hessian, bool is_first_time);
 
+  /*! \brief Order features by the cost of finding their best split */
+  void SortFeaturesByCost();
+
   void RecomputeBestSplitForLeaf(Tree* tree, int leaf, SplitInfo* split);
 
+  /*! \brief Add the output of each leaf to the score of the data partitioned on it */
+  static void AddLeafOutputToScore(const Tree* tree, const DataPartition* partition, double* out_score) {
+    CHECK_LE(tree->num_leaves(), partition->num_leaves());
+#pragma omp parallel for num_threads(OMP_NUM_THREADS()) schedule(static, 1)
+    for (int i = 0; i < tree->num_leaves(); ++i) {
+      double output = static_cast<double>(tree->LeafOutput(i));
+      data_size_t cnt_leaf_data = 0;
+      auto tmp_idx = partition->GetIndexOnLeaf(i, &cnt_leaf_data);
+      for (data_size_t j = 0; j < cnt_leaf_data; ++j) {
+        out_score[tmp_idx[j]] += output;
+      }
+    }
+  }
+
   /*!
   * \brief Some initial works before training
   */
@@ -194,6 +220,10 @@ class SerialTreeLearner: public TreeLearner {
   const score_t* hessians_;
   /*! \brief training data partition on leaves */
   std::unique_ptr<DataPartition> data_partition_;
+  /*! \brief validation data */
+  std::vector<const Dataset*> valid_data_;
+  /*! \brief validation data partition on leaves, split along with training data */
+  std::vector<std::unique_ptr<DataPartition>> valid_partitions_;
   /*! \brief pointer to histograms array of parent of current leaves */
   FeatureHistogram* parent_leaf_histogram_array_;
   /*! \brief pointer to histograms array of smaller leaf */
@@ -204,6 +234,8 @@ class SerialTreeLearner: public TreeLearner {
   std::vector<SplitInfo> best_split_per_leaf_;
   /*! \brief store best split per feature for all leaves */
   std::vector<SplitInfo> splits_per_leaf_;
+  /*! \brief feature indices in descending order of split finding cost, for dynamic scheduling */
+  std::vector<int> features_by_cost_;
   /*! \brief stores minimum and maximum constraints for each leaf */
   std::unique_ptr<LeafConstraintsBase> constraints_;
 
@@ -402,9 +402,10 @@ void VotingParallelTreeLearner<TREELEARNER_T>::FindBestSplitsFromHistograms(cons
   double larger_leaf_parent_output = this->GetParentOutput(tree, this->larger_leaf_splits_global_.get());
   // find best split from local aggregated histograms
   OMP_INIT_EX();
-#pragma omp parallel for schedule(static) num_threads(this->share_state_->num_threads)
-  for (int feature_index = 0; feature_index < this->num_features_; ++feature_index) {
+#pragma omp parallel for schedule(dynamic) num_threads(this->share_state_->num_threads)
+  for (int i = 0; i < this->num_features_; ++i) {
     OMP_LOOP_EX_BEGIN();
+    const int feature_index = this->features_by_cost_[i];
     const int tid = omp_get_thread_num();
     const int real_feature_index = this->train_data_->RealFeatureIndex(feature_index);
     if (smaller_is_feature_aggregated_[feature_index]) {
@@ -339,3 +339,51 @@ TEST_F(ArrowChunkedArrayTest, OffsetAndValidity) {
 
   arr.release(&arr);
 }
+
+TEST_F(ArrowChunkedArrayTest, CopyChunk) {
+  std::vector<float> dat1 = {0, 1, 2, 3, 4, 5, 6};
+  auto arr1 = create_primitive_array(dat1, 2, {2, 3});
+  std::vector<float> dat2 = {7, 8, 9};
+  auto arr2 = create_primitive_array(dat2);
+  auto schema = create_primitive_schema<float>();
+
+  ArrowArray arrs[2] = {arr1, arr2};
+  ArrowChunkedArray ca(2, arrs, &schema);
+  ASSERT_EQ(ca.get_num_chunks(), 2);
+  ASSERT_EQ(ca.get_chunk_offset(1), 5);
+  ASSERT_EQ(ca.get_chunk_offset(2), 8);
+
+  // Values must match the iterator, chunk by chunk
+  std::vector<double> values;
+  for (int64_t k = 0; k < ca.get_num_chunks(); ++k) {
+    std::vector<double> chunk(ca.get_chunk_offset(k + 1) - ca.get_chunk_offset(k));
+    ca.copy_chunk(k, chunk.data());
+    values.insert(values.end(), chunk.begin(), chunk.end());
+  }
+  ASSERT_EQ(values.size(), 8);
+  auto it = ca.begin<double>();
+  for (size_t i = 0; i < values.size(); ++i, ++it) {
+    if (std::isnan(*it)) {
+      ASSERT_TRUE(std::isnan(values[i]));
+    } else {
+      ASSERT_EQ(values[i], *it);
+    }
+  }
+  ASSERT_TRUE(std::isnan(values[0]));
+  ASSERT_EQ(values[2], 4);
+  ASSERT_EQ(values[7], 9);
+}
+
+TEST_F(ArrowChunkedArrayTest, CopyBooleanChunk) {
+  std::vector<bool> dat = {false, false, true, true, false, true, false, true, true, true};
+  auto arr = create_primitive_array(dat, 1, {4});
+  auto schema = create_primitive_schema<bool>();
+  ArrowChunkedArray ca(1, &arr, &schema);
+
+  std::vector<float> values(ca.get_length());
+  ca.copy_chunk(0, values.data());
+  ASSERT_EQ(values[0], 0);
+  ASSERT_EQ(values[1], 1);
+  ASSERT_TRUE(std::isnan(values[3]));
+  ASSERT_EQ(values[8], 1);
+}
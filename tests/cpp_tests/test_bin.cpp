@@ -0,0 +1,323 @@
+/*!
+ * Copyright (c) 2024 Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License. See LICENSE file in the project root for license information.
+ */
+
+#include <gtest/gtest.h>
+#include <testutils.h>
+#include <LightGBM/bin.h>
+#include <LightGBM/utils/random.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+using LightGBM::Bin;
+using LightGBM::BinMapper;
+using LightGBM::BinType;
+using LightGBM::TestUtils;
+
+namespace {
+
+void ExpectBatchMatchesScalar(BinType bin_type, int max_bin, bool with_nan) {
+  LightGBM::Random rand(42);
+  std::vector<double> sample;
+  for (int i = 0; i < 5000; ++i) {
+    if (bin_type == BinType::CategoricalBin) {
+      sample.push_back(rand.NextShort(0, 50));
+    } else if (with_nan && i % 13 == 0) {
+      sample.push_back(std::numeric_limits<double>::quiet_NaN());
+    } else {
+      sample.push_back(rand.NextFloat() * 100 - 20);
+    }
+  }
+  BinMapper bin_mapper;
+  bin_mapper.FindBin(sample.data(), static_cast<int>(sample.size()), sample.size(), max_bin, 3, 0, false,
+                     bin_type, true, false, {});
+
+  std::vector<double> values = sample;
+  values.push_back(0.0);
+  values.push_back(-1e300);
+  values.push_back(1e300);
+  values.push_back(-1);
+  values.push_back(std::numeric_limits<double>::quiet_NaN());
+  std::vector<uint32_t> bins(values.size());
+  // an odd count also covers the partial block of lanes
+  bin_mapper.ValueToBin(values.data(), static_cast<int>(values.size()), bins.data());
+  for (size_t i = 0; i < values.size(); ++i) {
+    ASSERT_EQ(bin_mapper.ValueToBin(values[i]), bins[i]) << "value " << values[i];
+  }
+}
+
+void ExpectHistogramsMatchReference(int num_bin, LightGBM::data_size_t num_data) {
+  using LightGBM::data_size_t;
+  using LightGBM::hist_t;
+  using LightGBM::score_t;
+  LightGBM::Random rand(7);
+  std::unique_ptr<Bin> bin(Bin::CreateDenseBin(num_data, num_bin));
+  std::vector<uint32_t> bins(num_data);
+  for (data_size_t i = 0; i < num_data; ++i) {
+    // long runs of the same bin are the case the sub-histograms are for
+    bins[i] = (i % 7 < 4) ? 1 : static_cast<uint32_t>(rand.NextShort(0, num_bin));
+    bin->Push(0, i, bins[i]);
+  }
+  bin->FinishLoad();
+  std::vector<data_size_t> indices;
+  for (data_size_t i = 0; i < num_data; i += 1 + i % 3) {
+    indices.push_back(i);
+  }
+  const data_size_t num_indices = static_cast<data_size_t>(indices.size());
+
+  std::vector<score_t> gradients, hessians;
+  TestUtils::CreateRandomGradients(num_data, 8, &gradients, &hessians);
+  std::vector<int16_t> int_gradients(num_data);
+  for (data_size_t i = 0; i < num_data; ++i) {
+    const int8_t g = static_cast<int8_t>(rand.NextShort(-5, 5));
+    const uint8_t h = static_cast<uint8_t>(rand.NextShort(0, 5));
+    int_gradients[i] = static_cast<int16_t>((g * 256) | h);
+  }
+  std::vector<score_t> ordered_gradients(num_indices), ordered_hessians(num_indices);
+  std::vector<int16_t> ordered_int_gradients(num_indices);
+  for (data_size_t i = 0; i < num_indices; ++i) {
+    ordered_gradients[i] = gradients[indices[i]];
+    ordered_hessians[i] = hessians[indices[i]];
+    ordered_int_gradients[i] = int_gradients[indices[i]];
+  }
+
+  // one extra bin on each side must stay untouched
+  const int size = (num_bin + 2) * 2;
+  for (bool use_indices : {false, true}) {
+    const data_size_t cnt = use_indices ? num_indices : num_data;
+    std::vector<hist_t> expected(size, 0.0);
+    std::vector<int64_t> expected_int(size, 0);
+    std::vector<LightGBM::hist_cnt_t> expected_cnt(size, 0);
+    for (data_size_t i = 0; i < cnt; ++i) {
+      const data_size_t idx = use_indices ? indices[i] : i;
+      const int ti = (bins[idx] + 1) * 2;
+      expected[ti] += gradients[idx];
+      expected[ti + 1] += hessians[idx];
+      ++expected_cnt[ti + 1];
+      expected_int[ti] += int_gradients[idx] >> 8;
+      expected_int[ti + 1] += int_gradients[idx] & 0xff;
+    }
+    const score_t* grad = use_indices ? ordered_gradients.data() : gradients.data();
+    const score_t* hess = use_indices ? ordered_hessians.data() : hessians.data();
+    const score_t* int_grad = reinterpret_cast<const score_t*>(
+        use_indices ? ordered_int_gradients.data() : int_gradients.data());
+
+    std::vector<hist_t> out(size, 0.0);
+    if (use_indices) {
+      bin->ConstructHistogram(indices.data(), 0, cnt, grad, hess, out.data() + 2);
+    } else {
+      bin->ConstructHistogram(0, cnt, grad, hess, out.data() + 2);
+    }
+    EXPECT_EQ(expected, out);
+
+    // constant hessian, the counts are stored in place of the hessians
+    std::fill(out.begin(), out.end(), 0.0);
+    if (use_indices) {
+      bin->ConstructHistogram(indices.data(), 0, cnt, grad, out.data() + 2);
+    } else {
+      bin->ConstructHistogram(0, cnt, grad, out.data() + 2);
+    }
+    for (int j = 0; j < size; j += 2) {
+      EXPECT_EQ(expected[j], out[j]) << "bin " << j / 2 - 1;
+      EXPECT_EQ(expected_cnt[j + 1], reinterpret_cast<const LightGBM::hist_cnt_t*>(out.data())[j + 1])
+          << "bin " << j / 2 - 1;
+    }
+
+    std::vector<int32_t> out_int(size, 0);
+    hist_t* out_int_ptr = reinterpret_cast<hist_t*>(out_int.data() + 1);
+    if (use_indices) {
+      bin->ConstructHistogramInt16(indices.data(), 0, cnt, int_grad, nullptr, out_int_ptr);
+    } else {
+      bin->ConstructHistogramInt16(0, cnt, int_grad, nullptr, out_int_ptr);
+    }
+    for (int j = 0; j < size; j += 2) {
+      const int32_t packed = out_int[j / 2];
+      EXPECT_EQ(expected_int[j], packed >> 16) << "bin " << j / 2;
+      EXPECT_EQ(expected_int[j + 1], packed & 0xffff) << "bin " << j / 2;
+    }
+  }
+}
+
+}  // namespace
+
+TEST(DenseBin, ConstructHistogram) {
+  for (int num_bin : {2, 3, 4, 10, 16, 200}) {
+    // both below and above the row count where sub-histograms are used
+    for (LightGBM::data_size_t num_data : {101, 3001, 10000}) {
+      ExpectHistogramsMatchReference(num_bin, num_data);
+    }
+  }
+}
+
+TEST(DenseBin, PackedBinsMatchUnpacked) {
+  using LightGBM::data_size_t;
+  const data_size_t num_data = 1003;
+  for (int num_bin : {2, 3, 4, 16}) {
+    LightGBM::Random rand(num_bin);
+    std::unique_ptr<Bin> packed(Bin::CreateDenseBin(num_data, num_bin));
+    std::unique_ptr<Bin> unpacked(Bin::CreateDenseBin(num_data, 256));
+    for (data_size_t i = 0; i < num_data; ++i) {
+      const uint32_t bin = static_cast<uint32_t>(rand.NextShort(0, num_bin));
+      packed->Push(0, i, bin);
+      unpacked->Push(0, i, bin);
+    }
+    packed->FinishLoad();
+    unpacked->FinishLoad();
+
+    std::vector<data_size_t> indices;
+    for (data_size_t i = 0; i < num_data; i += 1 + i % 5) {
+      indices.push_back(i);
+    }
+    const data_size_t num_indices = static_cast<data_size_t>(indices.size());
+    std::unique_ptr<Bin> subset(Bin::CreateDenseBin(num_indices, num_bin));
+    subset->CopySubrow(packed.get(), indices.data(), num_indices);
+    // FinishLoad must keep the copied bins
+    subset->FinishLoad();
+    std::unique_ptr<Bin> loaded(Bin::CreateDenseBin(num_indices, num_bin));
+    loaded->LoadFromMemory(packed->get_data(), indices);
+    loaded->FinishLoad();
+
+    std::unique_ptr<LightGBM::BinIterator> expected_it(unpacked->GetIterator(0, num_bin - 1, 0));
+    std::unique_ptr<LightGBM::BinIterator> subset_it(subset->GetIterator(0, num_bin - 1, 0));
+    std::unique_ptr<LightGBM::BinIterator> loaded_it(loaded->GetIterator(0, num_bin - 1, 0));
+    for (data_size_t i = 0; i < num_indices; ++i) {
+      const uint32_t expected = expected_it->RawGet(indices[i]);
+      ASSERT_EQ(expected, subset_it->RawGet(i)) << "row " << i;
+      ASSERT_EQ(expected, loaded_it->RawGet(i)) << "row " << i;
+    }
+
+    std::vector<data_size_t> all_indices(num_data);
+    for (data_size_t i = 0; i < num_data; ++i) {
+      all_indices[i] = i;
+    }
+    for (uint32_t threshold = 0; threshold + 1 < static_cast<uint32_t>(num_bin); ++threshold) {
+      std::vector<data_size_t> lte(num_data), gt(num_data), expected_lte(num_data), expected_gt(num_data);
+      const data_size_t cnt = packed->Split(num_bin - 1, 0, 0, LightGBM::MissingType::None, false, threshold,
+                                            all_indices.data(), num_data, lte.data(), gt.data());
+      const data_size_t expected_cnt = unpacked->Split(num_bin - 1, 0, 0, LightGBM::MissingType::None, false,
+                                                       threshold, all_indices.data(), num_data,
+                                                       expected_lte.data(), expected_gt.data());
+      ASSERT_EQ(expected_cnt, cnt);
+      EXPECT_EQ(expected_lte, lte);
+      EXPECT_EQ(expected_gt, gt);
+    }
+  }
+}
+
+TEST(DenseBin, SplitMatchesSparseBin) {
+  using LightGBM::data_size_t;
+  using LightGBM::MissingType;
+  const data_size_t num_data = 20000;
+  const int num_bin = 12;
+  LightGBM::Random rand(5);
+  std::unique_ptr<Bin> dense(Bin::CreateDenseBin(num_data, num_bin));
+  std::unique_ptr<Bin> sparse(Bin::CreateSparseBin(num_data, num_bin));
+  for (data_size_t i = 0; i < num_data; ++i) {
+    const uint32_t bin = rand.NextShort(0, 3) == 0 ? 0 : static_cast<uint32_t>(rand.NextShort(1, num_bin));
+    dense->Push(0, i, bin);
+    if (bin != 0) {
+      sparse->Push(0, i, bin);
+    }
+  }
+  dense->FinishLoad();
+  sparse->FinishLoad();
+  std::vector<data_size_t> indices;
+  for (data_size_t i = 0; i < num_data; i += 1 + rand.NextShort(0, 3)) {
+    indices.push_back(i);
+  }
+  const data_size_t cnt = static_cast<data_size_t>(indices.size());
+  std::vector<data_size_t> lte(cnt), gt(cnt), expected_lte(cnt), expected_gt(cnt);
+  auto expect_same = [&](data_size_t expected_cnt, data_size_t lte_cnt) {
+    ASSERT_EQ(expected_cnt, lte_cnt);
+    EXPECT_TRUE(std::equal(lte.begin(), lte.begin() + lte_cnt, expected_lte.begin()));
+    EXPECT_TRUE(std::equal(gt.begin(), gt.begin() + (cnt - lte_cnt), expected_gt.begin()));
+  };
+  // whole bin, a feature of bins [3, 8] in a group, and a feature with a single bin
+  for (auto missing_type : {MissingType::None, MissingType::Zero, MissingType::NaN}) {
+    for (uint32_t most_freq_bin : {0, 2}) {
+      for (bool default_left : {false, true}) {
+        for (uint32_t threshold = 0; threshold < 5; ++threshold) {
+          expect_same(sparse->Split(num_bin - 1, 2, most_freq_bin, missing_type, default_left, threshold,
+                                    indices.data(), cnt, expected_lte.data(), expected_gt.data()),
+                      dense->Split(num_bin - 1, 2, most_freq_bin, missing_type, default_left, threshold,
+                                   indices.data(), cnt, lte.data(), gt.data()));
+          expect_same(sparse->Split(3, 8, 2, most_freq_bin, missing_type, default_left, threshold,
+                                    indices.data(), cnt, expected_lte.data(), expected_gt.data()),
+                      dense->Split(3, 8, 2, most_freq_bin, missing_type, default_left, threshold,
+                                   indices.data(), cnt, lte.data(), gt.data()));
+        }
+        expect_same(sparse->Split(5, 5, 0, most_freq_bin, missing_type, default_left, 0,
+                                  indices.data(), cnt, expected_lte.data(), expected_gt.data()),
+                    dense->Split(5, 5, 0, most_freq_bin, missing_type, default_left, 0,
+                                 indices.data(), cnt, lte.data(), gt.data()));
+      }
+    }
+  }
+}
+
+TEST(SparseBin, ConstructHistogramOnSubset) {
+  using LightGBM::data_size_t;
+  using LightGBM::hist_t;
+  using LightGBM::score_t;
+  const data_size_t num_data = 200000;
+  const int num_bin = 16;
+  LightGBM::Random rand(11);
+  std::unique_ptr<Bin> bin(Bin::CreateSparseBin(num_data, num_bin));
+  std::vector<uint32_t> bins(num_data, 0);
+  for (data_size_t i = 0; i < num_data; ++i) {
+    // dense runs and gaps longer than one delta, so that blocks differ a lot in size
+    const bool in_run = (i / 5000) % 3 == 0;
+    if (rand.NextShort(0, in_run ? 2 : 500) == 0) {
+      bins[i] = static_cast<uint32_t>(rand.NextShort(1, num_bin));
+      bin->Push(0, i, bins[i]);
+    }
+  }
+  bin->FinishLoad();
+  std::vector<score_t> gradients, hessians;
+  TestUtils::CreateRandomGradients(num_data, 12, &gradients, &hessians);
+
+  // from all rows down to a few scattered rows, as on deep leaves
+  for (int step : {1, 3, 97, 5003}) {
+    std::vector<data_size_t> indices;
+    for (data_size_t i = rand.NextShort(0, step); i < num_data; i += 1 + rand.NextShort(0, step)) {
+      indices.push_back(i);
+    }
+    const data_size_t num_indices = static_cast<data_size_t>(indices.size());
+    std::vector<score_t> ordered_gradients(num_indices), ordered_hessians(num_indices);
+    std::vector<hist_t> expected(num_bin * 2, 0.0);
+    for (data_size_t i = 0; i < num_indices; ++i) {
+      ordered_gradients[i] = gradients[indices[i]];
+      ordered_hessians[i] = hessians[indices[i]];
+      expected[bins[indices[i]] * 2] += gradients[indices[i]];
+      expected[bins[indices[i]] * 2 + 1] += hessians[indices[i]];
+    }
+
+    std::vector<hist_t> out(num_bin * 2, 0.0);
+    bin->ConstructHistogram(indices.data(), 0, num_indices, ordered_gradients.data(),
+                            ordered_hessians.data(), out.data());
+    // the most frequent bin 0 is not accumulated by sparse bins
+    for (int j = 2; j < num_bin * 2; ++j) {
+      EXPECT_EQ(expected[j], out[j]) << "step " << step << ", bin " << j / 2;
+    }
+
+    std::unique_ptr<LightGBM::BinIterator> iterator(bin->GetIterator(1, num_bin - 1, 0));
+    iterator->Reset(indices[0]);
+    for (data_size_t i = 0; i < num_indices; ++i) {
+      ASSERT_EQ(bins[indices[i]], iterator->RawGet(indices[i])) << "step " << step << ", row " << indices[i];
+    }
+  }
+}
+
+TEST(BinMapper, BatchValueToBin) {
+  for (int max_bin : {2, 3, 15, 63, 255}) {
+    ExpectBatchMatchesScalar(BinType::NumericalBin, max_bin, false);
+    ExpectBatchMatchesScalar(BinType::NumericalBin, max_bin, true);
+  }
+  ExpectBatchMatchesScalar(BinType::CategoricalBin, 255, false);
+}
@@ -0,0 +1,262 @@
+/*!
+ * Copyright (c) 2024 Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License. See LICENSE file in the project root for license information.
+ */
+
+#include <gtest/gtest.h>
+#include <testutils.h>
+#include <LightGBM/c_api.h>
+#include <LightGBM/dataset.h>
+#include <LightGBM/feature_group.h>
+#include <LightGBM/utils/byte_buffer.h>
+#include <LightGBM/utils/random.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+using LightGBM::Bin;
+using LightGBM::BinMapper;
+using LightGBM::BinaryWriter;
+using LightGBM::BinIterator;
+using LightGBM::ByteBuffer;
+using LightGBM::Dataset;
+using LightGBM::FeatureGroup;
+using LightGBM::TestUtils;
+using LightGBM::VirtualFileWriter;
+using LightGBM::data_size_t;
+
+namespace {
+
+std::string ReadFile(const std::string& filename) {
+  std::ifstream file(filename, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+void CopyFile(const std::string& from, const std::string& to) {
+  std::ofstream file(to, std::ios::binary | std::ios::trunc);
+  file << ReadFile(from);
+}
+
+void RemoveFiles(const std::string& bin_filename, int num_shards) {
+  std::remove(bin_filename.c_str());
+  for (int i = 0; i < num_shards; ++i) {
+    std::remove(Dataset::BinaryShardFilename(bin_filename, i).c_str());
+  }
+}
+
+// content of the dataset, saved again as a single binary file
+std::string SaveUnsharded(DatasetHandle handle, const std::string& bin_filename) {
+  static_cast<Dataset*>(handle)->SaveBinaryFile(bin_filename.c_str());
+  std::string content = ReadFile(bin_filename);
+  std::remove(bin_filename.c_str());
+  return content;
+}
+
+// serialized feature group whose dense bins have the given number of bits per bin
+std::string SerializeGroup(const FeatureGroup& group, int bits, const std::vector<uint32_t>& bins) {
+  ByteBuffer buffer(0);
+  group.SerializeToBinary(&buffer, false);
+  const int32_t saved_bits = bits;
+  buffer.AlignedWrite(&saved_bits, sizeof(saved_bits));
+  std::unique_ptr<Bin> bin(Bin::CreateDenseBinOfBits(static_cast<data_size_t>(bins.size()), bits));
+  for (size_t i = 0; i < bins.size(); ++i) {
+    bin->Push(0, static_cast<data_size_t>(i), bins[i]);
+  }
+  bin->FinishLoad();
+  bin->SaveBinaryToFile(&buffer);
+  return std::string(buffer.Data(), buffer.GetSize());
+}
+
+std::string SerializeGroup(const FeatureGroup& group) {
+  ByteBuffer buffer(0);
+  group.SerializeToBinary(&buffer);
+  return std::string(buffer.Data(), buffer.GetSize());
+}
+
+// binary file as saved before the number of bits per dense bin was recorded, converted from a current one
+std::string ToLegacyBinaryFile(const std::string& content, int num_groups, data_size_t num_data) {
+  const std::string legacy_token = "______LightGBM_Binary_File_Token______\n";
+  size_t pos = BinaryWriter::AlignedSize(legacy_token.size());
+  // header and metadata are unchanged
+  for (int i = 0; i < 2; ++i) {
+    size_t size = 0;
+    std::memcpy(&size, content.data() + pos, sizeof(size));
+    pos += sizeof(size) + size;
+  }
+  std::string legacy = content.substr(0, pos);
+  legacy.replace(0, legacy_token.size(), legacy_token);
+  for (int i = 0; i < num_groups; ++i) {
+    size_t size_of_group = 0;
+    std::memcpy(&size_of_group, content.data() + pos, sizeof(size_of_group));
+    pos += sizeof(size_of_group);
+    FeatureGroup group(content.data() + pos, num_data, {}, i);
+    ByteBuffer definition(0);
+    group.SerializeToBinary(&definition, false);
+    const std::vector<int32_t> bits = group.DenseBinBits();
+    const std::vector<int32_t> legacy_bits = group.DenseBinBits(true);
+    const size_t data_begin = definition.GetSize() + BinaryWriter::AlignedSize(sizeof(int32_t) * bits.size());
+    ByteBuffer legacy_group(0);
+    legacy_group.Write(definition.Data(), definition.GetSize());
+    if (bits == legacy_bits) {
+      legacy_group.Write(content.data() + pos + data_begin, size_of_group - data_begin);
+    } else {
+      // a single dense bin, packed tighter by this build
+      EXPECT_EQ(1, static_cast<int>(bits.size()));
+      std::unique_ptr<Bin> bin(Bin::CreateDenseBinOfBits(num_data, legacy_bits[0]));
+      std::unique_ptr<BinIterator> iterator(group.FeatureGroupIterator());
+      for (data_size_t j = 0; j < num_data; ++j) {
+        bin->Push(0, j, iterator->RawGet(j));
+      }
+      bin->FinishLoad();
+      bin->SaveBinaryToFile(&legacy_group);
+    }
+    const size_t size_of_legacy_group = legacy_group.GetSize();
+    legacy.append(reinterpret_cast<const char*>(&size_of_legacy_group), sizeof(size_of_legacy_group));
+    legacy.append(legacy_group.Data(), legacy_group.GetSize());
+    pos += size_of_group;
+  }
+  EXPECT_EQ(content.size(), pos);
+  return legacy;
+}
+
+}  // namespace
+
+TEST(BinaryFile, ShardsRoundTrip) {
+  const int num_shards = 3;
+  DatasetHandle dataset;
+  ASSERT_EQ(0, TestUtils::LoadDatasetFromExamples("binary_classification/binary.test", "max_bin=15", &dataset));
+  RemoveFiles("binary_file_test.bin", num_shards);
+  const std::string expected = SaveUnsharded(dataset, "binary_file_test_expected.bin");
+  static_cast<Dataset*>(dataset)->SaveBinaryFile("binary_file_test.bin", num_shards);
+  for (const char* params : {"max_bin=15", "max_bin=15 out_of_core=true"}) {
+    DatasetHandle loaded;
+    ASSERT_EQ(0, LGBM_DatasetCreateFromFile("binary_file_test.bin", params, nullptr, &loaded)) << params;
+    EXPECT_TRUE(expected == SaveUnsharded(loaded, "binary_file_test_loaded.bin")) << params;
+    EXPECT_EQ(0, LGBM_DatasetFree(loaded));
+  }
+  RemoveFiles("binary_file_test.bin", num_shards);
+  EXPECT_EQ(0, LGBM_DatasetFree(dataset));
+}
+
+TEST(BinaryFile, MismatchedShardsAreRejected) {
+  const int num_shards = 3;
+  DatasetHandle dataset;
+  ASSERT_EQ(0, TestUtils::LoadDatasetFromExamples("binary_classification/binary.test", "max_bin=15", &dataset));
+  RemoveFiles("binary_file_test_a.bin", num_shards);
+  RemoveFiles("binary_file_test_b.bin", num_shards);
+  RemoveFiles("binary_file_test_c.bin", num_shards - 1);
+  // same data saved twice, so only the ids of the two sets of shards differ
+  static_cast<Dataset*>(dataset)->SaveBinaryFile("binary_file_test_a.bin", num_shards);
+  static_cast<Dataset*>(dataset)->SaveBinaryFile("binary_file_test_b.bin", num_shards);
+  static_cast<Dataset*>(dataset)->SaveBinaryFile("binary_file_test_c.bin", num_shards - 1);
+  const std::string shard = Dataset::BinaryShardFilename("binary_file_test_a.bin", 1);
+  const std::string original_shard = ReadFile(shard);
+  DatasetHandle loaded = nullptr;
+  for (const char* params : {"max_bin=15", "max_bin=15 out_of_core=true"}) {
+    CopyFile(Dataset::BinaryShardFilename("binary_file_test_b.bin", 1), shard);
+    EXPECT_EQ(-1, LGBM_DatasetCreateFromFile("binary_file_test_a.bin", params, nullptr, &loaded)) << params;
+    // a shard at the same position of a set with a different number of shards
+    CopyFile(Dataset::BinaryShardFilename("binary_file_test_c.bin", 1), shard);
+    EXPECT_EQ(-1, LGBM_DatasetCreateFromFile("binary_file_test_a.bin", params, nullptr, &loaded)) << params;
+    // a shard at another position of the same set
+    CopyFile(Dataset::BinaryShardFilename("binary_file_test_a.bin", 2), shard);
+    EXPECT_EQ(-1, LGBM_DatasetCreateFromFile("binary_file_test_a.bin", params, nullptr, &loaded)) << params;
+    std::remove(shard.c_str());
+    EXPECT_EQ(-1, LGBM_DatasetCreateFromFile("binary_file_test_a.bin", params, nullptr, &loaded)) << params;
+  }
+  {
+    std::ofstream file(shard, std::ios::binary | std::ios::trunc);
+    file << original_shard;
+  }
+  ASSERT_EQ(0, LGBM_DatasetCreateFromFile("binary_file_test_a.bin", "max_bin=15", nullptr, &loaded));
+  EXPECT_EQ(0, LGBM_DatasetFree(loaded));
+  RemoveFiles("binary_file_test_a.bin", num_shards);
+  RemoveFiles("binary_file_test_b.bin", num_shards);
+  RemoveFiles("binary_file_test_c.bin", num_shards - 1);
+  EXPECT_EQ(0, LGBM_DatasetFree(dataset));
+}
+
+TEST(BinaryFile, DenseBinsOfOtherWidthsAreRepacked) {
+  // GPU and CUDA builds write bins with up to 4 values as 4-bit bins, which this build may pack tighter
+  const data_size_t num_data = 1001;
+  for (int num_bin : {2, 4, 16}) {
+    LightGBM::Random rand(num_bin);
+    std::vector<double> sample;
+    for (int i = 0; i < 300; ++i) {
+      sample.push_back(1 + i % (num_bin - 1));
+    }
+    std::vector<std::unique_ptr<BinMapper>> bin_mappers;
+    bin_mappers.emplace_back(new BinMapper());
+    bin_mappers[0]->FindBin(sample.data(), static_cast<int>(sample.size()), 1000, 255, 1, 0, false,
+                            LightGBM::BinType::NumericalBin, false, false, {});
+    ASSERT_EQ(num_bin, bin_mappers[0]->num_bin());
+    ASSERT_EQ(0, bin_mappers[0]->GetMostFreqBin());
+    FeatureGroup group(1, 0, &bin_mappers, 0, 0);
+
+    std::vector<uint32_t> bins(num_data);
+    std::vector<data_size_t> used_indices;
+    std::vector<uint32_t> used_bins;
+    for (data_size_t i = 0; i < num_data; ++i) {
+      bins[i] = static_cast<uint32_t>(rand.NextShort(0, num_bin));
+      if (i % 3 != 1) {
+        used_indices.push_back(i);
+        used_bins.push_back(bins[i]);
+      }
+    }
+    const int build_bits = Bin::DenseBinBits(num_bin);
+    const std::string expected = SerializeGroup(group, build_bits, bins);
+    const std::string expected_used = SerializeGroup(group, build_bits, used_bins);
+    for (int bits : {1, 2, 4, 8, 16}) {
+      if ((1 << bits) < num_bin) {
+        continue;
+      }
+      const std::string saved = SerializeGroup(group, bits, bins);
+      for (bool map_bins : {false, true}) {
+        FeatureGroup loaded(saved.data(), num_data, {}, 0, map_bins);
+        EXPECT_TRUE(expected == SerializeGroup(loaded)) << num_bin << " bins saved with " << bits << " bits";
+        EXPECT_EQ(map_bins && bits == build_bits, loaded.is_mapped());
+      }
+      FeatureGroup loaded_used(saved.data(), num_data, used_indices, 0);
+      EXPECT_TRUE(expected_used == SerializeGroup(loaded_used)) << num_bin << " bins saved with " << bits << " bits";
+    }
+  }
+}
+
+TEST(BinaryFile, LegacyFilesAreLoaded) {
+  // dense features with 2, 3, 4, 12 and 100 values, whose bins were all at least 4 bits wide, and a sparse feature
+  const data_size_t num_data = 1001;
+  const int num_feature = 6;
+  const int num_values[] = {2, 3, 4, 12, 100};
+  LightGBM::Random rand(7);
+  std::vector<double> features(num_data * num_feature);
+  for (data_size_t i = 0; i < num_data; ++i) {
+    for (int j = 0; j < num_feature - 1; ++j) {
+      features[i * num_feature + j] = rand.NextShort(0, num_values[j]);
+    }
+    features[i * num_feature + num_feature - 1] = rand.NextShort(0, 30) == 0 ? rand.NextFloat() + 1.0 : 0.0;
+  }
+  const char* params = "max_bin=255 enable_bundle=false verbose=-1";
+  DatasetHandle dataset;
+  ASSERT_EQ(0, LGBM_DatasetCreateFromMat(features.data(), C_API_DTYPE_FLOAT64, num_data, num_feature, 1, params,
+                                         nullptr, &dataset));
+  const std::string expected = SaveUnsharded(dataset, "binary_file_test_expected.bin");
+  {
+    std::ofstream file("binary_file_test_legacy.bin", std::ios::binary | std::ios::trunc);
+    file << ToLegacyBinaryFile(expected, static_cast<Dataset*>(dataset)->num_feature_groups(), num_data);
+  }
+  for (const char* load_params : {"max_bin=255", "max_bin=255 out_of_core=true"}) {
+    DatasetHandle loaded;
+    ASSERT_EQ(0, LGBM_DatasetCreateFromFile("binary_file_test_legacy.bin", load_params, nullptr, &loaded))
+        << load_params;
+    EXPECT_TRUE(expected == SaveUnsharded(loaded, "binary_file_test_loaded.bin")) << load_params;
+    EXPECT_EQ(0, LGBM_DatasetFree(loaded));
+  }
+  std::remove("binary_file_test_legacy.bin");
+  EXPECT_EQ(0, LGBM_DatasetFree(dataset));
+}
@@ -0,0 +1,138 @@
+/*!
+ * Copyright (c) 2024 Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License. See LICENSE file in the project root for license information.
+ */
+
+#include <gtest/gtest.h>
+#include <LightGBM/utils/file_io.h>
+#include <LightGBM/utils/openmp_wrapper.h>
+#include <LightGBM/utils/text_reader.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif  // USE_ZSTD
+
+using LightGBM::TextLine;
+using LightGBM::TextReader;
+using LightGBM::VirtualFileReader;
+using LightGBM::VirtualFileWriter;
+
+namespace {
+
+std::string MakeContent() {
+  std::string content;
+  for (int i = 0; i < 300000; ++i) {
+    content += std::to_string(i % 2) + "," + std::to_string(i * 0.5) + "," + std::to_string(i * 7919LL % 1000) + "\n";
+  }
+  return content;
+}
+
+void WriteAndReadBack(const std::string& filename) {
+  const std::string content = MakeContent();
+  {
+    auto writer = VirtualFileWriter::Make(filename);
+    ASSERT_TRUE(writer->Init());
+    // write in uneven pieces
+    size_t pos = 0;
+    for (size_t piece = 1; pos < content.size(); piece = piece * 3 + 1) {
+      size_t cnt = std::min(piece, content.size() - pos);
+      EXPECT_EQ(cnt, writer->Write(content.data() + pos, cnt));
+      pos += cnt;
+    }
+    EXPECT_TRUE(writer->Close());
+  }
+
+  auto reader = VirtualFileReader::Make(filename);
+  ASSERT_TRUE(reader->Init());
+  std::string read_back;
+  std::vector<char> buffer(12345);
+  size_t cnt = 0;
+  while ((cnt = reader->Read(buffer.data(), buffer.size())) > 0) {
+    read_back.append(buffer.data(), cnt);
+  }
+  EXPECT_EQ(content, read_back);
+
+  TextReader<int> text_reader(filename.c_str(), false, SIZE_MAX, 64 * 1024, 3);
+  int num_lines = 0;
+  text_reader.ReadAllAndProcessParallel([&num_lines](int start_idx, const std::vector<TextLine>& lines) {
+    EXPECT_EQ(num_lines, start_idx);
+    num_lines += static_cast<int>(lines.size());
+  });
+  EXPECT_EQ(300000, num_lines);
+  std::remove(filename.c_str());
+}
+
+}  // namespace
+
+TEST(FileIO, PlainFile) {
+  WriteAndReadBack("file_io_test.txt");
+}
+
+#ifdef USE_ZLIB
+TEST(FileIO, Gzip) {
+  WriteAndReadBack("file_io_test.txt.gz");
+}
+#endif  // USE_ZLIB
+
+#ifdef USE_ZSTD
+TEST(FileIO, Zstd) {
+  WriteAndReadBack("file_io_test.txt.zst");
+}
+
+TEST(ZstdWriter, ParallelFramesReadBack) {
+  // several 4MB chunks in one write, so they are compressed into separate frames in parallel
+  std::string content(18 * 1024 * 1024 + 123, ' ');
+  uint32_t state = 7;
+  for (auto& c : content) {
+    state = state * 1103515245 + 12345;
+    c = static_cast<char>('a' + (state >> 16) % 16);
+  }
+  const std::string filename = "file_io_test_frames.zst";
+  OMP_SET_NUM_THREADS(4);
+  {
+    auto writer = VirtualFileWriter::Make(filename);
+    ASSERT_TRUE(writer->Init());
+    EXPECT_EQ(content.size(), writer->Write(content.data(), content.size()));
+    EXPECT_TRUE(writer->Close());
+  }
+  OMP_SET_NUM_THREADS(-1);
+
+  {
+    auto reader = VirtualFileReader::Make(filename);
+    ASSERT_TRUE(reader->Init());
+    std::vector<char> buffer(1 << 20);
+    size_t cnt = 0;
+    std::string read_back;
+    while ((cnt = reader->Read(buffer.data(), buffer.size())) > 0) {
+      read_back.append(buffer.data(), cnt);
+    }
+    EXPECT_TRUE(content == read_back);
+  }
+  std::string compressed;
+  FILE* file = std::fopen(filename.c_str(), "rb");
+  ASSERT_NE(nullptr, file);
+  char buffer[1 << 16];
+  size_t cnt = 0;
+  while ((cnt = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    compressed.append(buffer, cnt);
+  }
+  std::fclose(file);
+  std::remove(filename.c_str());
+  std::vector<size_t> frame_content_sizes;
+  for (size_t pos = 0; pos < compressed.size();) {
+    const size_t frame_size = ZSTD_findFrameCompressedSize(compressed.data() + pos, compressed.size() - pos);
+    ASSERT_FALSE(ZSTD_isError(frame_size));
+    frame_content_sizes.push_back(static_cast<size_t>(
+        ZSTD_getFrameContentSize(compressed.data() + pos, compressed.size() - pos)));
+    pos += frame_size;
+  }
+  const size_t chunk_size = 4 * 1024 * 1024;
+  EXPECT_EQ(std::vector<size_t>({chunk_size, chunk_size, chunk_size, chunk_size, 2 * 1024 * 1024 + 123}),
+            frame_content_sizes);
+}
+#endif  // USE_ZSTD
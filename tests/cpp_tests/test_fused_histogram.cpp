@@ -0,0 +1,102 @@
+/*!
+ * Copyright (c) 2024 Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License. See LICENSE file in the project root for license information.
+ */
+
+#include <gtest/gtest.h>
+#include <testutils.h>
+#include <LightGBM/c_api.h>
+#include <LightGBM/dataset.h>
+#include <LightGBM/train_share_states.h>
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+using LightGBM::Dataset;
+using LightGBM::TestUtils;
+using LightGBM::TrainingShareStates;
+using LightGBM::data_size_t;
+using LightGBM::hist_t;
+using LightGBM::score_t;
+
+namespace {
+
+const int kNumFusedGroups = 4;
+
+template <bool USE_QUANT_GRAD, int HIST_BITS>
+void ExpectFusedMatchesPerGroup(const Dataset* dataset, const score_t* gradients, const score_t* hessians,
+                                int num_feature, int num_fused_threads, bool is_constant_hessian) {
+  const data_size_t num_data = dataset->num_data();
+  std::vector<score_t> ordered_gradients(num_data), ordered_hessians(num_data);
+  std::vector<int8_t> is_feature_used(num_feature, 1);
+  // the dense groups are fused only with at least kNumFusedGroups groups per thread
+  std::unique_ptr<TrainingShareStates> fused(dataset->GetShareStates<USE_QUANT_GRAD, HIST_BITS>(
+      ordered_gradients.data(), ordered_hessians.data(), is_feature_used, is_constant_hessian, true, false, 4));
+  std::unique_ptr<TrainingShareStates> per_group(dataset->GetShareStates<USE_QUANT_GRAD, HIST_BITS>(
+      ordered_gradients.data(), ordered_hessians.data(), is_feature_used, is_constant_hessian, true, false, 4));
+  fused->num_threads = num_fused_threads;
+  per_group->num_threads = dataset->num_feature_groups() / kNumFusedGroups + 1;
+  dataset->InitTrain(is_feature_used, fused.get());
+  dataset->InitTrain(is_feature_used, per_group.get());
+
+  std::vector<data_size_t> indices;
+  for (data_size_t i = 0; i < num_data; i += 1 + i % 3) {
+    indices.push_back(i);
+  }
+  for (bool use_indices : {false, true}) {
+    const data_size_t cnt = use_indices ? static_cast<data_size_t>(indices.size()) : num_data;
+    const data_size_t* data_indices = use_indices ? indices.data() : nullptr;
+    std::vector<hist_t> expected(per_group->num_hist_total_bin() * 2, 0.0);
+    std::vector<hist_t> hist(fused->num_hist_total_bin() * 2, 0.0);
+    dataset->ConstructHistograms<USE_QUANT_GRAD, HIST_BITS>(
+        is_feature_used, data_indices, cnt, gradients, hessians, ordered_gradients.data(),
+        ordered_hessians.data(), per_group.get(), expected.data());
+    dataset->ConstructHistograms<USE_QUANT_GRAD, HIST_BITS>(
+        is_feature_used, data_indices, cnt, gradients, hessians, ordered_gradients.data(),
+        ordered_hessians.data(), fused.get(), hist.data());
+    ASSERT_EQ(expected.size(), hist.size());
+    for (size_t j = 0; j < expected.size(); ++j) {
+      // compare the bits, the quantized histograms are packed integers
+      EXPECT_EQ(0, std::memcmp(&expected[j], &hist[j], sizeof(hist_t)))
+          << "entry " << j << (use_indices ? " with" : " without") << " indices, " << num_fused_threads
+          << " threads" << (is_constant_hessian ? ", constant hessian" : "");
+    }
+  }
+}
+
+}  // namespace
+
+TEST(FusedHistogram, FusedMatchesPerGroup) {
+  const int num_data = 3000;
+  // features with 2, 4, 16 and 100 distinct values, stored in dense groups of 1, 2, 4 and 8-bit bins,
+  // with two tasks of kNumFusedGroups groups for each width and a remainder processed per group
+  const int num_feature = 4 * (2 * kNumFusedGroups + 1);
+  const int num_values[] = {2, 4, 16, 100};
+  std::vector<TestUtils::RandomFeature> columns;
+  for (int j = 0; j < num_feature; ++j) {
+    columns.push_back({num_values[j % 4], 0, 0});
+  }
+  std::vector<double> features;
+  TestUtils::CreateRandomFeatures(num_data, columns, 3, &features);
+  DatasetHandle handle;
+  ASSERT_EQ(0, TestUtils::CreateDatasetFromFeatures(features, num_feature,
+                                                    "max_bin=255 min_data_in_bin=1 enable_bundle=false verbose=-1",
+                                                    nullptr, &handle));
+  const Dataset* dataset = reinterpret_cast<const Dataset*>(handle);
+  ASSERT_EQ(num_feature, dataset->num_feature_groups());
+
+  // sums of float gradients that are rounded differently when added in another order
+  std::vector<score_t> gradients, hessians;
+  TestUtils::CreateRandomLogisticGradients(num_data, 4, &gradients, &hessians);
+  std::vector<int8_t> int_gradients_and_hessians;
+  TestUtils::CreateRandomQuantizedGradients(num_data, 5, &int_gradients_and_hessians);
+  const score_t* int_gradients = reinterpret_cast<const score_t*>(int_gradients_and_hessians.data());
+  for (int num_threads : {1, 2}) {
+    ExpectFusedMatchesPerGroup<false, 0>(dataset, gradients.data(), hessians.data(), num_feature, num_threads, false);
+    ExpectFusedMatchesPerGroup<false, 0>(dataset, gradients.data(), hessians.data(), num_feature, num_threads, true);
+    ExpectFusedMatchesPerGroup<true, 16>(dataset, int_gradients, nullptr, num_feature, num_threads, false);
+    ExpectFusedMatchesPerGroup<true, 32>(dataset, int_gradients, nullptr, num_feature, num_threads, false);
+  }
+  EXPECT_EQ(0, LGBM_DatasetFree(handle));
+}
@@ -0,0 +1,62 @@
+/*!
+ * Copyright (c) 2024 Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License. See LICENSE file in the project root for license information.
+ */
+
+#include <gtest/gtest.h>
+#include <testutils.h>
+#include <LightGBM/c_api.h>
+
+#include <string>
+#include <vector>
+
+using LightGBM::TestUtils;
+
+namespace {
+
+std::string TrainModel(const std::vector<double>& features, const std::vector<float>& labels, int num_feature,
+                       const std::string& params) {
+  const int num_data = static_cast<int>(labels.size());
+  DatasetHandle dataset;
+  EXPECT_EQ(0, TestUtils::CreateDatasetFromFeatures(features, num_feature, params.c_str(), nullptr, &dataset));
+  EXPECT_EQ(0, LGBM_DatasetSetField(dataset, "label", labels.data(), num_data, C_API_DTYPE_FLOAT32));
+  BoosterHandle booster;
+  EXPECT_EQ(0, LGBM_BoosterCreate(dataset, params.c_str(), &booster));
+  int is_finished = 0;
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(0, LGBM_BoosterUpdateOneIter(booster, &is_finished));
+  }
+  int64_t out_len = 0;
+  std::vector<char> model(1 << 20);
+  EXPECT_EQ(0, LGBM_BoosterSaveModelToString(booster, 0, -1, C_API_FEATURE_IMPORTANCE_SPLIT,
+                                             static_cast<int64_t>(model.size()), &out_len, model.data()));
+  EXPECT_EQ(0, LGBM_BoosterFree(booster));
+  EXPECT_EQ(0, LGBM_DatasetFree(dataset));
+  return std::string(model.data());
+}
+
+}  // namespace
+
+TEST(HistogramPool, SmallPoolMatchesFullPool) {
+  const int num_data = 2000;
+  const int num_feature = 10;
+  std::vector<double> features;
+  TestUtils::CreateRandomFeatures(num_data, std::vector<TestUtils::RandomFeature>(num_feature, {0, 0, 0}), 7,
+                                  &features);
+  std::vector<float> labels(num_data);
+  for (int i = 0; i < num_data; ++i) {
+    labels[i] = static_cast<float>(features[i * num_feature] * features[i * num_feature + 1] +
+                                   (features[i * num_feature + 2] > 0.0 ? 1.0 : 0.0));
+  }
+  const std::string base_params = "num_leaves=31 min_data_in_leaf=5 force_col_wise=true verbose=-1 num_threads=1";
+  for (const std::string quant : {"use_quantized_grad=false", "use_quantized_grad=true"}) {
+    const std::string full_pool = TrainModel(features, labels, num_feature, base_params + " " + quant);
+    // room for only a few leaves, so parent histograms are evicted and rebuilt
+    const std::string small_pool = TrainModel(features, labels, num_feature,
+                                              base_params + " " + quant + " histogram_pool_size=0.1");
+    auto trees = [](const std::string& model) {
+      return model.substr(model.find("Tree=0"), model.find("end of trees") - model.find("Tree=0"));
+    };
+    EXPECT_EQ(trees(full_pool), trees(small_pool)) << quant;
+  }
+}
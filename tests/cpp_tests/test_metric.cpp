@@ -0,0 +1,147 @@
+/*!
+ * Copyright (c) 2024 Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License. See LICENSE file in the project root for license information.
+ */
+
+#include <gtest/gtest.h>
+#include <LightGBM/c_api.h>
+#include <LightGBM/config.h>
+#include <LightGBM/dataset.h>
+#include <LightGBM/metric.h>
+#include <LightGBM/utils/random.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+
+using LightGBM::Config;
+using LightGBM::DCGCalculator;
+using LightGBM::Dataset;
+using LightGBM::Metric;
+using LightGBM::data_size_t;
+
+TEST(DCGCalculator, SortTopKMatchesStableSort) {
+  LightGBM::Random rand(11);
+  const data_size_t num_data = 500;
+  // few distinct scores, so there are many ties, and some NaN scores that are ranked last
+  std::vector<double> score(num_data);
+  for (auto& s : score) {
+    s = rand.NextShort(0, 30) == 0 ? std::numeric_limits<double>::quiet_NaN() : rand.NextShort(0, 20);
+  }
+  std::vector<data_size_t> expected(num_data);
+  for (data_size_t i = 0; i < num_data; ++i) {
+    expected[i] = i;
+  }
+  std::stable_sort(expected.begin(), expected.end(), [&score](data_size_t a, data_size_t b) {
+    const double score_a = std::isnan(score[a]) ? -1.0 : score[a];
+    const double score_b = std::isnan(score[b]) ? -1.0 : score[b];
+    return score_a > score_b;
+  });
+  std::vector<data_size_t> sorted_idx;
+  for (data_size_t k : {1, 5, 30, 499, 500, 1000}) {
+    DCGCalculator::SortTopK(k, score.data(), num_data, &sorted_idx);
+    const data_size_t cnt = std::min(k, num_data);
+    EXPECT_EQ(std::vector<data_size_t>(expected.begin(), expected.begin() + cnt),
+              std::vector<data_size_t>(sorted_idx.begin(), sorted_idx.begin() + cnt)) << "k = " << k;
+  }
+}
+
+TEST(DCGCalculator, RankOrderIsTotalWithNaN) {
+  const double kNaN = std::numeric_limits<double>::quiet_NaN();
+  const double kInf = std::numeric_limits<double>::infinity();
+  const std::vector<double> score = {1.0, kNaN, -kInf, 1.0, kInf, kNaN, -2.0, 0.0, -kInf, kNaN};
+  const data_size_t num_data = static_cast<data_size_t>(score.size());
+  auto before = [&score](data_size_t a, data_size_t b) {
+    return DCGCalculator::IsRankedBefore(score[a], a, score[b], b);
+  };
+  for (data_size_t a = 0; a < num_data; ++a) {
+    EXPECT_FALSE(before(a, a));
+    for (data_size_t b = 0; b < num_data; ++b) {
+      if (a != b) {
+        EXPECT_NE(before(a, b), before(b, a)) << a << ", " << b;
+      }
+      for (data_size_t c = 0; c < num_data; ++c) {
+        if (before(a, b) && before(b, c)) {
+          EXPECT_TRUE(before(a, c)) << a << ", " << b << ", " << c;
+        }
+      }
+    }
+  }
+  std::vector<data_size_t> sorted_idx(num_data);
+  for (data_size_t i = 0; i < num_data; ++i) {
+    sorted_idx[i] = i;
+  }
+  std::sort(sorted_idx.begin(), sorted_idx.end(), before);
+  EXPECT_EQ(std::vector<data_size_t>({4, 0, 3, 7, 6, 2, 8, 1, 5, 9}), sorted_idx);
+}
+
+TEST(DCGCalculator, CalDCGWithAndWithoutBuffer) {
+  LightGBM::Random rand(13);
+  const data_size_t num_data = 200;
+  std::vector<float> label(num_data);
+  std::vector<double> score(num_data);
+  for (data_size_t i = 0; i < num_data; ++i) {
+    label[i] = static_cast<float>(rand.NextShort(0, 4));
+    score[i] = rand.NextShort(0, 20);
+  }
+  std::vector<double> label_gain;
+  DCGCalculator::DefaultLabelGain(&label_gain);
+  DCGCalculator::Init(label_gain);
+  const std::vector<data_size_t> ks = {1, 3, 10, 300};
+  std::vector<double> expected(ks.size()), dcg(ks.size());
+  std::vector<data_size_t> sorted_idx;
+  DCGCalculator::CalDCG(ks, label.data(), score.data(), num_data, &expected);
+  // the buffer of a previous, longer query is reused
+  sorted_idx.assign(2 * num_data, num_data);
+  DCGCalculator::CalDCG(ks, label.data(), score.data(), num_data, &dcg, &sorted_idx);
+  EXPECT_EQ(expected, dcg);
+}
+
+TEST(AUCMetric, UpdatedOrderMatchesFreshSort) {
+  const int num_data = 3000;
+  LightGBM::Random rand(5);
+  std::vector<double> features(num_data);
+  std::vector<float> labels(num_data), weights(num_data);
+  for (int i = 0; i < num_data; ++i) {
+    features[i] = rand.NextFloat();
+    labels[i] = static_cast<float>(rand.NextShort(0, 2));
+    weights[i] = rand.NextFloat() + 0.5f;
+  }
+  for (bool use_weights : {false, true}) {
+    DatasetHandle handle;
+    ASSERT_EQ(0, LGBM_DatasetCreateFromMat(features.data(), C_API_DTYPE_FLOAT64, num_data, 1, 1,
+                                           "verbose=-1", nullptr, &handle));
+    ASSERT_EQ(0, LGBM_DatasetSetField(handle, "label", labels.data(), num_data, C_API_DTYPE_FLOAT32));
+    if (use_weights) {
+      ASSERT_EQ(0, LGBM_DatasetSetField(handle, "weight", weights.data(), num_data, C_API_DTYPE_FLOAT32));
+    }
+    const Dataset* dataset = reinterpret_cast<const Dataset*>(handle);
+    Config config;
+    std::unique_ptr<Metric> metric(Metric::CreateMetric("auc", config));
+    metric->Init(dataset->metadata(), num_data);
+    // coarse scores, so there are ties
+    std::vector<double> score(num_data);
+    for (auto& s : score) {
+      s = rand.NextShort(0, 50) * 0.125;
+    }
+    // a few tree-like updates, then one that changes every score differently
+    for (int iter = 0; iter < 6; ++iter) {
+      if (iter > 0) {
+        std::vector<double> leaf_output(iter < 5 ? 7 : num_data);
+        for (auto& v : leaf_output) {
+          v = iter < 5 ? rand.NextShort(-20, 20) * 0.03125 : rand.NextFloat();
+        }
+        for (int i = 0; i < num_data; ++i) {
+          score[i] += leaf_output[iter < 5 ? rand.NextShort(0, 7) : i];
+        }
+      }
+      std::unique_ptr<Metric> fresh(Metric::CreateMetric("auc", config));
+      fresh->Init(dataset->metadata(), num_data);
+      EXPECT_DOUBLE_EQ(fresh->Eval(score.data(), nullptr)[0], metric->Eval(score.data(), nullptr)[0])
+          << "iteration " << iter;
+    }
+    EXPECT_EQ(0, LGBM_DatasetFree(handle));
+  }
+}
@@ -0,0 +1,226 @@
+/*!
+ * Copyright (c) 2024 Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License. See LICENSE file in the project root for license information.
+ */
+
+#include <gtest/gtest.h>
+#include <LightGBM/c_api.h>
+#include <LightGBM/config.h>
+#include <LightGBM/dataset.h>
+#include <LightGBM/metric.h>
+#include <LightGBM/objective_function.h>
+#include <LightGBM/utils/common.h>
+#include <LightGBM/utils/random.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+using LightGBM::Common::Softmax;
+using LightGBM::Config;
+using LightGBM::DCGCalculator;
+using LightGBM::Dataset;
+using LightGBM::ObjectiveFunction;
+using LightGBM::data_size_t;
+using LightGBM::kMinScore;
+using LightGBM::label_t;
+using LightGBM::score_t;
+
+namespace {
+
+// gradients of one query as computed with a stable sort of the indices, before the per-thread buffers
+void LambdarankGradientsWithStableSort(const Config& config, const std::vector<double>& sigmoid_table,
+                                       double min_sigmoid_input, double sigmoid_table_idx_factor,
+                                       data_size_t cnt, const label_t* label, const double* score,
+                                       score_t* lambdas, score_t* hessians) {
+  const double sigmoid = config.sigmoid;
+  const int truncation_level = config.lambdarank_truncation_level;
+  auto get_sigmoid = [&](double s) {
+    if (s <= min_sigmoid_input) {
+      return sigmoid_table[0];
+    } else if (s >= -min_sigmoid_input) {
+      return sigmoid_table.back();
+    }
+    return sigmoid_table[static_cast<size_t>((s - min_sigmoid_input) * sigmoid_table_idx_factor)];
+  };
+  double inverse_max_dcg = DCGCalculator::CalMaxDCGAtK(truncation_level, label, cnt);
+  if (inverse_max_dcg > 0.0) {
+    inverse_max_dcg = 1.0f / inverse_max_dcg;
+  }
+  for (data_size_t i = 0; i < cnt; ++i) {
+    lambdas[i] = 0.0f;
+    hessians[i] = 0.0f;
+  }
+  std::vector<data_size_t> sorted_idx(cnt);
+  for (data_size_t i = 0; i < cnt; ++i) {
+    sorted_idx[i] = i;
+  }
+  std::stable_sort(sorted_idx.begin(), sorted_idx.end(),
+                   [score](data_size_t a, data_size_t b) { return score[a] > score[b]; });
+  const double best_score = score[sorted_idx[0]];
+  data_size_t worst_idx = cnt - 1;
+  if (worst_idx > 0 && score[sorted_idx[worst_idx]] == kMinScore) {
+    worst_idx -= 1;
+  }
+  const double worst_score = score[sorted_idx[worst_idx]];
+  double sum_lambdas = 0.0;
+  for (data_size_t i = 0; i < cnt - 1 && i < truncation_level; ++i) {
+    if (score[sorted_idx[i]] == kMinScore) { continue; }
+    for (data_size_t j = i + 1; j < cnt; ++j) {
+      if (score[sorted_idx[j]] == kMinScore) { continue; }
+      if (label[sorted_idx[i]] == label[sorted_idx[j]]) { continue; }
+      data_size_t high_rank = i, low_rank = j;
+      if (label[sorted_idx[i]] < label[sorted_idx[j]]) {
+        high_rank = j;
+        low_rank = i;
+      }
+      const data_size_t high = sorted_idx[high_rank];
+      const data_size_t low = sorted_idx[low_rank];
+      const double delta_score = score[high] - score[low];
+      const double dcg_gap = config.label_gain[static_cast<int>(label[high])] -
+                             config.label_gain[static_cast<int>(label[low])];
+      const double paired_discount =
+          fabs(DCGCalculator::GetDiscount(high_rank) - DCGCalculator::GetDiscount(low_rank));
+      double delta_pair_NDCG = dcg_gap * paired_discount * inverse_max_dcg;
+      if (config.lambdarank_norm && best_score != worst_score) {
+        delta_pair_NDCG /= (0.01f + fabs(delta_score));
+      }
+      double p_lambda = get_sigmoid(delta_score);
+      double p_hessian = p_lambda * (1.0f - p_lambda);
+      p_lambda *= -sigmoid * delta_pair_NDCG;
+      p_hessian *= sigmoid * sigmoid * delta_pair_NDCG;
+      lambdas[low] -= static_cast<score_t>(p_lambda);
+      hessians[low] += static_cast<score_t>(p_hessian);
+      lambdas[high] += static_cast<score_t>(p_lambda);
+      hessians[high] += static_cast<score_t>(p_hessian);
+      sum_lambdas -= 2 * p_lambda;
+    }
+  }
+  if (config.lambdarank_norm && sum_lambdas > 0) {
+    double norm_factor = std::log2(1 + sum_lambdas) / sum_lambdas;
+    for (data_size_t i = 0; i < cnt; ++i) {
+      lambdas[i] = static_cast<score_t>(lambdas[i] * norm_factor);
+      hessians[i] = static_cast<score_t>(hessians[i] * norm_factor);
+    }
+  }
+}
+
+}  // namespace
+
+TEST(MulticlassSoftmax, GradientsMatchRowSoftmax) {
+  // not a multiple of the block size of rows
+  const int num_data = 1300;
+  const int num_class = 7;
+  LightGBM::Random rand(3);
+  std::vector<double> features(num_data);
+  std::vector<float> labels(num_data), weights(num_data);
+  for (int i = 0; i < num_data; ++i) {
+    features[i] = rand.NextFloat();
+    labels[i] = static_cast<float>(rand.NextShort(0, num_class));
+    weights[i] = rand.NextFloat() + 0.5f;
+  }
+  std::vector<double> score(static_cast<size_t>(num_data) * num_class);
+  for (auto& s : score) {
+    s = rand.NextFloat() * 20.0 - 10.0;
+  }
+  Config config;
+  config.num_class = num_class;
+  for (bool use_weights : {false, true}) {
+    DatasetHandle handle;
+    ASSERT_EQ(0, LGBM_DatasetCreateFromMat(features.data(), C_API_DTYPE_FLOAT64, num_data, 1, 1,
+                                           "verbose=-1", nullptr, &handle));
+    ASSERT_EQ(0, LGBM_DatasetSetField(handle, "label", labels.data(), num_data, C_API_DTYPE_FLOAT32));
+    if (use_weights) {
+      ASSERT_EQ(0, LGBM_DatasetSetField(handle, "weight", weights.data(), num_data, C_API_DTYPE_FLOAT32));
+    }
+    const Dataset* dataset = reinterpret_cast<const Dataset*>(handle);
+    std::unique_ptr<ObjectiveFunction> objective(ObjectiveFunction::CreateObjectiveFunction("multiclass", config));
+    objective->Init(dataset->metadata(), num_data);
+    std::vector<score_t> gradients(score.size()), hessians(score.size());
+    objective->GetGradients(score.data(), gradients.data(), hessians.data());
+
+    const double factor = static_cast<double>(num_class) / (num_class - 1.0f);
+    std::vector<double> rec(num_class);
+    for (int i = 0; i < num_data; ++i) {
+      for (int k = 0; k < num_class; ++k) {
+        rec[k] = score[static_cast<size_t>(num_data) * k + i];
+      }
+      Softmax(&rec);
+      const double w = use_weights ? weights[i] : 1.0;
+      for (int k = 0; k < num_class; ++k) {
+        const size_t idx = static_cast<size_t>(num_data) * k + i;
+        const double p = rec[k];
+        EXPECT_EQ(static_cast<score_t>((static_cast<int>(labels[i]) == k ? p - 1.0f : p) * w), gradients[idx]);
+        EXPECT_EQ(static_cast<score_t>((factor * p * (1.0f - p)) * w), hessians[idx]);
+      }
+    }
+    EXPECT_EQ(0, LGBM_DatasetFree(handle));
+  }
+}
+
+TEST(Lambdarank, GradientsMatchStableSort) {
+  // queries of one document, of a few documents and of more documents than the truncation levels
+  std::vector<int32_t> query_sizes;
+  LightGBM::Random rand(17);
+  for (int i = 0; i < 60; ++i) {
+    query_sizes.push_back(i % 10 == 0 ? 1 : rand.NextShort(2, i % 3 == 0 ? 300 : 20));
+  }
+  int num_data = 0;
+  for (int32_t size : query_sizes) {
+    num_data += size;
+  }
+  std::vector<double> features(num_data);
+  std::vector<float> labels(num_data);
+  std::vector<double> score(num_data);
+  for (int i = 0; i < num_data; ++i) {
+    features[i] = rand.NextFloat();
+    labels[i] = static_cast<float>(rand.NextShort(0, 5));
+    // few distinct scores, so that most documents are tied with others, and some at the minimal score
+    score[i] = rand.NextShort(0, 20) == 0 ? kMinScore : rand.NextShort(-4, 5) * 0.5;
+  }
+  DatasetHandle handle;
+  ASSERT_EQ(0, LGBM_DatasetCreateFromMat(features.data(), C_API_DTYPE_FLOAT64, num_data, 1, 1,
+                                         "verbose=-1", nullptr, &handle));
+  ASSERT_EQ(0, LGBM_DatasetSetField(handle, "label", labels.data(), num_data, C_API_DTYPE_FLOAT32));
+  ASSERT_EQ(0, LGBM_DatasetSetField(handle, "group", query_sizes.data(), static_cast<int>(query_sizes.size()),
+                                    C_API_DTYPE_INT32));
+  const Dataset* dataset = reinterpret_cast<const Dataset*>(handle);
+  const data_size_t* query_boundaries = dataset->metadata().query_boundaries();
+  for (int truncation_level : {1, 5, 30, 1000}) {
+    for (bool norm : {false, true}) {
+      Config config;
+      config.lambdarank_truncation_level = truncation_level;
+      config.lambdarank_norm = norm;
+      std::unique_ptr<ObjectiveFunction> objective(ObjectiveFunction::CreateObjectiveFunction("lambdarank", config));
+      objective->Init(dataset->metadata(), num_data);
+      std::vector<score_t> gradients(num_data), hessians(num_data);
+      objective->GetGradients(score.data(), gradients.data(), hessians.data());
+
+      // the sigmoid table of LambdarankNDCG
+      DCGCalculator::DefaultLabelGain(&config.label_gain);
+      const size_t sigmoid_bins = 1024 * 1024;
+      const double min_sigmoid_input = -50 / config.sigmoid / 2;
+      const double sigmoid_table_idx_factor = sigmoid_bins / (-2 * min_sigmoid_input);
+      std::vector<double> sigmoid_table(sigmoid_bins);
+      for (size_t i = 0; i < sigmoid_bins; ++i) {
+        const double s = i / sigmoid_table_idx_factor + min_sigmoid_input;
+        sigmoid_table[i] = 1.0f / (1.0f + std::exp(s * config.sigmoid));
+      }
+      std::vector<score_t> expected_gradients(num_data), expected_hessians(num_data);
+      for (size_t q = 0; q < query_sizes.size(); ++q) {
+        const data_size_t start = query_boundaries[q];
+        LambdarankGradientsWithStableSort(config, sigmoid_table, min_sigmoid_input, sigmoid_table_idx_factor,
+                                          query_boundaries[q + 1] - start, labels.data() + start,
+                                          score.data() + start, expected_gradients.data() + start,
+                                          expected_hessians.data() + start);
+      }
+      for (int i = 0; i < num_data; ++i) {
+        EXPECT_EQ(expected_gradients[i], gradients[i]) << "row " << i << ", truncation level " << truncation_level;
+        EXPECT_EQ(expected_hessians[i], hessians[i]) << "row " << i << ", truncation level " << truncation_level;
+      }
+    }
+  }
+  EXPECT_EQ(0, LGBM_DatasetFree(handle));
+}
@@ -0,0 +1,190 @@
+/*!
+ * Copyright (c) 2024 Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License. See LICENSE file in the project root for license information.
+ */
+
+#include <gtest/gtest.h>
+#include <testutils.h>
+#include <LightGBM/c_api.h>
+#include <LightGBM/config.h>
+#include <LightGBM/dataset.h>
+#include <LightGBM/train_share_states.h>
+#include <LightGBM/tree.h>
+#include <LightGBM/tree_learner.h>
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+using LightGBM::Config;
+using LightGBM::Dataset;
+using LightGBM::TestUtils;
+using LightGBM::TrainingShareStates;
+using LightGBM::Tree;
+using LightGBM::TreeLearner;
+using LightGBM::data_size_t;
+using LightGBM::hist_t;
+using LightGBM::score_t;
+
+namespace {
+
+const int kNumData = 3000;
+const int kNumFeature = 8;
+
+// dense features, sparse features and a categorical feature
+DatasetHandle CreateDataset(const std::string& params) {
+  std::vector<TestUtils::RandomFeature> columns;
+  for (int j = 0; j < kNumFeature - 1; ++j) {
+    columns.push_back(j % 3 == 1 ? TestUtils::RandomFeature{30, 90, 0} : TestUtils::RandomFeature{40, 0, 0});
+  }
+  columns.push_back({8, 0, 0});
+  std::vector<double> features;
+  TestUtils::CreateRandomFeatures(kNumData, columns, 5, &features);
+  DatasetHandle handle = nullptr;
+  const std::string dataset_params = params + " categorical_feature=" + std::to_string(kNumFeature - 1);
+  EXPECT_EQ(0, TestUtils::CreateDatasetFromFeatures(features, kNumFeature, dataset_params.c_str(), nullptr, &handle));
+  return handle;
+}
+
+template <bool USE_QUANT_GRAD, int HIST_BITS>
+void ExpectPlacedMatchesGathered(const Dataset* dataset, const score_t* gradients, const score_t* hessians,
+                                 bool is_constant_hessian, size_t gradient_size, bool place_both_leaves) {
+  std::vector<int8_t> is_feature_used(kNumFeature, 1);
+  std::vector<score_t> ordered_gradients(kNumData), ordered_hessians(kNumData);
+  std::vector<score_t> placed_gradients(kNumData), placed_hessians(kNumData);
+  std::unique_ptr<TrainingShareStates> gathered(dataset->GetShareStates<USE_QUANT_GRAD, HIST_BITS>(
+      ordered_gradients.data(), ordered_hessians.data(), is_feature_used, is_constant_hessian, true, false, 4));
+  std::unique_ptr<TrainingShareStates> placed(dataset->GetShareStates<USE_QUANT_GRAD, HIST_BITS>(
+      placed_gradients.data(), placed_hessians.data(), is_feature_used, is_constant_hessian, true, false, 4));
+  dataset->InitTrain(is_feature_used, gathered.get());
+  dataset->InitTrain(is_feature_used, placed.get());
+
+  // the indices of a bagging subset, partitioned into two leaves
+  std::vector<data_size_t> partition;
+  for (data_size_t i = 0; i < kNumData; ++i) {
+    if (i % 4 != 0 && i % 5 != 0) {
+      partition.push_back(i);
+    }
+  }
+  for (data_size_t i = 0; i < kNumData; ++i) {
+    if (i % 4 != 0 && i % 5 == 0) {
+      partition.push_back(i);
+    }
+  }
+  const data_size_t num_left = kNumData - kNumData / 4 - kNumData / 5 + kNumData / 20;
+  const data_size_t num_partition = static_cast<data_size_t>(partition.size());
+  // the gradients of the smaller right leaf are placed at the positions of its indices, as the tree learner
+  // gathers them while partitioning, the left leaf gathers its gradients itself unless the larger leaf
+  // is gathered too, when the parent histogram was evicted from the pool
+  const data_size_t placed_begin = place_both_leaves ? 0 : num_left;
+  for (data_size_t pos = placed_begin; pos < num_partition; ++pos) {
+    std::memcpy(reinterpret_cast<char*>(placed_gradients.data()) + pos * gradient_size,
+                reinterpret_cast<const char*>(gradients) + partition[pos] * gradient_size, gradient_size);
+    if (!USE_QUANT_GRAD) {
+      placed_hessians[pos] = hessians[partition[pos]];
+    }
+  }
+  placed->ordered_indices = partition.data() + placed_begin;
+  placed->ordered_indices_cnt = num_partition - placed_begin;
+  for (int leaf = 0; leaf < 2; ++leaf) {
+    const data_size_t begin = leaf == 0 ? 0 : num_left;
+    const data_size_t cnt = leaf == 0 ? num_left : num_partition - num_left;
+    std::vector<hist_t> expected(gathered->num_hist_total_bin() * 2, 0.0);
+    std::vector<hist_t> hist(placed->num_hist_total_bin() * 2, 0.0);
+    dataset->ConstructHistograms<USE_QUANT_GRAD, HIST_BITS>(
+        is_feature_used, partition.data() + begin, cnt, gradients, hessians, ordered_gradients.data(),
+        ordered_hessians.data(), gathered.get(), expected.data());
+    score_t* placed_gradients_of_leaf = reinterpret_cast<score_t*>(
+        reinterpret_cast<char*>(placed_gradients.data()) + begin * gradient_size);
+    dataset->ConstructHistograms<USE_QUANT_GRAD, HIST_BITS>(
+        is_feature_used, partition.data() + begin, cnt, gradients, hessians, placed_gradients_of_leaf,
+        placed_hessians.data() + begin, placed.get(), hist.data());
+    ASSERT_EQ(expected.size(), hist.size());
+    // compare the bits, the quantized histograms are packed integers
+    EXPECT_EQ(0, std::memcmp(expected.data(), hist.data(), expected.size() * sizeof(hist_t)))
+        << "leaf " << leaf << (place_both_leaves ? " with both leaves placed" : "");
+  }
+}
+
+std::string TrainTree(const Dataset* dataset, const std::string& params, const score_t* gradients,
+                      const score_t* hessians, const std::vector<data_size_t>& bagging_indices) {
+  Config config;
+  config.Set(Config::Str2Map(params.c_str()));
+  std::unique_ptr<TreeLearner> learner(TreeLearner::CreateTreeLearner("serial", "cpu", &config, false));
+  learner->Init(dataset, false);
+  learner->SetForcedSplit(nullptr);
+  if (!bagging_indices.empty()) {
+    learner->SetBaggingData(nullptr, bagging_indices.data(), static_cast<data_size_t>(bagging_indices.size()));
+  }
+  std::unique_ptr<Tree> tree(learner->Train(gradients, hessians, true));
+  return tree->ToString();
+}
+
+void ExpectTreesMatchWithoutGather(const std::string& params) {
+  DatasetHandle handle = CreateDataset("max_bin=15 verbose=-1");
+  const Dataset* dataset = reinterpret_cast<const Dataset*>(handle);
+  std::vector<score_t> gradients, hessians;
+  TestUtils::CreateRandomGradients(kNumData, 9, &gradients, &hessians);
+  std::vector<data_size_t> bagging_indices;
+  for (data_size_t i = 0; i < kNumData; ++i) {
+    if (i % 3 != 0) {
+      bagging_indices.push_back(i);
+    }
+  }
+  for (bool use_bagging : {false, true}) {
+    const std::vector<data_size_t> used_indices = use_bagging ? bagging_indices : std::vector<data_size_t>();
+    // col-wise histograms gather the gradients while the leaves are partitioned, row-wise ones never do
+    const std::string expected = TrainTree(dataset, params + " force_row_wise=true", gradients.data(),
+                                           hessians.data(), used_indices);
+    const std::string tree = TrainTree(dataset, params + " force_col_wise=true", gradients.data(),
+                                       hessians.data(), used_indices);
+    EXPECT_EQ(expected, tree) << params << (use_bagging ? " with bagging" : "");
+  }
+  EXPECT_EQ(0, LGBM_DatasetFree(handle));
+}
+
+}  // namespace
+
+TEST(OrderedGradients, PlacedGradientsMatchGathered) {
+  DatasetHandle handle = CreateDataset("max_bin=15 verbose=-1");
+  const Dataset* dataset = reinterpret_cast<const Dataset*>(handle);
+  std::vector<score_t> gradients, hessians;
+  TestUtils::CreateRandomGradients(kNumData, 9, &gradients, &hessians);
+  std::vector<int8_t> int_gradients_and_hessians;
+  TestUtils::CreateRandomQuantizedGradients(kNumData, 11, &int_gradients_and_hessians);
+  const score_t* int_gradients = reinterpret_cast<const score_t*>(int_gradients_and_hessians.data());
+  for (bool place_both_leaves : {false, true}) {
+    ExpectPlacedMatchesGathered<false, 0>(dataset, gradients.data(), hessians.data(), false, sizeof(score_t),
+                                          place_both_leaves);
+    ExpectPlacedMatchesGathered<false, 0>(dataset, gradients.data(), hessians.data(), true, sizeof(score_t),
+                                          place_both_leaves);
+    ExpectPlacedMatchesGathered<true, 16>(dataset, int_gradients, nullptr, false, sizeof(int16_t),
+                                          place_both_leaves);
+    ExpectPlacedMatchesGathered<true, 32>(dataset, int_gradients, nullptr, false, sizeof(int16_t),
+                                          place_both_leaves);
+  }
+  EXPECT_EQ(0, LGBM_DatasetFree(handle));
+}
+
+TEST(OrderedGradients, TreesMatchWithoutGather) {
+  // float and quantized gradients, and a histogram pool of two histograms
+  for (const char* params : {"num_leaves=31 min_data_in_leaf=5",
+                             "num_leaves=31 min_data_in_leaf=5 use_quantized_grad=true",
+                             "num_leaves=31 min_data_in_leaf=5 histogram_pool_size=0.000001"}) {
+    ExpectTreesMatchWithoutGather(params);
+  }
+}
+
+TEST(OrderedGradients, TreesMatchWithoutGatherOnSkippedAndLargerLeaves) {
+  // the last split and the splits into leaves at max_depth gather nothing, their leaves are never split again
+  for (const char* params : {"num_leaves=2 min_data_in_leaf=5", "num_leaves=3 min_data_in_leaf=5",
+                             "num_leaves=31 max_depth=3 min_data_in_leaf=5",
+                             "num_leaves=31 max_depth=4 min_data_in_leaf=200",
+                             // parent histograms evicted from the pool, so both leaves are gathered
+                             "num_leaves=63 min_data_in_leaf=5 histogram_pool_size=0.000001",
+                             "num_leaves=63 min_data_in_leaf=5 histogram_pool_size=0.000001 use_quantized_grad=true",
+                             "num_leaves=63 max_depth=5 min_data_in_leaf=5 histogram_pool_size=0.000001"}) {
+    ExpectTreesMatchWithoutGather(params);
+  }
+}
@@ -0,0 +1,20 @@
+/*!
+ * Copyright (c) 2024 Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License. See LICENSE file in the project root for license information.
+ */
+
+#include <gtest/gtest.h>
+#include <LightGBM/utils/random.h>
+
+using LightGBM::Random;
+
+TEST(Random, ShortThresholdMatchesNextFloat) {
+  for (double prob : {0.0, 1e-5, 0.1, 1.0 / 3, 0.5, 0.8, 1.0 - 1e-5, 1.0}) {
+    Random short_rand(17);
+    Random float_rand(17);
+    const int threshold = Random::ShortThreshold(prob);
+    for (int i = 0; i < 100000; ++i) {
+      ASSERT_EQ(float_rand.NextFloat() < prob, short_rand.NextShort(0, 32768) < threshold) << "prob = " << prob;
+    }
+  }
+}
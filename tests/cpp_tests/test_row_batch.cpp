@@ -0,0 +1,180 @@
+/*!
+ * Copyright (c) 2024 Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License. See LICENSE file in the project root for license information.
+ */
+
+#include <gtest/gtest.h>
+#include <LightGBM/c_api.h>
+#include <LightGBM/dataset.h>
+#include <LightGBM/utils/random.h>
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+using LightGBM::Dataset;
+
+namespace {
+
+// binned content of a dataset, as saved to a binary file
+std::string BinaryContent(DatasetHandle handle, const std::string& bin_filename) {
+  std::remove(bin_filename.c_str());
+  static_cast<Dataset*>(handle)->SaveBinaryFile(bin_filename.c_str());
+  std::ifstream file(bin_filename, std::ios::binary);
+  std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  file.close();
+  std::remove(bin_filename.c_str());
+  return content;
+}
+
+}  // namespace
+
+TEST(RowBatch, CSRMatchesDenseRows) {
+  const int num_data = 5000;
+  const int num_feature = 12;
+  LightGBM::Random rand(21);
+  // sparse features that get bundled, features whose most frequent value is not zero, and missing values
+  std::vector<double> features(num_data * num_feature);
+  for (int i = 0; i < num_data; ++i) {
+    for (int j = 0; j < num_feature; ++j) {
+      double value = 0.0;
+      const int kind = j % 4;
+      if (kind == 0) {
+        value = rand.NextFloat();
+      } else if (kind == 1) {
+        value = rand.NextShort(0, 20) == 0 ? rand.NextShort(1, 5) : 0.0;
+      } else if (kind == 2) {
+        value = rand.NextShort(0, 10) == 0 ? 0.0 : 5.0;
+      } else {
+        value = rand.NextShort(0, 8) == 0 ? std::numeric_limits<double>::quiet_NaN()
+                                          : (rand.NextShort(0, 3) == 0 ? rand.NextFloat() : 0.0);
+      }
+      features[i * num_feature + j] = value;
+    }
+  }
+  std::vector<int32_t> indptr(1, 0), indices;
+  std::vector<double> values;
+  for (int i = 0; i < num_data; ++i) {
+    for (int j = 0; j < num_feature; ++j) {
+      const double value = features[i * num_feature + j];
+      if (value != 0.0) {
+        indices.push_back(j);
+        values.push_back(value);
+      }
+    }
+    indptr.push_back(static_cast<int32_t>(indices.size()));
+  }
+
+  const char* params = "max_bin=31 min_data_in_bin=1 verbose=-1 num_threads=2";
+  DatasetHandle reference, from_mat, from_csr;
+  ASSERT_EQ(0, LGBM_DatasetCreateFromMat(features.data(), C_API_DTYPE_FLOAT64, num_data, num_feature, 1,
+                                         params, nullptr, &reference));
+  // both use the bin mappers of the reference, so only the pushing of the values differs
+  ASSERT_EQ(0, LGBM_DatasetCreateFromMat(features.data(), C_API_DTYPE_FLOAT64, num_data, num_feature, 1,
+                                         params, reference, &from_mat));
+  ASSERT_EQ(0, LGBM_DatasetCreateFromCSR(indptr.data(), C_API_DTYPE_INT32, indices.data(), values.data(),
+                                         C_API_DTYPE_FLOAT64, indptr.size(), values.size(), num_feature,
+                                         params, reference, &from_csr));
+  EXPECT_TRUE(BinaryContent(from_mat, "row_batch_test_mat.bin") == BinaryContent(from_csr, "row_batch_test_csr.bin"));
+  EXPECT_EQ(0, LGBM_DatasetFree(from_csr));
+  EXPECT_EQ(0, LGBM_DatasetFree(from_mat));
+  EXPECT_EQ(0, LGBM_DatasetFree(reference));
+}
+
+TEST(RowBatch, TwoRoundLoadingIndependentOfReadBlocks) {
+  // larger than 1MB, so it is processed in two blocks of lines with file_read_block_size=1,
+  // the zeros of the third column are pushed explicitly since its most frequent value is not zero
+  const std::string filename = "row_batch_test.csv";
+  {
+    LightGBM::Random rand(8);
+    std::ofstream file(filename);
+    for (int i = 0; i < 120000; ++i) {
+      file << rand.NextShort(0, 2) << "," << rand.NextFloat() << ","
+           << (rand.NextShort(0, 10) == 0 ? 0 : 5) << ","
+           << (rand.NextShort(0, 20) == 0 ? rand.NextShort(1, 5) : 0) << "\n";
+    }
+  }
+  DatasetHandle one_block, two_blocks, in_memory;
+  ASSERT_EQ(0, LGBM_DatasetCreateFromFile(filename.c_str(), "two_round=true max_bin=15 verbose=-1",
+                                          nullptr, &one_block));
+  ASSERT_EQ(0, LGBM_DatasetCreateFromFile(filename.c_str(), "two_round=true max_bin=15 verbose=-1 "
+                                          "file_read_block_size=1", nullptr, &two_blocks));
+  ASSERT_EQ(0, LGBM_DatasetCreateFromFile(filename.c_str(), "max_bin=15 verbose=-1", nullptr, &in_memory));
+  std::remove(filename.c_str());
+  const std::string expected = BinaryContent(one_block, "row_batch_test_one.bin");
+  EXPECT_TRUE(expected == BinaryContent(two_blocks, "row_batch_test_two.bin"));
+  EXPECT_TRUE(expected == BinaryContent(in_memory, "row_batch_test_memory.bin"));
+  EXPECT_EQ(0, LGBM_DatasetFree(in_memory));
+  EXPECT_EQ(0, LGBM_DatasetFree(two_blocks));
+  EXPECT_EQ(0, LGBM_DatasetFree(one_block));
+}
+
+TEST(RowBatch, UnsortedCSRMatchesPushOneRow) {
+  const int num_data = 3000;
+  const int num_feature = 8;
+  LightGBM::Random rand(5);
+  // one non-zero feature per sampled row, so all features are bundled into one dense group
+  std::vector<std::vector<double>> sample_values(num_feature);
+  std::vector<std::vector<int>> sample_indices(num_feature);
+  for (int i = 0; i < num_data; ++i) {
+    const int j = rand.NextShort(0, num_feature);
+    sample_values[j].push_back(rand.NextShort(1, 5));
+    sample_indices[j].push_back(i);
+  }
+  std::vector<double*> sample_values_ptr;
+  std::vector<int*> sample_indices_ptr;
+  std::vector<int> num_per_col;
+  for (int j = 0; j < num_feature; ++j) {
+    sample_values_ptr.push_back(sample_values[j].data());
+    sample_indices_ptr.push_back(sample_indices[j].data());
+    num_per_col.push_back(static_cast<int>(sample_values[j].size()));
+  }
+  // while the pushed rows have conflicting features, of which the value pushed last is kept,
+  // their columns in random order and some of them repeated with another value
+  std::vector<int32_t> indptr(1, 0), indices;
+  std::vector<double> values;
+  std::vector<std::vector<std::pair<int, double>>> rows(num_data);
+  for (int i = 0; i < num_data; ++i) {
+    for (int j = 0; j < num_feature; ++j) {
+      if (rand.NextShort(0, 4) == 0) {
+        rows[i].emplace_back(j, rand.NextShort(1, 5));
+        if (rand.NextShort(0, 4) == 0) {
+          rows[i].emplace_back(j, rand.NextShort(1, 5));
+        }
+      }
+    }
+    for (size_t k = rows[i].size(); k > 1; --k) {
+      std::swap(rows[i][k - 1], rows[i][rand.NextShort(0, static_cast<int>(k))]);
+    }
+    for (const auto& entry : rows[i]) {
+      indices.push_back(entry.first);
+      values.push_back(entry.second);
+    }
+    indptr.push_back(static_cast<int32_t>(indices.size()));
+  }
+
+  const char* params = "max_bin=15 min_data_in_bin=1 verbose=-1 num_threads=2";
+  DatasetHandle pushed, from_csr;
+  for (DatasetHandle* handle : {&pushed, &from_csr}) {
+    ASSERT_EQ(0, LGBM_DatasetCreateFromSampledColumn(sample_values_ptr.data(), sample_indices_ptr.data(), num_feature,
+                                                     num_per_col.data(), num_data, num_data, num_data, params,
+                                                     handle));
+  }
+  ASSERT_EQ(1, static_cast<Dataset*>(pushed)->num_feature_groups());
+  ASSERT_FALSE(static_cast<Dataset*>(pushed)->IsMultiGroup(0));
+  for (int i = 0; i < num_data; ++i) {
+    static_cast<Dataset*>(pushed)->PushOneRow(0, i, rows[i]);
+  }
+  static_cast<Dataset*>(pushed)->FinishLoad();
+  ASSERT_EQ(0, LGBM_DatasetPushRowsByCSR(from_csr, indptr.data(), C_API_DTYPE_INT32, indices.data(), values.data(),
+                                         C_API_DTYPE_FLOAT64, indptr.size(), values.size(), num_feature, 0));
+  EXPECT_TRUE(BinaryContent(pushed, "row_batch_test_pushed.bin") ==
+              BinaryContent(from_csr, "row_batch_test_unsorted_csr.bin"));
+  EXPECT_EQ(0, LGBM_DatasetFree(from_csr));
+  EXPECT_EQ(0, LGBM_DatasetFree(pushed));
+}
@@ -0,0 +1,82 @@
+/*!
+ * Copyright (c) 2024 Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License. See LICENSE file in the project root for license information.
+ */
+
+#include <gtest/gtest.h>
+#include <testutils.h>
+#include <LightGBM/c_api.h>
+#include <LightGBM/dataset.h>
+#include <LightGBM/train_share_states.h>
+
+#include <memory>
+#include <vector>
+
+using LightGBM::Dataset;
+using LightGBM::TestUtils;
+using LightGBM::TrainingShareStates;
+using LightGBM::data_size_t;
+using LightGBM::hist_t;
+using LightGBM::score_t;
+
+namespace {
+
+void ExpectRowWiseMatchesColWise(int zero_percent) {
+  const int num_data = 3000;
+  const int num_feature = 20;
+  std::vector<double> features;
+  TestUtils::CreateRandomFeatures(num_data, std::vector<TestUtils::RandomFeature>(num_feature, {100, zero_percent, 0}),
+                                  zero_percent, &features);
+  DatasetHandle handle;
+  ASSERT_EQ(0, TestUtils::CreateDatasetFromFeatures(features, num_feature, "max_bin=15 verbose=-1", nullptr, &handle));
+  const Dataset* dataset = reinterpret_cast<const Dataset*>(handle);
+
+  std::vector<score_t> gradients, hessians;
+  TestUtils::CreateRandomGradients(num_data, zero_percent, &gradients, &hessians);
+  std::vector<score_t> ordered_gradients(num_data), ordered_hessians(num_data);
+  std::vector<int8_t> is_feature_used(num_feature, 1);
+  std::unique_ptr<TrainingShareStates> col_wise(dataset->GetShareStates<false, 0>(
+      ordered_gradients.data(), ordered_hessians.data(), is_feature_used, false, true, false, 0));
+  std::unique_ptr<TrainingShareStates> adaptive(dataset->GetShareStates<false, 0>(
+      ordered_gradients.data(), ordered_hessians.data(), is_feature_used, false, true, false, 0));
+  // costs that always choose row-wise
+  adaptive->SetRowWiseState(dataset->GetShareStates<false, 0>(
+      ordered_gradients.data(), ordered_hessians.data(), is_feature_used, false, false, true, 0), 1.0, 0.0, 0.0, 0.0);
+  dataset->InitTrain(is_feature_used, col_wise.get());
+  dataset->InitTrain(is_feature_used, adaptive.get());
+
+  std::vector<data_size_t> indices;
+  for (data_size_t i = 0; i < num_data; i += 1 + i % 3) {
+    indices.push_back(i);
+  }
+  for (bool use_indices : {false, true}) {
+    const data_size_t cnt = use_indices ? static_cast<data_size_t>(indices.size()) : num_data;
+    const data_size_t* data_indices = use_indices ? indices.data() : nullptr;
+    std::vector<hist_t> expected(col_wise->num_hist_total_bin() * 2, 0.0);
+    std::vector<hist_t> hist(adaptive->num_hist_total_bin() * 2, 0.0);
+    dataset->ConstructHistograms<false, 0>(is_feature_used, data_indices, cnt, gradients.data(), hessians.data(),
+                                           ordered_gradients.data(), ordered_hessians.data(), col_wise.get(),
+                                           expected.data());
+    dataset->ConstructHistograms<false, 0>(is_feature_used, data_indices, cnt, gradients.data(), hessians.data(),
+                                           ordered_gradients.data(), ordered_hessians.data(), adaptive.get(),
+                                           hist.data());
+    for (int f = 0; f < num_feature; ++f) {
+      const int offset = dataset->FeatureBinMapper(f)->GetMostFreqBin() == 0 ? 1 : 0;
+      const int start = static_cast<int>(col_wise->feature_hist_offsets()[f]) * 2;
+      for (int j = start; j < start + (dataset->FeatureNumBin(f) - offset) * 2; ++j) {
+        EXPECT_EQ(expected[j], hist[j]) << "feature " << f << ", bin " << (j - start) / 2;
+      }
+    }
+  }
+  EXPECT_EQ(0, LGBM_DatasetFree(handle));
+}
+
+}  // namespace
+
+TEST(RowColWise, RowWiseMatchesColWise) {
+  // dense row-wise bins, sparse row-wise bins with a different histogram layout than the dense col-wise bins,
+  // and sparse bins in both
+  for (int zero_percent : {10, 50, 80}) {
+    ExpectRowWiseMatchesColWise(zero_percent);
+  }
+}
@@ -10,7 +10,11 @@
 #include <LightGBM/c_api.h>
 #include <LightGBM/dataset.h>
 
+#include <cstdio>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
 
 using LightGBM::ByteBuffer;
 using LightGBM::Dataset;
@@ -82,3 +86,59 @@ TEST(Serialization, JustWorks) {
     FAIL() << "Test Serialization failed with exception: " << exceptionText;
   }
 }
+
+namespace {
+
+std::string TrainModel(DatasetHandle dataset_handle) {
+  BoosterHandle booster_handle;
+  EXPECT_EQ(0, LGBM_BoosterCreate(dataset_handle, "objective=binary num_leaves=7 deterministic=true verbose=-1",
+                                  &booster_handle));
+  int is_finished = 0;
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(0, LGBM_BoosterUpdateOneIter(booster_handle, &is_finished));
+  }
+  int64_t out_len = 0;
+  std::vector<char> model(1024 * 1024);
+  EXPECT_EQ(0, LGBM_BoosterSaveModelToString(booster_handle, 0, -1, 0, static_cast<int64_t>(model.size()),
+                                             &out_len, model.data()));
+  EXPECT_EQ(0, LGBM_BoosterFree(booster_handle));
+  return std::string(model.data());
+}
+
+}  // namespace
+
+TEST(Serialization, OutOfCoreBinaryFile) {
+  DatasetHandle dataset_handle;
+  const char* params = "max_bin=255 force_col_wise=true verbose=-1";
+  ASSERT_EQ(0, TestUtils::LoadDatasetFromExamples("binary_classification/binary.train", params, &dataset_handle));
+  Dataset* dataset = static_cast<Dataset*>(dataset_handle);
+  const std::string expected_model = TrainModel(dataset_handle);
+
+  for (int num_shards : {1, 3}) {
+    const std::string bin_filename = "out_of_core_test.bin";
+    dataset->SaveBinaryFile(bin_filename.c_str(), num_shards);
+    // a zero cache size releases the bins of all other groups whenever histograms are constructed
+    DatasetHandle mapped_handle;
+    ASSERT_EQ(0, LGBM_DatasetCreateFromFile(bin_filename.c_str(),
+                                            "out_of_core=true out_of_core_cache_size=0 verbose=-1",
+                                            nullptr, &mapped_handle));
+    Dataset* mapped = static_cast<Dataset*>(mapped_handle);
+    ASSERT_EQ(dataset->num_data(), mapped->num_data());
+    ASSERT_EQ(dataset->num_features(), mapped->num_features());
+    for (int i = 0; i < dataset->num_features(); ++i) {
+      std::unique_ptr<LightGBM::BinIterator> expected_bins(dataset->FeatureIterator(i));
+      std::unique_ptr<LightGBM::BinIterator> bins(mapped->FeatureIterator(i));
+      for (int j = 0; j < dataset->num_data(); ++j) {
+        ASSERT_EQ(expected_bins->RawGet(j), bins->RawGet(j)) << "feature " << i << ", row " << j;
+      }
+    }
+    EXPECT_EQ(expected_model, TrainModel(mapped_handle));
+    EXPECT_EQ(0, LGBM_DatasetFree(mapped_handle));
+
+    std::remove(bin_filename.c_str());
+    for (int i = 0; i < num_shards && num_shards > 1; ++i) {
+      std::remove(Dataset::BinaryShardFilename(bin_filename, i).c_str());
+    }
+  }
+  EXPECT_EQ(0, LGBM_DatasetFree(dataset_handle));
+}
@@ -0,0 +1,112 @@
+/*!
+ * Copyright (c) 2024 Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License. See LICENSE file in the project root for license information.
+ */
+
+#include <gtest/gtest.h>
+#include <LightGBM/utils/text_reader.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using LightGBM::TextLine;
+using LightGBM::TextLineBuffer;
+using LightGBM::TextReader;
+
+namespace {
+
+std::string WriteTempFile(const std::string& content) {
+  std::string filename = "text_reader_test.txt";
+  FILE* file = fopen(filename.c_str(), "wb");
+  fwrite(content.data(), 1, content.size(), file);
+  fclose(file);
+  return filename;
+}
+
+}  // namespace
+
+TEST(TextLineBuffer, JustWorks) {
+  TextLineBuffer buffer;
+  EXPECT_TRUE(buffer.empty());
+  std::vector<std::string> expected;
+  for (int i = 0; i < 10000; ++i) {
+    expected.push_back(std::string(i % 97, 'a' + (i % 26)));
+    buffer.Append(expected.back().data(), expected.back().size());
+  }
+  std::string long_line(200 * 1024, 'z');
+  expected.push_back(long_line);
+  buffer.Append(long_line.data(), long_line.size());
+
+  ASSERT_EQ(expected.size(), buffer.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(expected[i].size(), buffer[i].size());
+    EXPECT_STREQ(expected[i].c_str(), buffer[i].c_str());
+  }
+  buffer.clear();
+  EXPECT_EQ(0, buffer.size());
+}
+
+TEST(TextReader, ParallelLineViews) {
+  auto filename = WriteTempFile("h1,h2\r\n1,2\r\n3,4\n\n5,6\r7,8");
+  TextReader<int> reader(filename.c_str(), true);
+  EXPECT_EQ("h1,h2", reader.first_line());
+
+  std::vector<std::string> lines;
+  int num_lines = reader.ReadAllAndProcessParallel(
+    [&lines](int start_idx, const std::vector<TextLine>& block) {
+    EXPECT_EQ(static_cast<int>(lines.size()), start_idx);
+    for (const auto& line : block) {
+      // every view is terminated in place
+      EXPECT_EQ(line.size(), std::string(line.c_str()).size());
+      lines.push_back(line.ToString());
+    }
+  });
+  EXPECT_EQ(4, num_lines);
+  std::vector<std::string> expected = {"1,2", "3,4", "5,6", "7,8"};
+  EXPECT_EQ(expected, lines);
+
+  TextLineBuffer buffer;
+  std::vector<int> used_indices;
+  num_lines = reader.ReadAndFilterLines([](int idx) { return idx % 2 == 1; }, &used_indices, &buffer);
+  EXPECT_EQ(4, num_lines);
+  ASSERT_EQ(2, buffer.size());
+  EXPECT_STREQ("3,4", buffer[0].c_str());
+  EXPECT_STREQ("7,8", buffer[1].c_str());
+  EXPECT_EQ(std::vector<int>({1, 3}), used_indices);
+  std::remove(filename.c_str());
+}
+
+TEST(TextReader, SmallBlocksManyBuffers) {
+  std::string content;
+  std::vector<std::string> expected;
+  for (int i = 0; i < 1000; ++i) {
+    expected.push_back(std::to_string(i * 7919) + "," + std::to_string(i));
+    content += expected.back() + (i % 3 == 0 ? "\r\n" : "\n");
+  }
+  auto filename = WriteTempFile(content);
+
+  LightGBM::PipelineReadStats stats;
+  size_t num_bytes = 0;
+  LightGBM::PipelineReader::Read(filename.c_str(), 0, [&num_bytes](char*, size_t cnt) {
+    num_bytes += cnt;
+    return cnt;
+  }, 7, 4, &stats);
+  EXPECT_EQ(content.size(), num_bytes);
+  EXPECT_EQ(content.size(), stats.num_bytes);
+  EXPECT_EQ((content.size() + 6) / 7, stats.num_blocks);
+
+  for (int num_buffers : {2, 3, 8}) {
+    TextReader<int> reader(filename.c_str(), false, SIZE_MAX, 5, num_buffers);
+    std::vector<std::string> lines;
+    int num_lines = reader.ReadAllAndProcessParallel(
+      [&lines](int, const std::vector<TextLine>& block) {
+      for (const auto& line : block) {
+        lines.push_back(line.ToString());
+      }
+    });
+    EXPECT_EQ(1000, num_lines);
+    EXPECT_EQ(expected, lines);
+  }
+  std::remove(filename.c_str());
+}
@@ -0,0 +1,72 @@
+/*!
+ * Copyright (c) 2024 Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License. See LICENSE file in the project root for license information.
+ */
+
+#include <gtest/gtest.h>
+#include <LightGBM/utils/openmp_wrapper.h>
+#include <LightGBM/utils/threading.h>
+
+#include <vector>
+
+using LightGBM::ParallelPartitionRunner;
+
+namespace {
+
+template <bool IN_PLACE>
+void ExpectStablePartition(int cnt, int min_block_size) {
+  std::vector<int> indices(cnt);
+  std::vector<int> expected;
+  for (int i = 0; i < cnt; ++i) {
+    indices[i] = 3 * i;
+    if (i % 3 != 0) {
+      expected.push_back(indices[i]);
+    }
+  }
+  for (int i = 0; i < cnt; ++i) {
+    if (i % 3 == 0) {
+      expected.push_back(indices[i]);
+    }
+  }
+  std::vector<int> placed(cnt, 0);
+  ParallelPartitionRunner<int, true> runner(cnt, min_block_size);
+  // with IN_PLACE the block is read from out, as DataPartition::Split does,
+  // otherwise from a copy, since out may be written before it is read
+  const std::vector<int> input = indices;
+  const int* in = IN_PLACE ? indices.data() : input.data();
+  const int left_cnt = runner.Run<false, IN_PLACE>(
+      cnt,
+      [in](int, int cur_start, int cur_cnt, int* left, int* right) {
+        int left_cnt = 0;
+        int right_cnt = 0;
+        for (int i = cur_start; i < cur_start + cur_cnt; ++i) {
+          if (in[i] % 9 != 0) {
+            left[left_cnt++] = in[i];
+          } else {
+            right[right_cnt++] = in[i];
+          }
+        }
+        return left_cnt;
+      },
+      indices.data(),
+      [&placed](int start, int cur_cnt, int) {
+        for (int i = start; i < start + cur_cnt; ++i) {
+          ++placed[i];
+        }
+      });
+  EXPECT_EQ(cnt - (cnt + 2) / 3, left_cnt);
+  EXPECT_EQ(expected, indices);
+  EXPECT_EQ(std::vector<int>(cnt, 1), placed);
+}
+
+}  // namespace
+
+TEST(ParallelPartitionRunner, StablePartition) {
+  // a single block and several blocks
+  OMP_SET_NUM_THREADS(4);
+  for (int min_block_size : {100000, 64}) {
+    ExpectStablePartition<false>(1000, min_block_size);
+    ExpectStablePartition<true>(1000, min_block_size);
+  }
+  OMP_SET_NUM_THREADS(-1);
+}
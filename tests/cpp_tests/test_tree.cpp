@@ -0,0 +1,95 @@
+/*!
+ * Copyright (c) 2024 Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License. See LICENSE file in the project root for license information.
+ */
+
+#include <gtest/gtest.h>
+#include <testutils.h>
+#include <LightGBM/c_api.h>
+#include <LightGBM/config.h>
+#include <LightGBM/dataset.h>
+#include <LightGBM/tree.h>
+#include <LightGBM/tree_learner.h>
+#include <LightGBM/utils/random.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+using LightGBM::Config;
+using LightGBM::Dataset;
+using LightGBM::TestUtils;
+using LightGBM::Tree;
+using LightGBM::TreeLearner;
+using LightGBM::data_size_t;
+using LightGBM::score_t;
+
+TEST(Tree, BinnedScoreMatchesPrediction) {
+  // more rows than a block of AddPredictionToScore
+  const int num_data = 10000;
+  const int num_feature = 6;
+  // a categorical feature, dense features, one with missing values, and sparse features, one with missing values
+  std::vector<double> features;
+  TestUtils::CreateRandomFeatures(num_data, {{20, 0, 3}, {0, 0, 0}, {0, 0, 12}, {0, 90, 0}, {0, 95, 3}, {0, 20, 0}},
+                                  23, &features);
+  LightGBM::Random rand(24);
+  std::vector<score_t> gradients(num_data), hessians(num_data, 1.0f);
+  for (int i = 0; i < num_data; ++i) {
+    const double* row = features.data() + i * num_feature;
+    const int cat = std::isnan(row[0]) ? 0 : static_cast<int>(row[0]);
+    gradients[i] = static_cast<score_t>(-((cat % 4 == 1) + row[1] + (std::isnan(row[2]) ? 1.0 : row[2] * 0.5) +
+                                          row[3] * 2 + (std::isnan(row[4]) ? -1.0 : row[4] * 4) + row[5] +
+                                          rand.NextFloat() * 0.1));
+  }
+  std::vector<data_size_t> sorted_indices, shuffled_indices;
+  for (data_size_t i = 0; i < num_data; ++i) {
+    if (i % 3 != 1) {
+      sorted_indices.push_back(i);
+    }
+  }
+  shuffled_indices = sorted_indices;
+  for (size_t i = shuffled_indices.size() - 1; i > 0; --i) {
+    std::swap(shuffled_indices[i], shuffled_indices[rand.NextInt(0, static_cast<int>(i) + 1)]);
+  }
+
+  for (bool zero_as_missing : {false, true}) {
+    const std::string params = std::string("num_leaves=63 min_data_in_leaf=10 max_bin=63 categorical_feature=0 "
+                                           "max_cat_to_onehot=4 verbose=-1 num_threads=2 zero_as_missing=") +
+                               (zero_as_missing ? "true" : "false");
+    DatasetHandle handle;
+    ASSERT_EQ(0, TestUtils::CreateDatasetFromFeatures(features, num_feature, params.c_str(), nullptr, &handle));
+    const Dataset* dataset = reinterpret_cast<const Dataset*>(handle);
+    Config config;
+    config.Set(Config::Str2Map(params.c_str()));
+    std::unique_ptr<TreeLearner> learner(TreeLearner::CreateTreeLearner("serial", "cpu", &config, false));
+    learner->Init(dataset, false);
+    learner->SetForcedSplit(nullptr);
+    std::unique_ptr<Tree> tree(learner->Train(gradients.data(), hessians.data(), true));
+    ASSERT_GT(tree->num_leaves(), 40);
+    ASSERT_NE(std::string::npos, tree->ToString().find("cat_threshold=")) << "no categorical split";
+
+    std::vector<double> expected(num_data);
+    for (int i = 0; i < num_data; ++i) {
+      expected[i] = tree->Predict(features.data() + i * num_feature);
+    }
+    std::vector<double> score(num_data, 0.0);
+    tree->AddPredictionToScore(dataset, num_data, score.data());
+    for (int i = 0; i < num_data; ++i) {
+      EXPECT_EQ(expected[i], score[i]) << "row " << i << ", zero_as_missing=" << zero_as_missing;
+    }
+    for (const auto* used_indices : {&sorted_indices, &shuffled_indices}) {
+      const bool is_sorted = used_indices == &sorted_indices;
+      std::fill(score.begin(), score.end(), 0.0);
+      tree->AddPredictionToScore(dataset, used_indices->data(), static_cast<data_size_t>(used_indices->size()),
+                                 score.data());
+      for (int i = 0; i < num_data; ++i) {
+        EXPECT_EQ(i % 3 != 1 ? expected[i] : 0.0, score[i])
+            << "row " << i << ", zero_as_missing=" << zero_as_missing << (is_sorted ? ", sorted" : ", unsorted")
+            << " indices";
+      }
+    }
+    EXPECT_EQ(0, LGBM_DatasetFree(handle));
+  }
+}
@@ -0,0 +1,67 @@
+/*!
+ * Copyright (c) 2024 Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License. See LICENSE file in the project root for license information.
+ */
+
+#include <gtest/gtest.h>
+#include <testutils.h>
+#include <LightGBM/c_api.h>
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+using LightGBM::TestUtils;
+
+TEST(ValidScore, PartitionedScoreMatchesPrediction) {
+  const int num_train = 2000;
+  const int num_valid = 700;
+  const int num_feature = 4;
+  // a numerical feature, a categorical one, one with missing values and one that is mostly zero
+  const std::vector<TestUtils::RandomFeature> columns = {{0, 0, 0}, {12, 0, 0}, {0, 0, 10}, {0, 80, 0}};
+  auto make_data = [&columns](int num_data, int seed, std::vector<double>* features, std::vector<float>* labels) {
+    TestUtils::CreateRandomFeatures(num_data, columns, seed, features);
+    labels->resize(num_data);
+    for (int i = 0; i < num_data; ++i) {
+      const double* row = features->data() + i * num_feature;
+      (*labels)[i] = static_cast<float>(row[0] + (static_cast<int>(row[1]) % 3 == 0 ? 1.0 : 0.0) +
+                                        (std::isnan(row[2]) ? 0.5 : row[2] * row[3]));
+    }
+  };
+  std::vector<double> train_features, valid_features;
+  std::vector<float> train_labels, valid_labels;
+  make_data(num_train, 13, &train_features, &train_labels);
+  make_data(num_valid, 14, &valid_features, &valid_labels);
+
+  const std::string base_params = "objective=regression num_leaves=15 min_data_in_leaf=5 categorical_feature=1 "
+                                  "verbose=-1 num_threads=2";
+  for (const std::string extra : {"", "bagging_freq=1 bagging_fraction=0.5", "boosting=dart", "boosting=rf "
+                                  "bagging_freq=1 bagging_fraction=0.5", "linear_tree=true"}) {
+    const std::string params = base_params + " " + extra;
+    DatasetHandle train, valid;
+    ASSERT_EQ(0, TestUtils::CreateDatasetFromFeatures(train_features, num_feature, params.c_str(), nullptr, &train));
+    ASSERT_EQ(0, LGBM_DatasetSetField(train, "label", train_labels.data(), num_train, C_API_DTYPE_FLOAT32));
+    ASSERT_EQ(0, TestUtils::CreateDatasetFromFeatures(valid_features, num_feature, params.c_str(), train, &valid));
+    ASSERT_EQ(0, LGBM_DatasetSetField(valid, "label", valid_labels.data(), num_valid, C_API_DTYPE_FLOAT32));
+    BoosterHandle booster;
+    ASSERT_EQ(0, LGBM_BoosterCreate(train, params.c_str(), &booster));
+    ASSERT_EQ(0, LGBM_BoosterAddValidData(booster, valid));
+    int is_finished = 0;
+    for (int i = 0; i < 10; ++i) {
+      ASSERT_EQ(0, LGBM_BoosterUpdateOneIter(booster, &is_finished));
+    }
+
+    int64_t out_len = 0;
+    std::vector<double> valid_score(num_valid), predicted(num_valid);
+    ASSERT_EQ(0, LGBM_BoosterGetPredict(booster, 1, &out_len, valid_score.data()));
+    ASSERT_EQ(num_valid, out_len);
+    ASSERT_EQ(0, LGBM_BoosterPredictForMat(booster, valid_features.data(), C_API_DTYPE_FLOAT64, num_valid, num_feature,
+                                           1, C_API_PREDICT_NORMAL, 0, -1, "", &out_len, predicted.data()));
+    for (int i = 0; i < num_valid; ++i) {
+      EXPECT_NEAR(predicted[i], valid_score[i], 1e-9) << extra << ", row " << i;
+    }
+    EXPECT_EQ(0, LGBM_BoosterFree(booster));
+    EXPECT_EQ(0, LGBM_DatasetFree(valid));
+    EXPECT_EQ(0, LGBM_DatasetFree(train));
+  }
+}
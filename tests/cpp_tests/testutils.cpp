@@ -8,6 +8,8 @@
 #include <LightGBM/utils/random.h>
 
 #include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
 #include <string>
 #include <thread>
 #include <utility>
@@ -132,6 +134,95 @@ namespace LightGBM {
     }
   }
 
+  /*!
+  * Creates random features in the passed vector.
+  */
+  void TestUtils::CreateRandomFeatures(int32_t nrows,
+    const std::vector<RandomFeature>& columns,
+    int32_t seed,
+    std::vector<double>* features) {
+    Random rand(seed);
+    const int32_t ncols = static_cast<int32_t>(columns.size());
+    features->resize(static_cast<size_t>(nrows) * ncols);
+
+    for (int32_t row = 0; row < nrows; row++) {
+      for (int32_t col = 0; col < ncols; col++) {
+        const RandomFeature& column = columns[col];
+        const int32_t percent = rand.NextShort(0, 100);
+        double value;
+        if (percent < column.missing_percent) {
+          value = std::numeric_limits<double>::quiet_NaN();
+        } else if (percent < column.missing_percent + column.zero_percent) {
+          value = 0.0;
+        } else if (column.num_values > 0) {
+          value = rand.NextShort(0, column.num_values);
+        } else {
+          value = rand.NextFloat() * 2.0 - 1.0;
+        }
+        (*features)[static_cast<size_t>(row) * ncols + col] = value;
+      }
+    }
+  }
+
+  int TestUtils::CreateDatasetFromFeatures(const std::vector<double>& features,
+    int32_t ncols,
+    const char* config,
+    DatasetHandle reference,
+    DatasetHandle* out) {
+    const int32_t nrows = static_cast<int32_t>(features.size() / ncols);
+    return LGBM_DatasetCreateFromMat(
+      features.data(),
+      C_API_DTYPE_FLOAT64,
+      nrows,
+      ncols,
+      1,
+      config,
+      reference,
+      out);
+  }
+
+  void TestUtils::CreateRandomGradients(int32_t nrows,
+    int32_t seed,
+    std::vector<score_t>* gradients,
+    std::vector<score_t>* hessians) {
+    Random rand(seed);
+    gradients->resize(nrows);
+    hessians->resize(nrows);
+
+    for (int32_t row = 0; row < nrows; row++) {
+      (*gradients)[row] = rand.NextShort(-40, 40) * 0.25f;
+      (*hessians)[row] = rand.NextShort(1, 40) * 0.25f;
+    }
+  }
+
+  void TestUtils::CreateRandomLogisticGradients(int32_t nrows,
+    int32_t seed,
+    std::vector<score_t>* gradients,
+    std::vector<score_t>* hessians) {
+    Random rand(seed);
+    gradients->resize(nrows);
+    hessians->resize(nrows);
+
+    for (int32_t row = 0; row < nrows; row++) {
+      // scores in [-20, 20), and labels 0 or 1
+      const double prob = 1.0 / (1.0 + std::exp(-(rand.NextFloat() * 40.0 - 20.0)));
+      (*gradients)[row] = static_cast<score_t>(prob - rand.NextShort(0, 2));
+      (*hessians)[row] = static_cast<score_t>(prob * (1.0 - prob));
+    }
+  }
+
+  void TestUtils::CreateRandomQuantizedGradients(int32_t nrows,
+    int32_t seed,
+    std::vector<int8_t>* gradients_and_hessians) {
+    Random rand(seed);
+    gradients_and_hessians->resize(2 * static_cast<size_t>(nrows));
+
+    for (int32_t row = 0; row < nrows; row++) {
+      (*gradients_and_hessians)[2 * row] = static_cast<int8_t>(rand.NextShort(-2, 3));
+      (*gradients_and_hessians)[2 * row + 1] = static_cast<int8_t>(rand.NextShort(0, 3));
+    }
+  }
+
   void TestUtils::StreamDenseDataset(DatasetHandle dataset_handle,
     int32_t nrows,
     int32_t ncols,
@@ -16,6 +16,18 @@ namespace LightGBM {
 
 class TestUtils {
  public:
+  /*!
+   * Distribution of a column of random features.
+   */
+  struct RandomFeature {
+    /*! Number of distinct integer values, or 0 for floats in [-1, 1) */
+    int32_t num_values;
+    /*! Percentage of zeros */
+    int32_t zero_percent;
+    /*! Percentage of missing values */
+    int32_t missing_percent;
+  };
+
   /*!
    * Creates a Dataset from the internal repository examples.
    */
@@ -59,6 +71,47 @@ class TestUtils {
     std::vector<double>* init_scores,
     std::vector<int32_t>* groups);
 
+  /*!
+   * Creates a row-major matrix of random features, with one column per RandomFeature.
+   */
+  static void CreateRandomFeatures(int32_t nrows,
+    const std::vector<RandomFeature>& columns,
+    int32_t seed,
+    std::vector<double>* features);
+
+  /*!
+   * Creates a Dataset from a row-major matrix of features.
+   */
+  static int CreateDatasetFromFeatures(const std::vector<double>& features,
+    int32_t ncols,
+    const char* config,
+    DatasetHandle reference,
+    DatasetHandle* out);
+
+  /*!
+   * Creates random gradients and hessians that are multiples of 0.25, so their sums are exact in any order.
+   */
+  static void CreateRandomGradients(int32_t nrows,
+    int32_t seed,
+    std::vector<score_t>* gradients,
+    std::vector<score_t>* hessians);
+
+  /*!
+   * Creates gradients and hessians of the logistic loss over a wide range of magnitudes,
+   * their sums are rounded differently when added in another order.
+   */
+  static void CreateRandomLogisticGradients(int32_t nrows,
+    int32_t seed,
+    std::vector<score_t>* gradients,
+    std::vector<score_t>* hessians);
+
+  /*!
+   * Creates random int8 gradient and hessian pairs, as used by the quantized training.
+   */
+  static void CreateRandomQuantizedGradients(int32_t nrows,
+    int32_t seed,
+    std::vector<int8_t>* gradients_and_hessians);
+
   /*!
    * Pushes nrows of data to a Dataset in batches of batch_count.
    */